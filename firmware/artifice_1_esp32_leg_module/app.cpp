@@ -1,44 +1,120 @@
-#include "freertos/FreeRTOS.h"
-#include "freertos/task.h"
 #include <cstdio>
 
+#include "fast_link.hpp"
+#include "hal.hpp"
+#include "logger.hpp"
 #include "motion_controller.hpp"
 #include "ros_interface.hpp"
+#include "scheduler.hpp"
 #include "servo_driver.hpp"
+#include "task_layout.hpp"
+
+namespace {
+
+struct ServiceContext {
+    MotionController* motionController;
+    RosInterface* rosInterface;
+    FastLink* fastLink;     // nullptr = Fast-Path aus
+    Scheduler scheduler;
+    size_t heapAfterBoot;   // System-Heap nach dem Start, danach darf er nicht mehr wachsen
+    size_t heapReported;
+};
+
+// Alle Module statisch, kein new
+ServoDriver driver;
+MotionController motionController(driver);
+RosInterface rosInterface(&motionController);
+FastLink fastLink(&motionController);
+ServiceContext service{&motionController, &rosInterface, nullptr, {}, 0, 0};
+
+// Mittlerer Slot: Log-Ring leeren und Zeilen publizieren, Joint-State-Rate übernehmen
+void serviceSlot(void* arg) {
+    ServiceContext* ctx = static_cast<ServiceContext*>(arg);
+    logger::service();
+    ctx->rosInterface->service();
+}
+
+// Langsamer Slot: Alive-Meldungen, Timing und Budget-Überschreitungen
+void healthSlot(void* arg) {
+    ServiceContext* ctx = static_cast<ServiceContext*>(arg);
+    ctx->motionController->reportHealth();
+    ctx->rosInterface->reportHealth();
+    if (ctx->fastLink) ctx->fastLink->reportHealth();
+    for (size_t i = 0; i < ctx->scheduler.slotCount(); ++i) {
+        Scheduler::SlotStats s = ctx->scheduler.slotStats(i);
+        if (s.overruns > 0) {
+            LOG_E("slot %u: %u of %u runs over budget, exec max %u us", i, s.overruns, s.runs, s.execMaxUs);
+        }
+    }
+
+    // Heap-Wachstum nach dem Start = Allokation im Betrieb (einmal pro neuem Höchststand melden)
+    const size_t heap = hal::heapUsedBytes();
+    if (heap > ctx->heapAfterBoot && heap > ctx->heapReported) {
+        LOG_E("heap grew by %u bytes after boot", heap - ctx->heapAfterBoot);
+        ctx->heapReported = heap;
+    }
+
+    // Stack-Reserve seit dem Start, inklusive aller Connects / Reconnects des Service-Tasks
+    uint32_t controlFree = 0, serviceFree = 0, fastFree = 0;
+    const bool haveControl = hal::taskStackFreeMin(task_layout::CONTROL.name, controlFree);
+    const bool haveService = hal::taskStackFreeMin(task_layout::SERVICE.name, serviceFree);
+    const bool haveFast = hal::taskStackFreeMin(task_layout::FAST_LINK.name, fastFree);
+    if (haveControl && haveService) {
+        const bool low = controlFree < task_layout::STACK_MARGIN_BYTES || serviceFree < task_layout::STACK_MARGIN_BYTES
+            || (haveFast && fastFree < task_layout::STACK_MARGIN_BYTES);
+        if (low) {
+            LOG_E("stack min free: control %u, service %u, fast link %u bytes", controlFree, serviceFree, fastFree);
+        } else {
+            LOG_L("stack min free: control %u, service %u, fast link %u bytes", controlFree, serviceFree, fastFree);
+        }
+    }
+}
+
+// Zeit bis zum nächsten Slot: Executor wartet auf den Transport
+void idleHook(void* arg, uint32_t maxUs) {
+    static_cast<ServiceContext*>(arg)->rosInterface->spinTransport(maxUs);
+}
+
+void serviceTask(void* arg) {
+    static_cast<ServiceContext*>(arg)->scheduler.run();
+}
+
+} // namespace
 
 // Haupt-Entry für ESP32 FreeRTOS
 extern "C" void appMain(void* arg) {
 
-    // ServoDriver erstellen und PWM initialisieren
-    ServoDriver* driver = new ServoDriver();
-    driver->initializePWM();
-
-    // MotionController erstellen und starten
-    MotionController* motionController = new MotionController(*driver);
-    MotionController::globalInstance = motionController;
-    motionController->initialize();
-
-    // RosInterface erstellen und starten
-    RosInterface* rosInterface = new RosInterface(motionController);
-    RosInterface::globalInstance = rosInterface;
-    rosInterface->initialize();
-
-    printf("ESP32 Multi-File Servo Controller started!\n");
-
-    // Optional: MotionController in eigenem Task spinnen (dient nur für Alive-Prints)
-    xTaskCreate([](void* param){
-        MotionController* mc = static_cast<MotionController*>(param);
-        mc->spin();
-    }, "motion_spin_task", 4096, motionController, 5, nullptr);
-
-    // RosInterface spinn in eigenem Task
-    xTaskCreate([](void* param){
-        RosInterface* ri = static_cast<RosInterface*>(param);
-        ri->spin();
-    }, "ros_spin_task", 4096, rosInterface, 5, nullptr);
-
-    // Die appMain Task kann nun selbst enden oder weiterleben
-    while(true) {
-        vTaskDelay(pdMS_TO_TICKS(1000));
+    // PWM initialisieren
+    driver.initializePWM();
+
+    // MotionController starten (eigener Task auf dem Control-Core, Stack aus dem statischen Pool)
+    MotionController::globalInstance = &motionController;
+    motionController.initialize();
+
+    // RosInterface vorbereiten; die Verbindung zum Agent baut der Service-Task im Hintergrund auf
+    // (Ping mit Backoff, Reconnect), Servos halten bis dahin ihre Startstellung
+    RosInterface::globalInstance = &rosInterface;
+    rosInterface.initialize();
+
+    // Optionaler Fast-Path: rohe Joint-Frames über eine eigene UART direkt in den Control-Loop,
+    // ROS bleibt für Konfiguration und Telemetrie
+    if (FAST_LINK_ENABLED && fastLink.start(FastLink::defaultConfig())) service.fastLink = &fastLink;
+
+    // Alles außer dem Control-Loop läuft kooperativ in einem Service-Task auf dem Transport-Core
+    ServiceContext* ctx = &service;
+    ctx->scheduler.addSlot("service", task_layout::SERVICE_SLOT_PERIOD_US, task_layout::SERVICE_SLOT_BUDGET_US,
+                           serviceSlot, ctx);
+    ctx->scheduler.addSlot("health", task_layout::HEALTH_SLOT_PERIOD_US, task_layout::HEALTH_SLOT_BUDGET_US,
+                           healthSlot, ctx);
+    ctx->scheduler.setIdle(idleHook, ctx);
+    ctx->heapAfterBoot = hal::heapUsedBytes();
+    ctx->heapReported = ctx->heapAfterBoot;
+    if (!task_layout::start(task_layout::SERVICE, serviceTask, ctx)) {
+        LOG_E("Failed to create service task");
     }
+    LOG_L("ESP32 Multi-File Servo Controller started! heap %u bytes, servos ready %u us after boot",
+          ctx->heapAfterBoot, motionController.readyUs());
+
+    // appMain wird nicht mehr gebraucht, Stack freigeben
+    hal::deleteCurrentTask();
 }
@@ -0,0 +1,147 @@
+#include "clock_sync.hpp"
+
+void ClockSync::addSample(int64_t moduleUs, int64_t agentUs, uint32_t rttUs) {
+    current.lastRttUs = rttUs;
+    if (rttUs > CLOCK_SYNC_MAX_RTT_US) {
+        ++current.skipped;
+        publish();
+        return;
+    }
+    // Langer Round Trip: Mittelpunkt unsicher, auslassen; dauerhaft langsamer -> Fenster neu aufbauen
+    if (count > 0 && rttUs > 2 * current.minRttUs + RTT_SLACK_US) {
+        if (++skipped_in_row < MAX_SKIPPED) {
+            ++current.skipped;
+            publish();
+            return;
+        }
+        count = 0;
+        next = 0;
+    }
+    skipped_in_row = 0;
+
+    const int64_t offset = agentUs - moduleUs;
+    if (current.synced) {
+        int64_t error = offset - offsetAt(current, moduleUs);
+        if (error < 0) error = -error;
+        if (error > STEP_US) {
+            // Agent-Uhr gesprungen: alte Samples passen nicht mehr, Drift bleibt (hängt am Quarz)
+            ++current.steps;
+            count = 0;
+            next = 0;
+        }
+    }
+    window[next] = {moduleUs, offset, rttUs};
+    next = (next + 1) % WINDOW;
+    if (count < WINDOW) ++count;
+    ++current.samples;
+    fit();
+    publish();
+}
+
+void ClockSync::fit() {
+    // Relativ zum neuesten Sample rechnen, damit double bei Epoch-Offsets genau bleibt
+    const Sample& newest = window[(next + WINDOW - 1) % WINDOW];
+    double meanT = 0.0, meanO = 0.0;
+    int64_t minT = newest.moduleUs;
+    uint32_t minRtt = newest.rttUs;
+    for (size_t i = 0; i < count; ++i) {
+        meanT += static_cast<double>(window[i].moduleUs - newest.moduleUs);
+        meanO += static_cast<double>(window[i].offsetUs - newest.offsetUs);
+        if (window[i].moduleUs < minT) minT = window[i].moduleUs;
+        if (window[i].rttUs < minRtt) minRtt = window[i].rttUs;
+    }
+    meanT /= count;
+    meanO /= count;
+
+    // Drift erst über eine ausreichende Spanne, vorher die letzte Schätzung (oder 0) weiterverwenden
+    double slope = current.driftPpb / 1e9;
+    if (count >= 2 && newest.moduleUs - minT >= MIN_DRIFT_SPAN_US) {
+        double stt = 0.0, sto = 0.0;
+        for (size_t i = 0; i < count; ++i) {
+            const double dt = static_cast<double>(window[i].moduleUs - newest.moduleUs) - meanT;
+            const double dO = static_cast<double>(window[i].offsetUs - newest.offsetUs) - meanO;
+            stt += dt * dt;
+            sto += dt * dO;
+        }
+        slope = stt > 0.0 ? sto / stt : 0.0;
+        if (slope > MAX_DRIFT_PPB / 1e9) slope = MAX_DRIFT_PPB / 1e9;
+        if (slope < -MAX_DRIFT_PPB / 1e9) slope = -MAX_DRIFT_PPB / 1e9;
+    }
+    const double interceptO = meanO - slope * meanT; // Offset beim neuesten Sample
+
+    double residual = 0.0;
+    for (size_t i = 0; i < count; ++i) {
+        const double fitted = interceptO + slope * static_cast<double>(window[i].moduleUs - newest.moduleUs);
+        const double error = static_cast<double>(window[i].offsetUs - newest.offsetUs) - fitted;
+        if (error > residual) residual = error;
+        if (-error > residual) residual = -error;
+    }
+
+    current.synced = true;
+    current.refModuleUs = newest.moduleUs;
+    current.refOffsetUs = newest.offsetUs + static_cast<int64_t>(interceptO >= 0.0 ? interceptO + 0.5 : interceptO - 0.5);
+    current.driftPpb = static_cast<int32_t>(slope * 1e9);
+    current.minRttUs = minRtt;
+    current.residualUs = static_cast<uint32_t>(residual + 0.5);
+}
+
+void ClockSync::publish() {
+    const uint32_t seq = sequence.load(std::memory_order_relaxed);
+    sequence.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    published = current;
+    sequence.store(seq + 2, std::memory_order_release);
+}
+
+ClockSync::Model ClockSync::model() const {
+    Model copy;
+    uint32_t before, after;
+    do {
+        before = sequence.load(std::memory_order_acquire);
+        copy = published;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        after = sequence.load(std::memory_order_relaxed);
+    } while ((before & 1u) || before != after);
+    return copy;
+}
+
+bool ClockSync::toModuleUs(int64_t agentUs, int64_t& moduleUs) const {
+    const Model m = model();
+    if (!m.synced) return false;
+    // Offset hängt (über die Drift) von der Modul-Zeit ab: einmal nachrechnen reicht bei < 1e-3
+    const int64_t guess = agentUs - m.refOffsetUs;
+    moduleUs = agentUs - offsetAt(m, guess);
+    return true;
+}
+
+bool ClockSync::toAgentUs(int64_t moduleUs, int64_t& agentUs) const {
+    const Model m = model();
+    if (!m.synced) return false;
+    agentUs = moduleUs + offsetAt(m, moduleUs);
+    return true;
+}
+
+bool ClockSync::wireToModuleUs(uint32_t agentUs, int64_t nowUs, int64_t& moduleUs) const {
+    int64_t agentNow;
+    if (!toAgentUs(nowUs, agentNow)) return false;
+    // Low 32 bit: nächster Zeitpunkt zu jetzt, +-35 min
+    const int64_t full = agentNow + static_cast<int32_t>(agentUs - static_cast<uint32_t>(agentNow));
+    return toModuleUs(full, moduleUs);
+}
+
+ClockSync::Stats ClockSync::stats() const {
+    const Model m = model();
+    Stats s;
+    s.synced = m.synced;
+    s.offsetUs = m.refOffsetUs;
+    s.driftPpb = m.driftPpb;
+    s.lastSampleUs = m.refModuleUs;
+    s.samples = m.samples;
+    s.skipped = m.skipped;
+    s.failures = failures.load(std::memory_order_relaxed);
+    s.steps = m.steps;
+    s.lastRttUs = m.lastRttUs;
+    s.minRttUs = m.minRttUs;
+    s.residualUs = m.residualUs;
+    return s;
+}
@@ -0,0 +1,98 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// Exchanges with a longer round trip are never used for the estimate
+#ifndef CLOCK_SYNC_MAX_RTT_US
+#define CLOCK_SYNC_MAX_RTT_US 20000
+#endif
+
+// Module clock (hal::nowUs) <-> agent clock (the synchronized epoch of the micro-ROS session, us).
+// Every exchange (rmw_uros_sync_session on the module) yields the agent time at one instant of the module
+// clock and the round trip it took. Offset and drift are a least-squares fit over the last WINDOW samples;
+// exchanges whose round trip is well above the best one in the window are skipped, since their midpoint
+// estimate is the least reliable. Execute-at times of commands are converted with the fit, so all modules
+// synced to the same agent act at the same instant within residualUs. The fit keeps running when the agent is
+// lost. Single writer (the task running the exchanges), conversions and stats from any task.
+class ClockSync {
+public:
+    static const size_t WINDOW = 8;
+    // Drift is only fitted over at least this span, before that the offset alone is used
+    static const int64_t MIN_DRIFT_SPAN_US = 2000000;
+    // A sample this far from the fit restarts it (agent clock stepped or agent restarted)
+    static const int64_t STEP_US = 5000;
+    // Sample skipped if its round trip exceeds 2 x the best one in the window plus this
+    static const uint32_t RTT_SLACK_US = 2000;
+    // Skipped in a row -> the link got slower for good, take the next one and rebuild the window
+    static const uint32_t MAX_SKIPPED = WINDOW;
+    // Crystals stay within +-100 ppm, anything beyond +-500 ppm is clamped
+    static const int32_t MAX_DRIFT_PPB = 500000;
+
+    struct Stats {
+        bool synced;
+        int64_t offsetUs;     // agent - module at lastSampleUs (fit)
+        int32_t driftPpb;     // rate of the agent clock relative to the module clock - 1, in 1e-9
+        int64_t lastSampleUs; // module clock
+        uint32_t samples;     // accepted since boot
+        uint32_t skipped;     // round trip too long
+        uint32_t failures;    // exchange without answer
+        uint32_t steps;       // fit restarted
+        uint32_t lastRttUs;
+        uint32_t minRttUs;    // best round trip in the window
+        uint32_t residualUs;  // largest |sample - fit| in the window
+    };
+
+    // moduleUs: module clock at which the agent clock read agentUs, rttUs: round trip of the exchange
+    void addSample(int64_t moduleUs, int64_t agentUs, uint32_t rttUs);
+    void countFailure() { failures.fetch_add(1, std::memory_order_relaxed); }
+
+    bool synced() const { return model().synced; }
+    // Conversions with the current fit, false while not synced
+    bool toModuleUs(int64_t agentUs, int64_t& moduleUs) const;
+    bool toAgentUs(int64_t moduleUs, int64_t& agentUs) const;
+    // Agent time as carried by the wire frames (low 32 bit), unwrapped around the module time nowUs
+    bool wireToModuleUs(uint32_t agentUs, int64_t nowUs, int64_t& moduleUs) const;
+
+    Stats stats() const;
+
+private:
+    struct Model {
+        bool synced;
+        int64_t refModuleUs;
+        int64_t refOffsetUs; // agent - module at refModuleUs
+        int32_t driftPpb;
+        uint32_t samples;
+        uint32_t skipped;
+        uint32_t steps;
+        uint32_t lastRttUs;
+        uint32_t minRttUs;
+        uint32_t residualUs;
+    };
+
+    struct Sample {
+        int64_t moduleUs;
+        int64_t offsetUs;
+        uint32_t rttUs;
+    };
+
+    static int64_t offsetAt(const Model& m, int64_t moduleUs) {
+        return m.refOffsetUs + (m.driftPpb * (moduleUs - m.refModuleUs)) / 1000000000;
+    }
+
+    Model model() const;
+    void fit();
+    void publish();
+
+    // nur vom Writer benutzt
+    Sample window[WINDOW] = {};
+    size_t count = 0;
+    size_t next = 0;
+    uint32_t skipped_in_row = 0;
+    Model current{};
+
+    std::atomic<uint32_t> failures{0};
+    // Seqlock: ungerade = Schreiber aktiv
+    std::atomic<uint32_t> sequence{0};
+    Model published{};
+};
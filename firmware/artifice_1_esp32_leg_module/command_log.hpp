@@ -0,0 +1,141 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include "module_topology.hpp"
+
+// Compact binary capture of incoming command frames with their arrival time, replayed on the host
+// (host/replay.cpp) through the same decode / controller path. Little endian:
+//   FileHeader, then per frame RecordHeader + the raw wire payload (LegCommand / FootCommand / GaitCommand /
+//   trajectory chunk).
+namespace command_log {
+
+static const uint32_t MAGIC = 0x314C4341; // "ACL1"
+static const uint8_t VERSION = 2; // 2: 16-bit record length (trajectory chunks)
+
+enum class FrameKind : uint8_t {
+    Joint = 1,     // LegCommand, /leg/<id>/cmd_joint_positions
+    Foot = 2,      // FootCommand, /leg/<id>/cmd_foot_positions
+    Gait = 3,      // GaitCommand, /leg/<id>/cmd_gait
+    Trajectory = 4 // TrajectoryChunkHeader + points, /leg/<id>/cmd_trajectory
+};
+
+#pragma pack(push, 1)
+struct FileHeader {
+    uint32_t magic;       // MAGIC
+    uint8_t version;      // VERSION
+    uint8_t legs;         // topology of the recording module, replay must match
+    uint8_t jointsPerLeg;
+    uint8_t reserved;
+};
+
+struct RecordHeader {
+    uint32_t arrivalUs;   // module clock (low 32 bit) when the executor handed over the sample
+    uint8_t kind;         // FrameKind
+    uint16_t len;         // payload bytes, as received (malformed frames are recorded too)
+};
+
+// Upload of a full capture window on /leg/<id>/command_log, one chunk per message: ChunkHeader + bytes
+// [offset, offset + n) of the log. The log is complete once offset + n == total.
+struct ChunkHeader {
+    uint32_t offset;
+    uint32_t total;
+};
+#pragma pack(pop)
+
+static_assert(sizeof(FileHeader) == 8, "FileHeader size");
+static_assert(sizeof(RecordHeader) == 7, "RecordHeader size");
+static_assert(sizeof(ChunkHeader) == 8, "ChunkHeader size");
+
+// Appends records to a caller-provided buffer until it is full (one capture window, no wrap-around so the
+// log always starts with a complete record). Single writer; full()/size() readable from the same task.
+class Recorder {
+public:
+    Recorder(uint8_t* buffer, size_t capacity) : buf(buffer), cap(capacity) { clear(); }
+
+    void record(FrameKind kind, int64_t arrivalUs, const uint8_t* data, size_t len) {
+        if (len > 0xFFFF) len = 0xFFFF;
+        const size_t need = sizeof(RecordHeader) + len;
+        if (used + need > cap) {
+            // Fenster voll: ab jetzt nur noch zählen, bis der Log abgeholt und geleert wurde
+            is_full = true;
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        RecordHeader h{static_cast<uint32_t>(arrivalUs), static_cast<uint8_t>(kind), static_cast<uint16_t>(len)};
+        std::memcpy(buf + used, &h, sizeof(h));
+        if (len) std::memcpy(buf + used + sizeof(h), data, len);
+        used += need;
+        records.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Starts a new capture window
+    void clear() {
+        used = 0;
+        is_full = false;
+        if (cap < sizeof(FileHeader)) return;
+        FileHeader h{MAGIC, VERSION, static_cast<uint8_t>(LegModule::LEGS),
+                     static_cast<uint8_t>(LegModule::JOINTS_PER_LEG), 0};
+        std::memcpy(buf, &h, sizeof(h));
+        used = sizeof(h);
+    }
+
+    bool full() const { return is_full; }
+    const uint8_t* data() const { return buf; }
+    size_t size() const { return used; }
+    uint32_t recordCount() const { return records.load(std::memory_order_relaxed); }
+    uint32_t droppedCount() const { return dropped.load(std::memory_order_relaxed); }
+
+private:
+    uint8_t* buf;
+    size_t cap;
+    size_t used = 0;
+    bool is_full = false;
+    std::atomic<uint32_t> records{0};
+    std::atomic<uint32_t> dropped{0};
+};
+
+struct Record {
+    uint32_t arrivalUs;
+    FrameKind kind;
+    const uint8_t* data;
+    size_t len;
+};
+
+// Iterates over a captured log (e.g. a file read on the host)
+class Reader {
+public:
+    Reader(const uint8_t* data, size_t len) : buf(data), size(len) {
+        if (len >= sizeof(FileHeader)) {
+            std::memcpy(&header, data, sizeof(header));
+            pos = sizeof(header);
+        }
+    }
+
+    bool valid() const { return pos != 0 && header.magic == MAGIC && header.version == VERSION; }
+    bool matchesTopology() const {
+        return header.legs == LegModule::LEGS && header.jointsPerLeg == LegModule::JOINTS_PER_LEG;
+    }
+
+    bool next(Record& out) {
+        if (!valid() || pos + sizeof(RecordHeader) > size) return false;
+        RecordHeader h;
+        std::memcpy(&h, buf + pos, sizeof(h));
+        if (pos + sizeof(h) + h.len > size) return false; // abgeschnittener letzter Record
+        out.arrivalUs = h.arrivalUs;
+        out.kind = static_cast<FrameKind>(h.kind);
+        out.data = buf + pos + sizeof(h);
+        out.len = h.len;
+        pos += sizeof(h) + h.len;
+        return true;
+    }
+
+private:
+    const uint8_t* buf;
+    size_t size;
+    size_t pos = 0;
+    FileHeader header{};
+};
+
+} // namespace command_log
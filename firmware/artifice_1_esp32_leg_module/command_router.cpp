@@ -0,0 +1,118 @@
+#include "command_router.hpp"
+#include "trace.hpp"
+
+void CommandRouter::apply(command_log::FrameKind kind, const uint8_t* data, size_t len, int64_t arrivalUs) {
+    // Roh mitschneiden, bevor irgendetwas verworfen wird -> Replay sieht denselben Strom
+    TRACE_EVENT(CallbackBegin, kind);
+    if (recorder) recorder->record(kind, arrivalUs, data, len);
+
+    switch (kind) {
+        case command_log::FrameKind::Joint: applyCommand(data, len, arrivalUs); break;
+        case command_log::FrameKind::Foot: applyFootCommand(data, len, arrivalUs); break;
+        case command_log::FrameKind::Gait: applyGaitCommand(data, len, arrivalUs); break;
+        case command_log::FrameKind::Trajectory: applyTrajectoryChunk(data, len, arrivalUs); break;
+    }
+    TRACE_EVENT(CallbackEnd, kind);
+}
+
+void CommandRouter::applyCommand(const uint8_t* data, size_t len, int64_t arrivalUs) {
+    // Gleicher Topic, Version unterscheidet sofortige und zeitgesteuerte Frames
+    if (data && len > 0 && data[0] == TIMED_LEG_COMMAND_VERSION) {
+        applyTimedCommand(data, len, arrivalUs);
+        return;
+    }
+    LegCommand cmd;
+    if (!decodeLegCommand(data, len, cmd)) {
+        command_tracker.rejectMalformed();
+        return;
+    }
+    if (!command_tracker.accept(cmd) || !controller) return;
+
+    // Alle Beine in einem Frame übernehmen
+    int32_t targets[MotionController::NUM_SERVOS];
+    for (size_t i = 0; i < MotionController::NUM_SERVOS; ++i) targets[i] = cmd.targets[i];
+    controller->streamTargetFrame(targets, cmd.stampUs, arrivalUs);
+}
+
+void CommandRouter::applyTimedCommand(const uint8_t* data, size_t len, int64_t arrivalUs) {
+    TimedLegCommand cmd;
+    if (!decodeTimedLegCommand(data, len, cmd)) {
+        command_tracker.rejectMalformed();
+        return;
+    }
+    if (!command_tracker.accept(cmd) || !controller) return;
+
+    // Agent-Zeit -> Modul-Uhr; ohne Sync gibt es keinen gemeinsamen Zeitpunkt, dann lieber nicht bewegen
+    int64_t executeAt;
+    if (!clock || !clock->wireToModuleUs(cmd.executeAtUs, arrivalUs, executeAt)) {
+        unsynced.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    int32_t targets[MotionController::NUM_SERVOS];
+    for (size_t i = 0; i < MotionController::NUM_SERVOS; ++i) targets[i] = cmd.targets[i];
+    controller->scheduleTargetFrame(targets, executeAt, arrivalUs);
+}
+
+void CommandRouter::applyFootCommand(const uint8_t* data, size_t len, int64_t arrivalUs) {
+    FootCommand cmd;
+    if (!decodeFootCommand(data, len, cmd)) {
+        foot_tracker.rejectMalformed();
+        return;
+    }
+    if (!foot_tracker.accept(cmd) || !controller) return;
+
+    // 0.1 mm -> Mikrometer, Bahn und IK rechnet der Control-Loop
+    int32_t feet[MotionController::NUM_LEGS * kinematics::LEG_JOINTS];
+    for (size_t leg = 0; leg < MotionController::NUM_LEGS; ++leg) {
+        for (size_t a = 0; a < kinematics::LEG_JOINTS; ++a) {
+            feet[leg * kinematics::LEG_JOINTS + a] = static_cast<int32_t>(cmd.feet[leg][a]) * 100;
+        }
+    }
+    controller->setFootTargets(cmd.legMask, feet, arrivalUs);
+}
+
+void CommandRouter::applyGaitCommand(const uint8_t* data, size_t len, int64_t arrivalUs) {
+    GaitCommand cmd;
+    if (!decodeGaitCommand(data, len, cmd)) {
+        gait_tracker.rejectMalformed();
+        return;
+    }
+    if (!gait_tracker.accept(cmd) || !controller) return;
+
+    // 0.1 mm -> Mikrometer, Grenzen prüft der Gait-Generator
+    gait::GaitParams params;
+    params.strideUm = static_cast<int32_t>(cmd.stride) * 100;
+    params.stepHeightUm = static_cast<int32_t>(cmd.stepHeight) * 100;
+    params.frequencyMilliHz = cmd.frequencyMilliHz;
+    params.phaseOffset = cmd.phaseOffset;
+    params.dutyFactor = cmd.dutyFactor;
+    for (size_t a = 0; a < kinematics::LEG_JOINTS; ++a) params.neutralUm[a] = static_cast<int32_t>(cmd.neutral[a]) * 100;
+    controller->setGait(params, (cmd.flags & GAIT_FLAG_RUN) != 0, arrivalUs);
+}
+
+void CommandRouter::applyTrajectoryChunk(const uint8_t* data, size_t len, int64_t arrivalUs) {
+    TrajectoryChunkHeader header;
+    if (!decodeTrajectoryChunk(data, len, header, chunk_points)) {
+        trajectory_tracker.rejectMalformed();
+        return;
+    }
+    if (!trajectory_tracker.accept(header) || !controller) return;
+
+    // startUs ist die Modul-Uhr (low 32 bit): relativ zur Ankunft entpacken, überlebt den Überlauf
+    int64_t start = (header.flags & TRAJECTORY_FLAG_START_ON_ARRIVAL)
+        ? arrivalUs : arrivalUs + static_cast<int32_t>(header.startUs - static_cast<uint32_t>(arrivalUs));
+    if ((header.flags & TRAJECTORY_FLAG_AGENT_CLOCK) && !(header.flags & TRAJECTORY_FLAG_START_ON_ARRIVAL)) {
+        if (!clock || !clock->wireToModuleUs(header.startUs, arrivalUs, start)) {
+            unsynced.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+    }
+    for (size_t i = 0; i < header.count; ++i) {
+        chunk_waypoints[i].tUs = start + chunk_points[i].offsetUs;
+        for (size_t j = 0; j < MotionController::JOINTS_PER_LEG; ++j) {
+            chunk_waypoints[i].centiDeg[j] = chunk_points[i].targets[j];
+        }
+    }
+    controller->setLegWaypoints(header.leg, chunk_waypoints, header.count,
+                                (header.flags & TRAJECTORY_FLAG_REPLACE) != 0, arrivalUs);
+}
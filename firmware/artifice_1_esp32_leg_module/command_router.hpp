@@ -0,0 +1,61 @@
+#pragma once
+#include <cstddef>
+#include <atomic>
+#include <cstdint>
+#include "clock_sync.hpp"
+#include "command_log.hpp"
+#include "leg_command.hpp"
+#include "motion_controller.hpp"
+
+// Decodes incoming command frames, tracks their sequence and hands them to the MotionController.
+// Transport-independent: the ROS callbacks on the module and the replay tool on the host use the same path.
+// Single caller task (the ROS executor), counters readable from anywhere.
+class CommandRouter {
+public:
+    explicit CommandRouter(MotionController* controller) : controller(controller) {}
+
+    // arrivalUs: hal::nowUs() when the transport handed over the sample
+    void apply(command_log::FrameKind kind, const uint8_t* data, size_t len, int64_t arrivalUs);
+
+    // Transport re-established: the next frame of every stream is accepted regardless of its sequence
+    void resync() {
+        command_tracker.resync();
+        foot_tracker.resync();
+        gait_tracker.resync();
+        trajectory_tracker.resync();
+    }
+
+    // Optional capture of every incoming frame (also malformed ones), nullptr = off
+    void setRecorder(command_log::Recorder* rec) { recorder = rec; }
+    // Agent clock for execute-at times (TimedLegCommand, TRAJECTORY_FLAG_AGENT_CLOCK), nullptr = none
+    void setClock(const ClockSync* sync) { clock = sync; }
+
+    // Counters per stream (accepted / dropped / stale / malformed)
+    CommandTracker::Stats commandStats() const { return command_tracker.stats(); }
+    CommandTracker::Stats footCommandStats() const { return foot_tracker.stats(); }
+    CommandTracker::Stats gaitCommandStats() const { return gait_tracker.stats(); }
+    CommandTracker::Stats trajectoryStats() const { return trajectory_tracker.stats(); }
+    // Sequence of the last accepted joint command, same task as apply()
+    uint16_t lastCommandSequence() const { return command_tracker.lastSequence(); }
+    // Accepted frames with an agent clock time dropped because the clock was not synced yet
+    uint32_t unsyncedFrames() const { return unsynced.load(std::memory_order_relaxed); }
+
+private:
+    void applyCommand(const uint8_t* data, size_t len, int64_t arrivalUs);
+    void applyTimedCommand(const uint8_t* data, size_t len, int64_t arrivalUs);
+    void applyFootCommand(const uint8_t* data, size_t len, int64_t arrivalUs);
+    void applyGaitCommand(const uint8_t* data, size_t len, int64_t arrivalUs);
+    void applyTrajectoryChunk(const uint8_t* data, size_t len, int64_t arrivalUs);
+
+    MotionController* controller;
+    command_log::Recorder* recorder = nullptr;
+    const ClockSync* clock = nullptr;
+    std::atomic<uint32_t> unsynced{0};
+    CommandTracker command_tracker;
+    CommandTracker foot_tracker;
+    CommandTracker gait_tracker;
+    CommandTracker trajectory_tracker;
+    // Trajektorien-Chunks sind groß: Dekodier-Puffer hier statt auf dem Executor-Stack
+    TrajectoryPoint chunk_points[TRAJECTORY_CHUNK_MAX_POINTS];
+    trajectory::Waypoint chunk_waypoints[TRAJECTORY_CHUNK_MAX_POINTS];
+};
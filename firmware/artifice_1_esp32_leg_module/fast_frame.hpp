@@ -0,0 +1,144 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include "leg_command.hpp"
+
+// Raw binary fast path next to ROS: fixed-size joint frames over a plain UART, no XRCE-DDS.
+// A frame is the LegCommand wire struct followed by its CRC-16/CCITT-FALSE (little endian), COBS encoded
+// and terminated by a 0x00 delimiter, i.e. 24 bytes on the wire for the 2x3 module.
+// Header-only so the host tools encode / decode with the same code as the module.
+
+#pragma pack(push, 1)
+struct FastJointFrame {
+    LegCommand command;
+    uint16_t crc;   // CRC-16/CCITT-FALSE over command
+};
+#pragma pack(pop)
+
+static_assert(sizeof(FastJointFrame) == sizeof(LegCommand) + 2, "FastJointFrame wire size");
+
+// COBS adds one code byte per started 254 bytes, plus the delimiter
+static const size_t FAST_FRAME_WIRE_BYTES = sizeof(FastJointFrame) + sizeof(FastJointFrame) / 254 + 2;
+
+namespace fast_frame {
+
+// CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF), nibble table
+inline uint16_t crc16(const void* data, size_t len) {
+    static const uint16_t TABLE[16] = {
+        0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+        0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF
+    };
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    uint16_t crc = 0xFFFF;
+    for (size_t i = 0; i < len; ++i) {
+        crc = static_cast<uint16_t>((crc << 4) ^ TABLE[((crc >> 12) ^ (p[i] >> 4)) & 0x0F]);
+        crc = static_cast<uint16_t>((crc << 4) ^ TABLE[((crc >> 12) ^ p[i]) & 0x0F]);
+    }
+    return crc;
+}
+
+// COBS-encodes len bytes and appends the 0x00 delimiter, returns the wire size (0 = capacity too small)
+inline size_t cobsEncode(const uint8_t* in, size_t len, uint8_t* out, size_t capacity) {
+    if (capacity < len + len / 254 + 2) return 0;
+    size_t codeAt = 0;
+    size_t o = 1;
+    uint8_t code = 1;
+    for (size_t i = 0; i < len; ++i) {
+        if (in[i] != 0) {
+            out[o++] = in[i];
+            ++code;
+        }
+        if (in[i] == 0 || code == 0xFF) {
+            out[codeAt] = code;
+            codeAt = o++;
+            code = 1;
+        }
+    }
+    out[codeAt] = code;
+    out[o++] = 0;
+    return o;
+}
+
+// Fills the CRC and encodes one joint frame, returns the wire size (0 = capacity too small)
+inline size_t encode(const LegCommand& cmd, uint8_t* out, size_t capacity) {
+    FastJointFrame frame;
+    frame.command = cmd;
+    frame.crc = crc16(&frame.command, sizeof(LegCommand));
+    return cobsEncode(reinterpret_cast<const uint8_t*>(&frame), sizeof(frame), out, capacity);
+}
+
+// Frame decoded in place: CRC, version and joint count match
+inline bool valid(const FastJointFrame& frame) {
+    return frame.crc == crc16(&frame.command, sizeof(LegCommand)) &&
+           frame.command.version == LEG_COMMAND_VERSION && frame.command.jointCount == LEG_COMMAND_JOINTS;
+}
+
+// Streaming COBS decoder, one byte at a time, straight into a caller-owned destination (no frame copy).
+// The destination may change between frames (reset), e.g. the write slot of a triple buffer.
+class CobsDecoder {
+public:
+    enum class Result : uint8_t {
+        Pending, // frame not complete yet
+        Frame,   // delimiter after a complete frame, size() bytes in the destination
+        Error    // truncated group or longer than the destination
+    };
+
+    void reset(uint8_t* destination, size_t capacity) {
+        dest = destination;
+        dest_capacity = capacity;
+        restart();
+    }
+
+    Result push(uint8_t byte) {
+        if (byte == 0) {
+            const bool started = code != 0 || overflow;
+            const bool complete = remaining == 0 && !overflow;
+            last_size = length;
+            restart();
+            // Leere Frames (doppelter Delimiter) sind nur Füllbytes
+            if (!started) return Result::Pending;
+            return complete ? Result::Frame : Result::Error;
+        }
+        if (overflow) return Result::Pending; // bis zum nächsten Delimiter verwerfen
+        if (remaining == 0) {
+            // Neue Gruppe: die vorige endete (außer bei 0xFF) mit einer implizierten Null
+            if (code != 0 && code != 0xFF) put(0);
+            code = byte;
+            remaining = static_cast<uint8_t>(byte - 1);
+            return Result::Pending;
+        }
+        put(byte);
+        --remaining;
+        return Result::Pending;
+    }
+
+    // Bytes of the last completed frame
+    size_t size() const { return last_size; }
+
+private:
+    void restart() {
+        length = 0;
+        code = 0;
+        remaining = 0;
+        overflow = false;
+    }
+
+    void put(uint8_t byte) {
+        if (length >= dest_capacity) {
+            overflow = true;
+            return;
+        }
+        dest[length++] = byte;
+    }
+
+    uint8_t* dest = nullptr;
+    size_t dest_capacity = 0;
+    size_t length = 0;
+    size_t last_size = 0;
+    uint8_t code = 0;
+    uint8_t remaining = 0;
+    bool overflow = false;
+};
+
+} // namespace fast_frame
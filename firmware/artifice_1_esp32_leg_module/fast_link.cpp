@@ -0,0 +1,86 @@
+#include "fast_link.hpp"
+#include "logger.hpp"
+#include "motion_controller.hpp"
+#include "trace.hpp"
+
+FastLink::FastLink(MotionController* controller)
+    : controller(controller)
+{
+}
+
+FastLink::Config FastLink::defaultConfig() {
+    return {FAST_LINK_UART_PORT, FAST_LINK_UART_BAUD, FAST_LINK_UART_TX, FAST_LINK_UART_RX};
+}
+
+void FastLink::restartDecoder() {
+    // Ziel ist immer der aktuelle Schreib-Slot des Controllers
+    decoder.reset(reinterpret_cast<uint8_t*>(&controller->fastFrameSlot().frame), sizeof(FastJointFrame));
+}
+
+void FastLink::feed(const uint8_t* data, size_t len, int64_t rxUs) {
+    bytes.fetch_add(static_cast<uint32_t>(len), std::memory_order_relaxed);
+    for (size_t i = 0; i < len; ++i) {
+        if (!synced) {
+            // Start mitten im Frame: alles bis zum ersten Delimiter verwerfen
+            if (data[i] != 0) continue;
+            synced = true;
+            restartDecoder();
+            continue;
+        }
+        switch (decoder.push(data[i])) {
+            case fast_frame::CobsDecoder::Result::Frame:
+                finishFrame(rxUs);
+                break;
+            case fast_frame::CobsDecoder::Result::Error:
+                framing_errors.fetch_add(1, std::memory_order_relaxed);
+                break;
+            case fast_frame::CobsDecoder::Result::Pending:
+                break;
+        }
+    }
+}
+
+void FastLink::finishFrame(int64_t rxUs) {
+    MotionController::FastSlot& slot = controller->fastFrameSlot();
+    if (decoder.size() != sizeof(FastJointFrame)) {
+        framing_errors.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    if (slot.frame.crc != fast_frame::crc16(&slot.frame.command, sizeof(LegCommand))) {
+        crc_errors.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    if (slot.frame.command.version != LEG_COMMAND_VERSION || slot.frame.command.jointCount != LEG_COMMAND_JOINTS) {
+        framing_errors.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    if (!tracker.accept(slot.frame.command)) return;
+    slot.parsedUs = rxUs;
+    TRACE_EVENT(FastFrame, slot.frame.command.sequence);
+    controller->publishFastFrame();
+    // Nach dem Publish gehört der Slot dem Loop, nächster Frame in den neuen Schreib-Slot
+    restartDecoder();
+}
+
+FastLink::Stats FastLink::stats() const {
+    CommandTracker::Stats s = tracker.stats();
+    Stats out;
+    out.frames = s.accepted;
+    out.dropped = s.dropped;
+    out.stale = s.stale;
+    out.crcErrors = crc_errors.load(std::memory_order_relaxed);
+    out.framingErrors = framing_errors.load(std::memory_order_relaxed);
+    out.overruns = overruns.load(std::memory_order_relaxed);
+    out.bytes = bytes.load(std::memory_order_relaxed);
+    return out;
+}
+
+void FastLink::reportHealth() {
+    Stats s = stats();
+    LOG_L("fast link: frames %u, dropped %u, stale %u, bytes %u", s.frames, s.dropped, s.stale, s.bytes);
+    if (s.crcErrors > 0 || s.framingErrors > 0 || s.overruns > 0) {
+        LOG_E("fast link: %u crc errors, %u framing errors, %u overruns", s.crcErrors, s.framingErrors, s.overruns);
+    }
+    CommandLatency l = controller->fastLatency();
+    LOG_L("fast link parse -> latch min %u mean %u max %u us (n=%u)", l.minUs, l.meanUs, l.maxUs, l.count);
+}
@@ -0,0 +1,83 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include "fast_frame.hpp"
+#include "leg_command.hpp"
+
+class MotionController;
+
+// Optional raw command channel straight into the control loop (fast_frame.hpp wire format), for gait loops
+// where even a trimmed XRCE-DDS path is too slow. ROS stays up for configuration and telemetry.
+// On the ESP32 a reader task takes the bytes from the interrupt-driven UART driver ring, the COBS decoder
+// writes them directly into the control loop's fast frame slot; nothing is copied after the UART driver.
+#ifndef FAST_LINK_ENABLED
+#define FAST_LINK_ENABLED 0
+#endif
+#ifndef FAST_LINK_UART_PORT
+#define FAST_LINK_UART_PORT 2
+#endif
+#ifndef FAST_LINK_UART_BAUD
+#define FAST_LINK_UART_BAUD 921600
+#endif
+// Freie Pins neben Servos (19/18/5/17/16/4) und XRCE-UART (22/23)
+#ifndef FAST_LINK_UART_TX
+#define FAST_LINK_UART_TX 33
+#endif
+#ifndef FAST_LINK_UART_RX
+#define FAST_LINK_UART_RX 32
+#endif
+
+class FastLink {
+public:
+    struct Config {
+        uint32_t uartPort;
+        uint32_t uartBaud;
+        int uartTx;
+        int uartRx;
+    };
+
+    struct Stats {
+        uint32_t frames;        // accepted and handed to the control loop
+        uint32_t dropped;       // sequence gaps: frames lost on the line
+        uint32_t stale;         // duplicate or older than the last frame
+        uint32_t crcErrors;
+        uint32_t framingErrors; // COBS error, wrong length, version or joint count
+        uint32_t overruns;      // UART driver ring / FIFO overflowed (ESP32)
+        uint32_t bytes;
+    };
+
+    explicit FastLink(MotionController* controller);
+
+    static Config defaultConfig();
+
+    // Installs the UART driver and starts the reader task (ESP32 only, fast_link_uart_esp32.cpp)
+    bool start(const Config& config);
+
+    // Received bytes in any split, from one task. rxUs: hal::nowUs() right after the read,
+    // start of the parse -> actuation latency.
+    void feed(const uint8_t* data, size_t len, int64_t rxUs);
+
+    Stats stats() const;
+    void reportHealth();
+
+    // Called from the UART reader when bytes were lost: drops the half-decoded frame, decoding resumes after
+    // the next delimiter (same task as feed)
+    void countOverrun() {
+        overruns.fetch_add(1, std::memory_order_relaxed);
+        synced = false;
+    }
+
+private:
+    void restartDecoder();
+    void finishFrame(int64_t rxUs);
+
+    MotionController* controller;
+    fast_frame::CobsDecoder decoder;
+    CommandTracker tracker;
+    bool synced = false;   // erster Delimiter gesehen, davor Rest eines halben Frames
+    std::atomic<uint32_t> crc_errors{0};
+    std::atomic<uint32_t> framing_errors{0};
+    std::atomic<uint32_t> overruns{0};
+    std::atomic<uint32_t> bytes{0};
+};
@@ -0,0 +1,83 @@
+#ifdef ESP_PLATFORM
+#include "fast_link.hpp"
+#include "driver/uart.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "hal.hpp"
+#include "logger.hpp"
+#include "task_layout.hpp"
+
+// UART-Leser des Fast-Path: der IDF-Treiber füllt per Interrupt seinen RX-Ring, RX-Timeout nach einem
+// Zeichen Pause meldet auch einen unvollständigen FIFO sofort. Der Task liest in kleinen Blöcken und
+// gibt sie an den Decoder, der direkt in den Slot des Control-Loops schreibt.
+
+namespace {
+
+const size_t RX_RING_BYTES = 512;       // >= 20 Frames Rückstau
+const int EVENT_QUEUE_DEPTH = 16;
+const uint8_t RX_FULL_THRESHOLD = 16;   // FIFO-Interrupt nach 16 Bytes ...
+const uint8_t RX_TIMEOUT_SYMBOLS = 1;   // ... oder nach einer Zeichenlänge Pause
+const size_t READ_CHUNK_BYTES = 32;
+
+uart_port_t fast_port = UART_NUM_2;
+QueueHandle_t event_queue = nullptr;
+
+void readerTask(void* arg) {
+    FastLink* link = static_cast<FastLink*>(arg);
+    uint8_t chunk[READ_CHUNK_BYTES];
+    uart_event_t event;
+    while (true) {
+        if (xQueueReceive(event_queue, &event, portMAX_DELAY) != pdTRUE) continue;
+        switch (event.type) {
+            case UART_DATA: {
+                size_t pending = event.size;
+                while (pending > 0) {
+                    const int n = uart_read_bytes(fast_port, chunk, pending < sizeof(chunk) ? pending : sizeof(chunk), 0);
+                    if (n <= 0) break;
+                    link->feed(chunk, static_cast<size_t>(n), hal::nowUs());
+                    pending -= static_cast<size_t>(n);
+                }
+                break;
+            }
+            case UART_FIFO_OVF:
+            case UART_BUFFER_FULL:
+                // Bytes verloren: Ring leeren, halben Frame verwerfen, Decoder fängt nach dem nächsten Delimiter wieder an
+                link->countOverrun();
+                uart_flush_input(fast_port);
+                xQueueReset(event_queue);
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+} // namespace
+
+bool FastLink::start(const Config& config) {
+    fast_port = static_cast<uart_port_t>(config.uartPort);
+    uart_config_t uart{};
+    uart.baud_rate = static_cast<int>(config.uartBaud);
+    uart.data_bits = UART_DATA_8_BITS;
+    uart.parity = UART_PARITY_DISABLE;
+    uart.stop_bits = UART_STOP_BITS_1;
+    uart.flow_ctrl = UART_HW_FLOWCTRL_DISABLE;
+    if (uart_param_config(fast_port, &uart) != ESP_OK ||
+        uart_set_pin(fast_port, config.uartTx < 0 ? UART_PIN_NO_CHANGE : config.uartTx,
+                     config.uartRx < 0 ? UART_PIN_NO_CHANGE : config.uartRx,
+                     UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE) != ESP_OK ||
+        uart_driver_install(fast_port, RX_RING_BYTES, 0, EVENT_QUEUE_DEPTH, &event_queue, 0) != ESP_OK) {
+        LOG_E("fast link: UART %u setup failed", config.uartPort);
+        return false;
+    }
+    uart_set_rx_full_threshold(fast_port, RX_FULL_THRESHOLD);
+    uart_set_rx_timeout(fast_port, RX_TIMEOUT_SYMBOLS);
+    if (!task_layout::start(task_layout::FAST_LINK, readerTask, this)) {
+        LOG_E("Failed to create fast link task");
+        return false;
+    }
+    LOG_L("fast link on UART %u, %u baud", config.uartPort, config.uartBaud);
+    return true;
+}
+
+#endif // ESP_PLATFORM
@@ -0,0 +1,38 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+
+// Lock-free triple buffer for one writer task and one reader task.
+// The writer never waits for the reader, the reader always gets the latest complete frame.
+template <typename T>
+class TripleBuffer {
+public:
+    // Writer: slot that may be filled freely until publish()
+    T& writeBuffer() { return buffers[write_index]; }
+
+    // Writer: makes the write slot the latest frame
+    void publish() {
+        const uint8_t prev = state.exchange(static_cast<uint8_t>(write_index | FRESH), std::memory_order_acq_rel);
+        write_index = prev & INDEX_MASK;
+    }
+
+    // Reader: takes the latest frame if one was published since the last call
+    bool consume() {
+        if (!(state.load(std::memory_order_relaxed) & FRESH)) return false;
+        const uint8_t prev = state.exchange(read_index, std::memory_order_acq_rel);
+        read_index = prev & INDEX_MASK;
+        return true;
+    }
+
+    // Reader: frame taken by the last successful consume()
+    const T& readBuffer() const { return buffers[read_index]; }
+
+private:
+    static const uint8_t INDEX_MASK = 0x03;
+    static const uint8_t FRESH = 0x04;
+
+    T buffers[3] = {};
+    std::atomic<uint8_t> state{2}; // mittlerer Slot
+    uint8_t write_index = 0;       // nur Writer
+    uint8_t read_index = 1;        // nur Reader
+};
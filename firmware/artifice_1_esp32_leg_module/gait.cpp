@@ -0,0 +1,58 @@
+#include "gait.hpp"
+#include <cmath>
+
+namespace gait {
+
+namespace {
+
+const float PI = 3.14159265f;
+const float PHASE_SCALE = 1.0f / 4294967296.0f;
+
+template <typename T>
+T clampValue(T v, T lo, T hi) {
+    return v < lo ? lo : (v > hi ? hi : v);
+}
+
+} // namespace
+
+void GaitGenerator::setParams(const GaitParams& params) {
+    current = params;
+    current.strideUm = clampValue(params.strideUm, -MAX_STRIDE_UM, MAX_STRIDE_UM);
+    current.stepHeightUm = clampValue(params.stepHeightUm, static_cast<int32_t>(0), MAX_STEP_HEIGHT_UM);
+    current.frequencyMilliHz = clampValue(params.frequencyMilliHz, static_cast<uint32_t>(0), MAX_FREQUENCY_MILLIHZ);
+    current.dutyFactor = clampValue(params.dutyFactor, MIN_DUTY_FACTOR, MAX_DUTY_FACTOR);
+}
+
+void GaitGenerator::advance(int64_t dtUs) {
+    if (dtUs <= 0) return;
+    if (dtUs > 100000) dtUs = 100000; // nach Aussetzern nicht springen
+    // phase += f * dt, 2^32 = ein Zyklus
+    const uint64_t cyclesE9 = static_cast<uint64_t>(current.frequencyMilliHz) * static_cast<uint64_t>(dtUs);
+    phase += static_cast<uint32_t>((cyclesE9 << 32) / 1000000000ULL);
+}
+
+void GaitGenerator::foot(size_t leg, int32_t* footUm) const {
+    const uint32_t legPhase = phase + static_cast<uint32_t>(leg * current.phaseOffset) * 65536u;
+    const float s = static_cast<float>(legPhase) * PHASE_SCALE;
+    const float duty = static_cast<float>(current.dutyFactor) / 65536.0f;
+    const float stride = static_cast<float>(current.strideUm);
+
+    float x, lift;
+    if (s < duty) {
+        // Stand: Fuß läuft mit konstanter Geschwindigkeit nach hinten
+        const float u = s / duty;
+        x = stride * (0.5f - u);
+        lift = 0.0f;
+    } else {
+        // Schwung: glatter Rücklauf nach vorn, Hub als Sinusbogen
+        const float u = (s - duty) / (1.0f - duty);
+        x = stride * (0.5f * (1.0f - std::cos(PI * u)) - 0.5f);
+        lift = static_cast<float>(current.stepHeightUm) * std::sin(PI * u);
+    }
+
+    footUm[0] = current.neutralUm[0] + static_cast<int32_t>(std::lround(x));
+    footUm[1] = current.neutralUm[1];
+    footUm[2] = current.neutralUm[2] + static_cast<int32_t>(std::lround(lift));
+}
+
+} // namespace gait
@@ -0,0 +1,46 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// Phase-based gait for the legs of one module. One phase accumulator (2^32 = one cycle) drives all legs,
+// leg n is shifted by n * phaseOffset. Stance: the foot moves backwards on the ground line,
+// swing: it returns forward on a smooth arc lifted by stepHeight. Foot positions in micrometers (leg frame).
+namespace gait {
+
+struct GaitParams {
+    int32_t strideUm;          // foot travel per cycle along x
+    int32_t stepHeightUm;      // lift in the middle of the swing
+    uint32_t frequencyMilliHz; // cycles per 1000 s
+    uint16_t phaseOffset;      // phase of leg n+1 relative to leg n, 1/65536 cycle (32768 = alternating)
+    uint16_t dutyFactor;       // stance share of the cycle, 1/65536
+    int32_t neutralUm[3];      // foot x/y/z at the center of the stride
+};
+
+// Limits applied by setParams
+static const int32_t MAX_STRIDE_UM = 80000;
+static const int32_t MAX_STEP_HEIGHT_UM = 50000;
+static const uint32_t MAX_FREQUENCY_MILLIHZ = 3000;
+static const uint16_t MIN_DUTY_FACTOR = 13107; // 0.2
+static const uint16_t MAX_DUTY_FACTOR = 58982; // 0.9
+
+class GaitGenerator {
+public:
+    // Takes over new parameters (clamped to the limits above), the phase continues
+    void setParams(const GaitParams& params);
+    const GaitParams& params() const { return current; }
+
+    // Back to the start of the cycle
+    void reset() { phase = 0; }
+    // Advances the phase by dtUs at the current frequency
+    void advance(int64_t dtUs);
+    uint32_t cyclePhase() const { return phase; }
+
+    // Foot position of one leg at the current phase
+    void foot(size_t leg, int32_t* footUm) const;
+
+private:
+    GaitParams current{};
+    uint32_t phase = 0;
+};
+
+} // namespace gait
@@ -0,0 +1,82 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// Hardware abstraction for PWM, clock and tasks.
+// ESP32: hal_esp32.cpp (LEDC + FreeRTOS), Host: host/hal_linux.cpp (pthreads + simulated LEDC)
+namespace hal {
+
+// ---------- PWM (LEDC) ----------
+
+// Channels 0..15; on the ESP32 0-7 are the high-speed LEDC group, 8-15 the low-speed group
+static const uint32_t PWM_CHANNELS = 16;
+// Configures the PWM timer(s) used by all servo channels, same frequency / resolution in both groups
+void pwmInitTimer(uint32_t freq_hz, uint32_t resolution_bits);
+// Binds a PWM channel to a GPIO, duty starts at 0; false if the channel could not be configured
+bool pwmInitChannel(uint32_t channel, int gpio);
+// Writes the duty into the channel register (not yet active)
+void pwmSetDuty(uint32_t channel, uint32_t duty);
+// Latches the written duty so it becomes active with the next PWM period
+void pwmUpdateDuty(uint32_t channel);
+// Latches all channels of the mask back to back (no preemption), so they start in the same PWM period
+void pwmLatch(uint32_t channelMask);
+
+// ---------- Clock ----------
+
+// Monotonic time since boot in microseconds
+int64_t nowUs();
+void delayMs(uint32_t ms);
+// Free-running cycle counter of the calling core for short intervals / tracing (ESP32: CCOUNT, wraps after
+// ~18 s at 240 MHz, not synchronized between cores; Host: monotonic nanoseconds)
+uint32_t cycleCount();
+uint32_t cyclesPerUs();
+// Core the caller runs on (Host: CPU of the thread, 0 if unknown)
+int currentCore();
+
+// Periodic wakeup for the calling task, absolute cadence (no drift from execution time).
+// ESP32: esp_timer + task notification bits, Host: condition variable with absolute deadline
+static const int MAX_PERIODIC_TIMERS = 4;
+// Wake reasons returned by periodicWait (bit mask)
+static const uint32_t WAKE_PERIOD = 1u << 0; // period boundary passed
+static const uint32_t WAKE_EVENT = 1u << 1;  // periodicNotify() from another task
+static const uint32_t WAKE_AT = 1u << 2;     // one-shot wakeup armed with periodicWakeAt()
+// Returns a handle >= 0, or -1 if no timer is free
+int periodicStart(uint32_t periodUs);
+// Blocks until the next period boundary or a periodicNotify(), returns the WAKE_* bits (0 = invalid handle)
+uint32_t periodicWait(int handle);
+// Wakes the task blocked in periodicWait early, the period grid is not moved. Callable from any task.
+void periodicNotify(int handle);
+// Arms one extra wakeup at atUs (nowUs() clock) for the task of the handle, the period grid is not moved.
+// One per handle: a new call replaces the pending one, a time in the past wakes at once. Call from that task.
+void periodicWakeAt(int handle, int64_t atUs);
+// Changes the period of a running timer in place (handle stays valid, a pending periodicWakeAt stays armed),
+// the next boundary is one new period from now. Call from the task of the handle.
+void periodicSetPeriod(int handle, uint32_t periodUs);
+void periodicStop(int handle);
+
+// ---------- Tasks ----------
+
+using TaskFunction = void (*)(void*);
+
+static const int ANY_CORE = -1;
+
+// Stacks of all tasks started with createTask come from one static pool (ESP32: xTaskCreateStatic)
+static const uint32_t TASK_STACK_POOL_BYTES = 20 * 1024;
+static const int MAX_TASKS = 4;
+
+// Starts a task, stackBytes like ESP-IDF xTaskCreate (bytes, not words). Fails if the static pool is exhausted.
+// core >= 0 pins the task to that core (ESP32: xTaskCreateStaticPinnedToCore, Host: CPU affinity if available)
+bool createTask(TaskFunction fn, const char* name, uint32_t stackBytes, void* arg, int priority,
+                int core = ANY_CORE);
+// Ends the calling task (never returns)
+void deleteCurrentTask();
+// Lowest free stack since start (high-water mark) of a task started with createTask, found by name.
+// false if there is no such task or the platform cannot measure it (host)
+bool taskStackFreeMin(const char* name, uint32_t& bytes);
+
+// ---------- Memory ----------
+
+// Bytes currently allocated from the system heap (for "no allocation after boot" checks)
+size_t heapUsedBytes();
+
+} // namespace hal
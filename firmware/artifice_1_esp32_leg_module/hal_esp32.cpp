@@ -0,0 +1,239 @@
+#ifdef ESP_PLATFORM
+#include "hal.hpp"
+#include "driver/gpio.h"
+#include "driver/ledc.h"
+#include <cstring>
+#include "esp_heap_caps.h"
+#include "esp_rom_sys.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "xtensa/hal.h"
+
+namespace hal {
+
+// Channel 0-7 im High-Speed-, 8-15 im Low-Speed-Block, jeder Block mit seinem Timer 0
+static const uint32_t CHANNELS_PER_GROUP = 8;
+static const ledc_timer_t PWM_TIMER = LEDC_TIMER_0;
+
+static ledc_mode_t modeOf(uint32_t channel) {
+    return channel < CHANNELS_PER_GROUP ? LEDC_HIGH_SPEED_MODE : LEDC_LOW_SPEED_MODE;
+}
+
+static ledc_channel_t channelOf(uint32_t channel) {
+    return static_cast<ledc_channel_t>(channel % CHANNELS_PER_GROUP);
+}
+
+void pwmInitTimer(uint32_t freq_hz, uint32_t resolution_bits) {
+    const ledc_mode_t modes[] = {LEDC_HIGH_SPEED_MODE, LEDC_LOW_SPEED_MODE};
+    for (ledc_mode_t mode : modes) {
+        ledc_timer_config_t timer_conf{};
+        timer_conf.speed_mode       = mode;
+        timer_conf.timer_num        = PWM_TIMER;
+        timer_conf.duty_resolution  = static_cast<ledc_timer_bit_t>(resolution_bits);
+        timer_conf.freq_hz          = freq_hz;
+        timer_conf.clk_cfg          = LEDC_AUTO_CLK;
+        ledc_timer_config(&timer_conf);
+    }
+}
+
+bool pwmInitChannel(uint32_t channel, int gpio) {
+    if (channel >= PWM_CHANNELS) return false;
+    ledc_channel_config_t ch_conf{};
+    ch_conf.channel    = channelOf(channel);
+    ch_conf.gpio_num   = gpio;
+    ch_conf.speed_mode = modeOf(channel);
+    ch_conf.timer_sel  = PWM_TIMER;
+    ch_conf.duty       = 0;
+    return ledc_channel_config(&ch_conf) == ESP_OK;
+}
+
+void pwmSetDuty(uint32_t channel, uint32_t duty) {
+    ledc_set_duty(modeOf(channel), channelOf(channel), duty);
+}
+
+void pwmUpdateDuty(uint32_t channel) {
+    ledc_update_duty(modeOf(channel), channelOf(channel));
+}
+
+static portMUX_TYPE pwm_latch_mux = portMUX_INITIALIZER_UNLOCKED;
+
+void pwmLatch(uint32_t channelMask) {
+    // Kritischer Abschnitt hält das Fenster zwischen erstem und letztem Channel bei wenigen us
+    portENTER_CRITICAL(&pwm_latch_mux);
+    for (uint32_t ch = 0; channelMask != 0; ++ch, channelMask >>= 1) {
+        if (channelMask & 1u) ledc_update_duty(modeOf(ch), channelOf(ch));
+    }
+    portEXIT_CRITICAL(&pwm_latch_mux);
+}
+
+int64_t nowUs() {
+    return esp_timer_get_time();
+}
+
+void delayMs(uint32_t ms) {
+    vTaskDelay(pdMS_TO_TICKS(ms));
+}
+
+uint32_t cycleCount() {
+    return xthal_get_ccount();
+}
+
+uint32_t cyclesPerUs() {
+    return esp_rom_get_cpu_ticks_per_us();
+}
+
+int currentCore() {
+    return static_cast<int>(xPortGetCoreID());
+}
+
+namespace {
+
+struct PeriodicSlot {
+    esp_timer_handle_t timer = nullptr;
+    esp_timer_handle_t wake_timer = nullptr; // one-shot für periodicWakeAt
+    TaskHandle_t task = nullptr;
+};
+
+PeriodicSlot periodic_slots[MAX_PERIODIC_TIMERS];
+
+// Läuft im esp_timer Task, weckt den wartenden Task
+void periodicCallback(void* arg) {
+    xTaskNotify(static_cast<TaskHandle_t>(arg), WAKE_PERIOD, eSetBits);
+}
+
+void wakeAtCallback(void* arg) {
+    xTaskNotify(static_cast<TaskHandle_t>(arg), WAKE_AT, eSetBits);
+}
+
+} // namespace
+
+int periodicStart(uint32_t periodUs) {
+    for (int i = 0; i < MAX_PERIODIC_TIMERS; ++i) {
+        PeriodicSlot& slot = periodic_slots[i];
+        if (slot.timer) continue;
+
+        slot.task = xTaskGetCurrentTaskHandle();
+        esp_timer_create_args_t args{};
+        args.callback = periodicCallback;
+        args.arg = slot.task;
+        args.dispatch_method = ESP_TIMER_TASK;
+        args.name = "hal_periodic";
+        if (esp_timer_create(&args, &slot.timer) != ESP_OK) {
+            slot.timer = nullptr;
+            return -1;
+        }
+        args.callback = wakeAtCallback;
+        args.name = "hal_wake_at";
+        if (esp_timer_create(&args, &slot.wake_timer) != ESP_OK) {
+            esp_timer_delete(slot.timer);
+            slot.timer = nullptr;
+            slot.wake_timer = nullptr;
+            return -1;
+        }
+        esp_timer_start_periodic(slot.timer, periodUs);
+        return i;
+    }
+    return -1;
+}
+
+uint32_t periodicWait(int handle) {
+    if (handle < 0 || handle >= MAX_PERIODIC_TIMERS || !periodic_slots[handle].timer) return 0;
+    // Bits statt Zähler: mehrere aufgelaufene Ticks/Events werden zu einem Wakeup zusammengefasst
+    uint32_t bits = 0;
+    while (bits == 0) {
+        xTaskNotifyWait(0, WAKE_PERIOD | WAKE_EVENT | WAKE_AT, &bits, portMAX_DELAY);
+        bits &= WAKE_PERIOD | WAKE_EVENT | WAKE_AT;
+    }
+    return bits;
+}
+
+void periodicNotify(int handle) {
+    if (handle < 0 || handle >= MAX_PERIODIC_TIMERS) return;
+    TaskHandle_t task = periodic_slots[handle].task;
+    if (task) xTaskNotify(task, WAKE_EVENT, eSetBits);
+}
+
+void periodicWakeAt(int handle, int64_t atUs) {
+    if (handle < 0 || handle >= MAX_PERIODIC_TIMERS || !periodic_slots[handle].wake_timer) return;
+    PeriodicSlot& slot = periodic_slots[handle];
+    esp_timer_stop(slot.wake_timer); // läuft evtl. nicht, Fehler egal
+    const int64_t delay = atUs - esp_timer_get_time();
+    if (delay <= 0) {
+        xTaskNotify(slot.task, WAKE_AT, eSetBits);
+        return;
+    }
+    esp_timer_start_once(slot.wake_timer, static_cast<uint64_t>(delay));
+}
+
+void periodicSetPeriod(int handle, uint32_t periodUs) {
+    if (handle < 0 || handle >= MAX_PERIODIC_TIMERS || !periodic_slots[handle].timer) return;
+    // Gleiches Handle, kein Löschen: periodicNotify aus anderen Tasks sieht nie einen halb abgebauten Slot
+    esp_timer_stop(periodic_slots[handle].timer);
+    esp_timer_start_periodic(periodic_slots[handle].timer, periodUs);
+}
+
+void periodicStop(int handle) {
+    if (handle < 0 || handle >= MAX_PERIODIC_TIMERS || !periodic_slots[handle].timer) return;
+    PeriodicSlot& slot = periodic_slots[handle];
+    esp_timer_stop(slot.timer);
+    esp_timer_delete(slot.timer);
+    slot.timer = nullptr;
+    esp_timer_stop(slot.wake_timer);
+    esp_timer_delete(slot.wake_timer);
+    slot.wake_timer = nullptr;
+    slot.task = nullptr;
+}
+
+namespace {
+
+// Statischer Speicher für alle Tasks, Stacks werden nacheinander aus dem Pool geschnitten (ESP-IDF: Bytes)
+StackType_t task_stack_pool[TASK_STACK_POOL_BYTES] __attribute__((aligned(16)));
+StaticTask_t task_tcbs[MAX_TASKS];
+TaskHandle_t task_handles[MAX_TASKS];
+uint32_t task_stack_used = 0;
+int task_count = 0;
+portMUX_TYPE task_pool_mux = portMUX_INITIALIZER_UNLOCKED;
+
+} // namespace
+
+bool createTask(TaskFunction fn, const char* name, uint32_t stackBytes, void* arg, int priority, int core) {
+    stackBytes = (stackBytes + 15u) & ~15u;
+    portENTER_CRITICAL(&task_pool_mux);
+    if (task_count >= MAX_TASKS || stackBytes > TASK_STACK_POOL_BYTES - task_stack_used) {
+        portEXIT_CRITICAL(&task_pool_mux);
+        return false;
+    }
+    StackType_t* stack = &task_stack_pool[task_stack_used];
+    StaticTask_t* tcb = &task_tcbs[task_count];
+    TaskHandle_t* handle = &task_handles[task_count];
+    task_stack_used += stackBytes;
+    ++task_count;
+    portEXIT_CRITICAL(&task_pool_mux);
+
+    const BaseType_t cpu = (core < 0 || core >= portNUM_PROCESSORS) ? tskNO_AFFINITY : core;
+    *handle = xTaskCreateStaticPinnedToCore(fn, name, stackBytes, arg, priority, stack, tcb, cpu);
+    return *handle != nullptr;
+}
+
+bool taskStackFreeMin(const char* name, uint32_t& bytes) {
+    for (int i = 0; i < task_count; ++i) {
+        if (task_handles[i] && std::strcmp(pcTaskGetName(task_handles[i]), name) == 0) {
+            // ESP-IDF: Stacks in Bytes, also auch der High-Water-Mark
+            bytes = uxTaskGetStackHighWaterMark(task_handles[i]);
+            return true;
+        }
+    }
+    return false;
+}
+
+void deleteCurrentTask() {
+    vTaskDelete(nullptr);
+}
+
+size_t heapUsedBytes() {
+    return heap_caps_get_total_size(MALLOC_CAP_DEFAULT) - heap_caps_get_free_size(MALLOC_CAP_DEFAULT);
+}
+
+} // namespace hal
+#endif // ESP_PLATFORM
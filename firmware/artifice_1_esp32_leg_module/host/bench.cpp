@@ -0,0 +1,474 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../command_router.hpp"
+#include "../fast_frame.hpp"
+#include "../fast_link.hpp"
+#include "../frame_buffer.hpp"
+#include "../leg_kinematics.hpp"
+#include "../motion_controller.hpp"
+#include "../playout_buffer.hpp"
+#include "../ring_queue.hpp"
+#include "../servo_driver.hpp"
+#include "../trajectory.hpp"
+#include "../waypoint_queue.hpp"
+#include "sim_pwm.hpp"
+
+// Mikrobenchmarks der Hot Paths mit Baseline: Interpolation je Control-Tick, Winkel -> Duty im ServoDriver,
+// Decode + Übergabe der Kommando-Frames (der Pfad der ROS-Callbacks), Fast-Path-Decoder und die Übergabe
+// zwischen zwei Threads unter Konkurrenz. Jeder Fall läuft --repeat mal, verglichen wird der Median in ns/op.
+// --write-baseline schreibt Median und Grenze (Median + --tolerance %), --baseline prüft dagegen: ein Fall über
+// seiner Grenze -> Exit-Code 1. Die Baseline gilt nur für die Maschine, auf der sie geschrieben wurde.
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const size_t LEGS = MotionController::NUM_LEGS;
+const size_t JPL = MotionController::JOINTS_PER_LEG;
+const size_t SERVOS = MotionController::NUM_SERVOS;
+
+// Verhindert, dass der Compiler Ergebnisse wegoptimiert
+volatile int64_t sink = 0;
+// Läufe, in denen Frames abgelehnt wurden: dann wäre der billigere Fehlerpfad gemessen
+uint32_t rejected_runs = 0;
+
+void expectAccepted(uint32_t accepted, uint32_t iterations) {
+    if (accepted != iterations) ++rejected_runs;
+}
+
+struct Options {
+    uint32_t repeat = 7;
+    uint32_t tolerancePercent = 50;
+    uint32_t batchMs = 20;
+    const char* filter = nullptr;
+    const char* baselinePath = nullptr;
+    const char* writePath = nullptr;
+};
+
+// Ein Fall: führt iterations Operationen aus und gibt die Laufzeit in ns zurück
+struct Case {
+    const char* name;
+    const char* what;
+    int64_t (*run)(uint32_t iterations);
+};
+
+template <typename Fn>
+int64_t timed(Fn fn) {
+    const Clock::time_point t0 = Clock::now();
+    fn();
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - t0).count();
+}
+
+// ---------- Interpolation je Control-Tick ----------
+
+int64_t trajectorySample(uint32_t iterations) {
+    trajectory::LegTrajectory legs[LEGS];
+    int32_t start[JPL], target[JPL], out[JPL];
+    for (size_t j = 0; j < JPL; ++j) {
+        start[j] = 6000;
+        target[j] = 14000;
+    }
+    for (size_t leg = 0; leg < LEGS; ++leg) {
+        legs[leg].plan(start, target, &LegModule::JOINT_LIMITS[LegModule::servo(leg, 0)], JPL,
+                       trajectory::ProfileType::SCurve, 0);
+    }
+    const int64_t duration = legs[0].durationUs();
+    return timed([&] {
+        for (uint32_t i = 0; i < iterations; ++i) {
+            const int64_t now = (static_cast<int64_t>(i) * 997) % duration;
+            for (size_t leg = 0; leg < LEGS; ++leg) {
+                legs[leg].sample(now, out);
+                sink = sink + out[0];
+            }
+        }
+    });
+}
+
+int64_t trajectoryPlan(uint32_t iterations) {
+    trajectory::LegTrajectory legs[LEGS];
+    int32_t start[JPL], target[JPL];
+    return timed([&] {
+        for (uint32_t i = 0; i < iterations; ++i) {
+            for (size_t j = 0; j < JPL; ++j) {
+                start[j] = 6000 + static_cast<int32_t>(i % 100) * 10;
+                target[j] = 14000 - static_cast<int32_t>(j) * 500;
+            }
+            for (size_t leg = 0; leg < LEGS; ++leg) {
+                legs[leg].plan(start, target, &LegModule::JOINT_LIMITS[LegModule::servo(leg, 0)], JPL,
+                               trajectory::ProfileType::SCurve, i);
+            }
+            sink = sink + legs[0].durationUs();
+        }
+    });
+}
+
+int64_t playoutTick(uint32_t iterations) {
+    PlayoutBuffer playout(MotionController::PLAYOUT_CONFIG, SERVOS);
+    int32_t frame[SERVOS], out[SERVOS];
+    return timed([&] {
+        // 1 kHz Tick, alle 5 Ticks ein Frame mit etwas Jitter
+        for (uint32_t i = 0; i < iterations; ++i) {
+            const int64_t now = static_cast<int64_t>(i) * 1000;
+            if (i % 5 == 0) {
+                for (size_t s = 0; s < SERVOS; ++s) frame[s] = 9000 + static_cast<int32_t>(i % 400);
+                playout.push(frame, static_cast<uint32_t>(now), now + (i * 7919) % 3000);
+            }
+            playout.sample(now, out);
+            sink = sink + out[0];
+        }
+    });
+}
+
+int64_t waypointTick(uint32_t iterations) {
+    trajectory::WaypointQueue queue(JPL);
+    trajectory::Waypoint points[MotionController::MAX_CHUNK_POINTS];
+    int32_t out[trajectory::WaypointQueue::MAX_JOINTS] = {};
+    int64_t refillUs = 0;
+    return timed([&] {
+        for (uint32_t i = 0; i < iterations; ++i) {
+            const int64_t now = static_cast<int64_t>(i) * 1000;
+            // Alle 500 ms ein Chunk mit 25 Punkten im 20-ms-Raster, ersetzt den Rest der Queue
+            if (now >= refillUs) {
+                for (size_t p = 0; p < 25; ++p) {
+                    points[p].tUs = now + 20000 * static_cast<int64_t>(p + 1);
+                    for (size_t j = 0; j < JPL; ++j) points[p].centiDeg[j] = 9000 + static_cast<int32_t>((p * 97 + j) % 2000);
+                }
+                if (queue.empty()) queue.begin(now, out);
+                queue.append(points, 25, true, now);
+                refillUs = now + 500000;
+            }
+            queue.sample(now, out);
+            sink = sink + out[0];
+        }
+    });
+}
+
+int64_t ikInverse(uint32_t iterations) {
+    int32_t foot[3], angles[3];
+    return timed([&] {
+        for (uint32_t i = 0; i < iterations; ++i) {
+            foot[0] = -30000 + static_cast<int32_t>(i % 600) * 100;
+            foot[1] = 20000;
+            foot[2] = -110000 + static_cast<int32_t>(i % 200) * 50;
+            kinematics::inverse(MotionController::legConfig(i % LEGS), foot, angles);
+            sink = sink + angles[1];
+        }
+    });
+}
+
+// ---------- ServoDriver ----------
+
+int64_t servoSetAngle(uint32_t iterations) {
+    static ServoDriver driver;
+    hal::sim::pwmReset();
+    const int64_t ns = timed([&] {
+        for (uint32_t i = 0; i < iterations; ++i) driver.setAngle(60 + static_cast<int>(i % 80), static_cast<int>(i % SERVOS));
+    });
+    hal::sim::pwmReset();
+    return ns;
+}
+
+int64_t servoWriteFrame(uint32_t iterations) {
+    static ServoDriver driver;
+    int32_t frames[2][SERVOS];
+    for (size_t s = 0; s < SERVOS; ++s) {
+        frames[0][s] = 6000 + static_cast<int32_t>(s) * 100;
+        frames[1][s] = 12000 - static_cast<int32_t>(s) * 100;
+    }
+    hal::sim::pwmReset();
+    const int64_t ns = timed([&] {
+        for (uint32_t i = 0; i < iterations; ++i) sink = sink + static_cast<int64_t>(driver.writeFrame(frames[i & 1]));
+    });
+    hal::sim::pwmReset();
+    return ns;
+}
+
+// ---------- Kommando-Pfad (ROS-Callbacks -> CommandRouter -> MotionController) ----------
+
+// Controller ohne laufenden Loop: Übergaben landen im Triple-Buffer / in den Queues
+ServoDriver bench_driver;
+MotionController bench_controller(bench_driver);
+
+int64_t routerJoint(uint32_t iterations) {
+    CommandRouter router(&bench_controller);
+    LegCommand cmd{LEG_COMMAND_VERSION, LEG_COMMAND_JOINTS, 0, 0, {}};
+    uint8_t wire[sizeof(LegCommand)];
+    const int64_t ns = timed([&] {
+        for (uint32_t i = 0; i < iterations; ++i) {
+            ++cmd.sequence;
+            cmd.stampUs = i * 2000;
+            for (size_t s = 0; s < LEG_COMMAND_JOINTS; ++s) cmd.targets[s] = static_cast<int16_t>(9000 + (i % 1000));
+            std::memcpy(wire, &cmd, sizeof(cmd));
+            router.apply(command_log::FrameKind::Joint, wire, sizeof(wire), 1 + i);
+        }
+    });
+    expectAccepted(router.commandStats().accepted, iterations);
+    return ns;
+}
+
+int64_t routerFoot(uint32_t iterations) {
+    CommandRouter router(&bench_controller);
+    FootCommand cmd{FOOT_COMMAND_VERSION, static_cast<uint8_t>((1u << FOOT_COMMAND_LEGS) - 1), 0, 0, {}};
+    uint8_t wire[sizeof(FootCommand)];
+    const int64_t ns = timed([&] {
+        for (uint32_t i = 0; i < iterations; ++i) {
+            ++cmd.sequence;
+            cmd.stampUs = i * 2000;
+            for (size_t leg = 0; leg < FOOT_COMMAND_LEGS; ++leg) {
+                cmd.feet[leg][0] = static_cast<int16_t>(i % 300);
+                cmd.feet[leg][1] = 200;
+                cmd.feet[leg][2] = -1100;
+            }
+            std::memcpy(wire, &cmd, sizeof(cmd));
+            router.apply(command_log::FrameKind::Foot, wire, sizeof(wire), 1 + i);
+        }
+    });
+    expectAccepted(router.footCommandStats().accepted, iterations);
+    return ns;
+}
+
+int64_t routerTrajectory(uint32_t iterations) {
+    CommandRouter router(&bench_controller);
+    TrajectoryPoint points[MotionController::MAX_CHUNK_POINTS];
+    for (size_t p = 0; p < MotionController::MAX_CHUNK_POINTS; ++p) {
+        points[p].offsetUs = static_cast<uint32_t>(p + 1) * 20000;
+        for (size_t j = 0; j < JPL; ++j) points[p].targets[j] = static_cast<int16_t>(9000 + p * 10);
+    }
+    uint8_t wire[TRAJECTORY_CHUNK_MAX_BYTES];
+    TrajectoryChunkHeader header{TRAJECTORY_CHUNK_VERSION, 0, 0, 0, 0, 25, TRAJECTORY_FLAG_REPLACE,
+                                 static_cast<uint8_t>(JPL), 0};
+    const int64_t ns = timed([&] {
+        for (uint32_t i = 0; i < iterations; ++i) {
+            ++header.sequence;
+            header.stampUs = i * 20000;
+            header.leg = static_cast<uint8_t>(i % LEGS);
+            const size_t len = encodeTrajectoryChunk(header, points, wire, sizeof(wire));
+            router.apply(command_log::FrameKind::Trajectory, wire, len, 1 + i);
+        }
+    });
+    expectAccepted(router.trajectoryStats().accepted, iterations);
+    return ns;
+}
+
+int64_t fastLinkFrame(uint32_t iterations) {
+    FastLink link(&bench_controller);
+    LegCommand cmd{LEG_COMMAND_VERSION, LEG_COMMAND_JOINTS, 0, 0, {}};
+    uint8_t wire[FAST_FRAME_WIRE_BYTES];
+    const uint8_t delimiter = 0;
+    link.feed(&delimiter, 1, 1);
+    const int64_t ns = timed([&] {
+        for (uint32_t i = 0; i < iterations; ++i) {
+            ++cmd.sequence;
+            cmd.stampUs = i * 1000;
+            for (size_t s = 0; s < LEG_COMMAND_JOINTS; ++s) cmd.targets[s] = static_cast<int16_t>(9000 + (i % 1000));
+            const size_t n = fast_frame::encode(cmd, wire, sizeof(wire));
+            link.feed(wire, n, 1 + i);
+        }
+    });
+    expectAccepted(link.stats().frames, iterations);
+    return ns;
+}
+
+// ---------- Übergabe zwischen zwei Threads ----------
+
+// Writer publiziert Joint-Frames, ein zweiter Thread liest dauernd (wie Kommando-Task -> Control-Loop)
+int64_t tripleBufferContended(uint32_t iterations) {
+    static TripleBuffer<MotionController::JointFrame> buffer;
+    std::atomic<bool> running{true};
+    std::thread reader([&] {
+        uint32_t last = 0;
+        while (running.load(std::memory_order_relaxed)) {
+            if (buffer.consume()) last = buffer.readBuffer().sequence;
+        }
+        sink = sink + last;
+    });
+    const int64_t ns = timed([&] {
+        for (uint32_t i = 0; i < iterations; ++i) {
+            MotionController::JointFrame& frame = buffer.writeBuffer();
+            frame.sequence = i;
+            frame.arrivalUs = i;
+            for (size_t s = 0; s < SERVOS; ++s) frame.targets[s] = static_cast<int32_t>(i);
+            buffer.publish();
+        }
+    });
+    running.store(false);
+    reader.join();
+    return ns;
+}
+
+// Jeder Frame zählt (Stream / Chunks): Producer und Consumer über die Ring-Queue, Zeit bis alle durch sind
+int64_t ringQueueContended(uint32_t iterations) {
+    struct Frame {
+        int32_t targets[SERVOS];
+        uint32_t senderStampUs;
+        int64_t arrivalUs;
+    };
+    static RingQueue<Frame, 16> queue;
+    std::atomic<bool> start{false};
+    std::thread consumer([&] {
+        while (!start.load()) std::this_thread::yield();
+        Frame f{};
+        uint32_t received = 0;
+        while (received < iterations) {
+            if (queue.pop(f)) ++received;
+            else std::this_thread::yield();
+        }
+        sink = sink + f.senderStampUs;
+    });
+    const int64_t ns = timed([&] {
+        start.store(true);
+        Frame f{};
+        for (uint32_t i = 0; i < iterations; ++i) {
+            f.senderStampUs = i;
+            // Volle Queue: Consumer laufen lassen (auch auf einem einzelnen Core)
+            while (!queue.push(f)) std::this_thread::yield();
+        }
+        consumer.join();
+    });
+    return ns;
+}
+
+const Case CASES[] = {
+    {"trajectory_sample", "S-curve sample of all legs, one control tick", trajectorySample},
+    {"trajectory_plan", "replan of all legs", trajectoryPlan},
+    {"playout_tick", "playout buffer sample (+ push every 5th tick)", playoutTick},
+    {"waypoint_tick", "waypoint queue Hermite sample of one leg", waypointTick},
+    {"ik_inverse", "IK of one leg", ikInverse},
+    {"servo_set_angle", "ServoDriver::setAngle, one channel", servoSetAngle},
+    {"servo_write_frame", "ServoDriver::writeFrame, all channels changed", servoWriteFrame},
+    {"router_joint", "joint frame decode + handoff (ROS callback path)", routerJoint},
+    {"router_foot", "foot frame decode + handoff", routerFoot},
+    {"router_trajectory", "25-point trajectory chunk encode + decode + handoff", routerTrajectory},
+    {"fast_link_frame", "fast path COBS/CRC encode + in-place decode + publish", fastLinkFrame},
+    {"triple_buffer_contended", "JointFrame publish with a concurrent reader", tripleBufferContended},
+    {"ring_queue_contended", "frame through RingQueue<16>, producer + consumer thread", ringQueueContended},
+};
+
+bool parseArgs(int argc, char** argv, Options& opt) {
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--repeat") == 0 && i + 1 < argc) {
+            opt.repeat = static_cast<uint32_t>(std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--tolerance") == 0 && i + 1 < argc) {
+            opt.tolerancePercent = static_cast<uint32_t>(std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--batch-ms") == 0 && i + 1 < argc) {
+            opt.batchMs = static_cast<uint32_t>(std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            opt.filter = argv[++i];
+        } else if (std::strcmp(argv[i], "--baseline") == 0 && i + 1 < argc) {
+            opt.baselinePath = argv[++i];
+        } else if (std::strcmp(argv[i], "--write-baseline") == 0 && i + 1 < argc) {
+            opt.writePath = argv[++i];
+        } else {
+            printf("usage: %s [--repeat N] [--batch-ms N] [--filter TEXT] [--baseline FILE] [--write-baseline FILE]"
+                   " [--tolerance PERCENT]\n", argv[0]);
+            return false;
+        }
+    }
+    return opt.repeat > 0 && opt.batchMs > 0;
+}
+
+struct Limit {
+    double baselineNs;
+    double limitNs;
+};
+
+// Zeilen "name baseline_ns limit_ns", # = Kommentar
+bool readBaseline(const char* path, std::map<std::string, Limit>& out) {
+    FILE* f = std::fopen(path, "r");
+    if (!f) return false;
+    char line[256];
+    while (std::fgets(line, sizeof(line), f)) {
+        if (line[0] == '#') continue;
+        char name[128];
+        Limit l;
+        if (std::sscanf(line, "%127s %lf %lf", name, &l.baselineNs, &l.limitNs) == 3) out[name] = l;
+    }
+    std::fclose(f);
+    return true;
+}
+
+// Iterationen so wählen, dass ein Durchlauf etwa batchMs dauert
+uint32_t calibrate(const Case& c, uint32_t batchMs) {
+    uint32_t iterations = 64;
+    while (iterations < (1u << 26)) {
+        const int64_t ns = c.run(iterations);
+        if (ns >= static_cast<int64_t>(batchMs) * 1000000 / 4) {
+            return static_cast<uint32_t>(std::max<int64_t>(1, static_cast<int64_t>(iterations) * batchMs * 1000000 / ns));
+        }
+        iterations *= 4;
+    }
+    return iterations;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options opt;
+    if (!parseArgs(argc, argv, opt)) return 1;
+
+    std::map<std::string, Limit> baseline;
+    if (opt.baselinePath && !readBaseline(opt.baselinePath, baseline)) {
+        printf("cannot read baseline %s\n", opt.baselinePath);
+        return 1;
+    }
+
+    printf("%zu legs x %zu joints, %u runs per case, median ns/op\n", LEGS, JPL, opt.repeat);
+    printf("%-24s %10s %10s %10s %10s  %s\n", "case", "median", "min", "baseline", "limit", "");
+    std::vector<std::pair<std::string, double>> results;
+    uint32_t failed = 0;
+    for (const Case& c : CASES) {
+        if (opt.filter && !std::strstr(c.name, opt.filter)) continue;
+        const uint32_t iterations = calibrate(c, opt.batchMs);
+        std::vector<double> perOp;
+        for (uint32_t r = 0; r < opt.repeat; ++r) {
+            perOp.push_back(static_cast<double>(c.run(iterations)) / iterations);
+        }
+        std::sort(perOp.begin(), perOp.end());
+        const double median = perOp[perOp.size() / 2];
+        results.push_back({c.name, median});
+
+        const auto it = baseline.find(c.name);
+        if (it == baseline.end()) {
+            printf("%-24s %10.1f %10.1f %10s %10s  %s\n", c.name, median, perOp.front(), "-", "-",
+                   opt.baselinePath ? "new" : "");
+            continue;
+        }
+        const bool slow = median > it->second.limitNs;
+        if (slow) ++failed;
+        printf("%-24s %10.1f %10.1f %10.1f %10.1f  %s\n", c.name, median, perOp.front(), it->second.baselineNs,
+               it->second.limitNs, slow ? "SLOWER" : "ok");
+    }
+
+    if (opt.writePath) {
+        FILE* f = std::fopen(opt.writePath, "w");
+        if (!f) {
+            printf("cannot write %s\n", opt.writePath);
+            return 1;
+        }
+        std::fprintf(f, "# leg_module_bench baseline: case median_ns limit_ns (median + %u %%)\n", opt.tolerancePercent);
+        for (const auto& r : results) {
+            std::fprintf(f, "%s %.1f %.1f\n", r.first.c_str(), r.second, r.second * (100 + opt.tolerancePercent) / 100.0);
+        }
+        std::fclose(f);
+        printf("baseline written to %s\n", opt.writePath);
+    }
+    if (rejected_runs > 0) {
+        printf("%u runs measured rejected frames, fix the case before comparing\n", rejected_runs);
+        return 1;
+    }
+    if (failed > 0) {
+        printf("%u of %zu cases slower than their baseline limit\n", failed, results.size());
+        return 1;
+    }
+    return 0;
+}
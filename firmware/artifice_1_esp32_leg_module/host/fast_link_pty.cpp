@@ -0,0 +1,218 @@
+#include <poll.h>
+#include <pty.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "../fast_frame.hpp"
+#include "../fast_link.hpp"
+#include "../hal.hpp"
+#include "../logger.hpp"
+#include "../motion_controller.hpp"
+#include "../scheduler.hpp"
+#include "../servo_driver.hpp"
+#include "../task_layout.hpp"
+#include "summary.hpp"
+
+// Fast-Path über ein Pseudo-Terminal: der Host-Encoder schreibt COBS-Frames auf die Master-Seite, ein Leser
+// (statt des ESP32-UART-Tasks) gibt die Bytes von der Slave-Seite an denselben FastLink-Decoder wie auf dem
+// Modul. Optional kaputte CRCs, ausgelassene Sequenzen und zerstückelte Writes; am Ende werden die Zähler des
+// Moduls gegen das Gesendete geprüft (Exit-Code 1 bei Abweichung) und die Parse -> Latch-Latenz ausgegeben.
+
+namespace {
+
+struct Options {
+    uint32_t rateHz = 500;
+    uint32_t durationMs = 2000;
+    uint32_t loopHz = 1000;
+    uint32_t corruptEvery = 0;   // jeder N-te Frame mit falscher CRC
+    uint32_t dropEvery = 0;      // jeder N-te Frame nicht gesendet (Sequenzlücke)
+    uint32_t splitBytes = 0;     // Frames in Stücken dieser Größe schreiben, 0 = am Stück
+    uint32_t baud = 921600;      // nur für die ausgegebene Drahtzeit
+};
+
+bool parseArgs(int argc, char** argv, Options& opt) {
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--rate-hz") == 0 && i + 1 < argc) {
+            opt.rateHz = static_cast<uint32_t>(std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--duration-ms") == 0 && i + 1 < argc) {
+            opt.durationMs = static_cast<uint32_t>(std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--loop-hz") == 0 && i + 1 < argc) {
+            opt.loopHz = static_cast<uint32_t>(std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--corrupt-every") == 0 && i + 1 < argc) {
+            opt.corruptEvery = static_cast<uint32_t>(std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--drop-every") == 0 && i + 1 < argc) {
+            opt.dropEvery = static_cast<uint32_t>(std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--split") == 0 && i + 1 < argc) {
+            opt.splitBytes = static_cast<uint32_t>(std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--baud") == 0 && i + 1 < argc) {
+            opt.baud = static_cast<uint32_t>(std::atoi(argv[++i]));
+        } else {
+            printf("usage: %s [--rate-hz N] [--duration-ms N] [--loop-hz N] [--corrupt-every N] [--drop-every N]"
+                   " [--split BYTES] [--baud N]\n", argv[0]);
+            return false;
+        }
+    }
+    return opt.rateHz > 0 && opt.durationMs > 0 && opt.baud > 0;
+}
+
+void loggerSlot(void*) {
+    logger::service();
+}
+
+void serviceTask(void* arg) {
+    static_cast<Scheduler*>(arg)->run();
+}
+
+// Steht auf dem Modul im UART-Task: Bytes lesen, sofort an den Decoder
+void readerThread(int fd, FastLink* link, std::atomic<bool>* running) {
+    uint8_t chunk[32];
+    while (running->load()) {
+        pollfd p{fd, POLLIN, 0};
+        if (poll(&p, 1, 20) <= 0) continue;
+        const ssize_t n = read(fd, chunk, sizeof(chunk));
+        if (n > 0) link->feed(chunk, static_cast<size_t>(n), hal::nowUs());
+    }
+}
+
+bool writeAll(int fd, const uint8_t* data, size_t len, size_t piece) {
+    if (piece == 0) piece = len;
+    for (size_t off = 0; off < len;) {
+        const ssize_t n = write(fd, data + off, std::min(piece, len - off));
+        if (n <= 0) return false;
+        off += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+int64_t percentile(std::vector<int64_t> values, double p) {
+    if (values.empty()) return 0;
+    std::sort(values.begin(), values.end());
+    return values[static_cast<size_t>(p * (values.size() - 1))];
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options opt;
+    if (!parseArgs(argc, argv, opt)) return 1;
+
+    int master = -1;
+    int slave = -1;
+    if (openpty(&master, &slave, nullptr, nullptr, nullptr) != 0) {
+        printf("openpty failed: %s\n", std::strerror(errno));
+        return 1;
+    }
+    // Roh wie eine UART: keine Zeilenpuffer, kein Echo, 0x00 und 0x0A bleiben unverändert
+    termios tio;
+    tcgetattr(slave, &tio);
+    cfmakeraw(&tio);
+    tcsetattr(slave, TCSANOW, &tio);
+
+    ServoDriver driver;
+    driver.initializePWM();
+    MotionController controller(driver);
+    controller.setLoopRateHz(opt.loopHz);
+    controller.initialize();
+    static Scheduler scheduler;
+    scheduler.addSlot("service", task_layout::SERVICE_SLOT_PERIOD_US, task_layout::SERVICE_SLOT_BUDGET_US,
+                      loggerSlot, nullptr);
+    task_layout::start(task_layout::SERVICE, serviceTask, &scheduler);
+
+    FastLink link(&controller);
+    std::atomic<bool> running{true};
+    std::thread reader(readerThread, slave, &link, &running);
+
+    // Leitungsrauschen vor dem ersten Delimiter: wird bis zur Synchronisation verworfen, zählt nicht als Fehler
+    const uint8_t noise[] = {0x13, 0x37, 0x42};
+    writeAll(master, noise, sizeof(noise), 0);
+    const uint8_t delimiter = 0;
+    writeAll(master, &delimiter, 1, 0);
+
+    const uint32_t wireUs = static_cast<uint32_t>(
+        (static_cast<uint64_t>(FAST_FRAME_WIRE_BYTES) * 10 * 1000000) / opt.baud);
+    printf("fast link over pty: %zu byte frames (%u us at %u baud), %u Hz for %u ms, loop %u Hz\n",
+           FAST_FRAME_WIRE_BYTES, wireUs, opt.baud, opt.rateHz, opt.durationMs, opt.loopHz);
+
+    // Sinus 1 Hz, +-30 deg um die Startstellung; Latenz aus jedem neuen Wert der Modul-Statistik
+    uint8_t out[FAST_FRAME_WIRE_BYTES];
+    uint32_t sent = 0, corrupted = 0, skipped = 0, frames = 0;
+    uint32_t lost = 0, expectedDropped = 0;   // Lücken zählen erst mit dem nächsten guten Frame
+    uint16_t sequence = 0;
+    std::vector<int64_t> latency;
+    uint32_t seenWindows = 0, seenCount = 0;
+    const int64_t period = 1000000 / opt.rateHz;
+    const int64_t start = hal::nowUs();
+    int64_t nextSend = start;
+    while (hal::nowUs() - start < static_cast<int64_t>(opt.durationMs) * 1000) {
+        const int64_t now = hal::nowUs();
+        if (now >= nextSend) {
+            nextSend += period;
+            ++frames;
+            LegCommand cmd{};
+            cmd.version = LEG_COMMAND_VERSION;
+            cmd.jointCount = LEG_COMMAND_JOINTS;
+            cmd.sequence = ++sequence;
+            cmd.stampUs = static_cast<uint32_t>(now);
+            const double t = static_cast<double>(now - start) / 1e6;
+            for (size_t i = 0; i < LEG_COMMAND_JOINTS; ++i) {
+                cmd.targets[i] = static_cast<int16_t>(10000 + 3000 * std::sin(2.0 * M_PI * t + i));
+            }
+            if (opt.dropEvery && frames % opt.dropEvery == 0) {
+                ++skipped;
+                ++lost;
+                continue;
+            }
+            size_t n;
+            if (opt.corruptEvery && frames % opt.corruptEvery == 0) {
+                FastJointFrame bad{cmd, static_cast<uint16_t>(fast_frame::crc16(&cmd, sizeof(cmd)) ^ 0x0100)};
+                n = fast_frame::cobsEncode(reinterpret_cast<const uint8_t*>(&bad), sizeof(bad), out, sizeof(out));
+                ++corrupted;
+                ++lost;
+            } else {
+                n = fast_frame::encode(cmd, out, sizeof(out));
+                expectedDropped += lost;
+                lost = 0;
+            }
+            if (writeAll(master, out, n, opt.splitBytes)) ++sent;
+            continue;
+        }
+        const CommandLatency l = controller.fastLatency();
+        if (l.windows != seenWindows || l.count != seenCount) {
+            latency.push_back(l.lastUs);
+            seenWindows = l.windows;
+            seenCount = l.count;
+        }
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+    hal::delayMs(50);
+    running.store(false);
+    reader.join();
+
+    FastLink::Stats s = link.stats();
+    printf("sent %u frames (%u with bad crc), skipped %u sequence numbers\n", sent, corrupted, skipped);
+    printf("module: frames %u, dropped %u, stale %u, crc errors %u, framing errors %u, bytes %u\n",
+           s.frames, s.dropped, s.stale, s.crcErrors, s.framingErrors, s.bytes);
+    printSummary("parse -> latch", summarize(latency));
+    printf("%-24s p50=%lld p99=%lld [us]\n", "", (long long)percentile(latency, 0.5),
+           (long long)percentile(latency, 0.99));
+
+    // Jede kaputte CRC ist auch eine Lücke in der Sequenz der angenommenen Frames
+    const bool ok = s.frames == sent - corrupted && s.crcErrors == corrupted && s.framingErrors == 0 &&
+                    s.stale == 0 && s.dropped == expectedDropped;
+    printf("%s\n", ok ? "counters match" : "COUNTER MISMATCH");
+    close(master);
+    close(slave);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,350 @@
+#ifndef ESP_PLATFORM
+#include "../hal.hpp"
+#include "sim_pwm.hpp"
+#include <atomic>
+#include <climits>
+#include <malloc.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#include <mutex>
+
+namespace hal {
+
+namespace {
+
+struct SimChannel {
+    int gpio = -1;
+    uint32_t pending = 0; // pwmSetDuty, noch nicht gelatcht
+    uint32_t active = 0;  // pwmUpdateDuty
+};
+
+std::mutex pwm_mutex;
+SimChannel channels[sim::MAX_PWM_CHANNELS];
+std::vector<sim::PwmWrite> writes;
+size_t dropped = 0;
+uint32_t pwm_freq_hz = 0;
+int64_t pwm_epoch_us = 0;
+
+// Wie LEDC: ein gelatchter Duty wird erst mit dem nächsten Periodenbeginn aktiv
+int64_t nextPeriodStart(int64_t t) {
+    if (pwm_freq_hz == 0) return t;
+    const int64_t period = 1000000 / pwm_freq_hz;
+    return pwm_epoch_us + ((t - pwm_epoch_us) / period + 1) * period;
+}
+
+void recordLatch(uint32_t channel, int64_t t) {
+    SimChannel& ch = channels[channel];
+    ch.active = ch.pending;
+    if (writes.size() < sim::MAX_RECORDED_WRITES) {
+        writes.push_back({t, nextPeriodStart(t), channel, ch.active});
+    } else {
+        ++dropped;
+    }
+}
+
+struct PeriodicSlot {
+    bool used = false;
+    int64_t periodNs = 0;
+    timespec next{};
+    bool event = false; // periodicNotify seit dem letzten Wakeup
+    bool wakeArmed = false; // periodicWakeAt, einmalig bei wakeAt
+    timespec wakeAt{};
+    std::atomic<bool> condReady{false}; // cond wird nie zerstört, periodicNotify darf mit periodicStop kollidieren
+    pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+    pthread_cond_t cond{};
+};
+
+std::mutex periodic_mutex;
+PeriodicSlot periodic_slots[MAX_PERIODIC_TIMERS];
+
+void addNs(timespec& ts, int64_t ns) {
+    int64_t total = ts.tv_nsec + ns;
+    ts.tv_sec += total / 1000000000LL;
+    ts.tv_nsec = static_cast<long>(total % 1000000000LL);
+}
+
+bool before(const timespec& a, const timespec& b) {
+    return a.tv_sec < b.tv_sec || (a.tv_sec == b.tv_sec && a.tv_nsec < b.tv_nsec);
+}
+
+std::mutex task_pool_mutex;
+uint32_t task_stack_used = 0;
+int task_count = 0;
+
+struct TaskStart {
+    TaskFunction fn;
+    void* arg;
+};
+
+const cpu_set_t& hostCpus() {
+    static cpu_set_t cpus = [] {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        sched_getaffinity(0, sizeof(set), &set);
+        return set;
+    }();
+    return cpus;
+}
+
+void* taskTrampoline(void* p) {
+    TaskStart start = *static_cast<TaskStart*>(p);
+    delete static_cast<TaskStart*>(p);
+    start.fn(start.arg);
+    return nullptr;
+}
+
+} // namespace
+
+void pwmInitTimer(uint32_t freq_hz, uint32_t /*resolution_bits*/) {
+    int64_t t = nowUs();
+    std::lock_guard<std::mutex> lock(pwm_mutex);
+    pwm_freq_hz = freq_hz;
+    pwm_epoch_us = t;
+}
+
+bool pwmInitChannel(uint32_t channel, int gpio) {
+    if (channel >= sim::MAX_PWM_CHANNELS) return false;
+    std::lock_guard<std::mutex> lock(pwm_mutex);
+    channels[channel].gpio = gpio;
+    channels[channel].pending = 0;
+    channels[channel].active = 0;
+    return true;
+}
+
+void pwmSetDuty(uint32_t channel, uint32_t duty) {
+    if (channel >= sim::MAX_PWM_CHANNELS) return;
+    std::lock_guard<std::mutex> lock(pwm_mutex);
+    channels[channel].pending = duty;
+}
+
+void pwmUpdateDuty(uint32_t channel) {
+    if (channel >= sim::MAX_PWM_CHANNELS) return;
+    int64_t t = nowUs();
+    std::lock_guard<std::mutex> lock(pwm_mutex);
+    recordLatch(channel, t);
+}
+
+void pwmLatch(uint32_t channelMask) {
+    int64_t t = nowUs();
+    std::lock_guard<std::mutex> lock(pwm_mutex);
+    for (uint32_t ch = 0; channelMask != 0 && ch < sim::MAX_PWM_CHANNELS; ++ch, channelMask >>= 1) {
+        if (channelMask & 1u) recordLatch(ch, t);
+    }
+}
+
+int64_t nowUs() {
+    timespec ts{};
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000000LL + ts.tv_nsec / 1000;
+}
+
+void delayMs(uint32_t ms) {
+    timespec ts{};
+    ts.tv_sec = ms / 1000;
+    ts.tv_nsec = static_cast<long>(ms % 1000) * 1000000L;
+    while (nanosleep(&ts, &ts) != 0) {
+        // durch Signal unterbrochen -> Rest weiterschlafen
+    }
+}
+
+uint32_t cycleCount() {
+    // Host: Nanosekunden statt Takte
+    timespec ts{};
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint32_t>(static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + ts.tv_nsec);
+}
+
+uint32_t cyclesPerUs() {
+    return 1000;
+}
+
+int currentCore() {
+    const int cpu = sched_getcpu();
+    return cpu < 0 ? 0 : cpu;
+}
+
+int periodicStart(uint32_t periodUs) {
+    std::lock_guard<std::mutex> lock(periodic_mutex);
+    for (int i = 0; i < MAX_PERIODIC_TIMERS; ++i) {
+        PeriodicSlot& slot = periodic_slots[i];
+        if (slot.used) continue;
+        // Condition Variable auf CLOCK_MONOTONIC, damit die absolute Deadline nicht von der Uhrzeit abhängt
+        if (!slot.condReady) {
+            pthread_condattr_t attr;
+            pthread_condattr_init(&attr);
+            pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+            pthread_cond_init(&slot.cond, &attr);
+            pthread_condattr_destroy(&attr);
+            slot.condReady = true;
+        }
+
+        pthread_mutex_lock(&slot.mutex);
+        slot.used = true;
+        slot.event = false;
+        slot.wakeArmed = false;
+        slot.periodNs = static_cast<int64_t>(periodUs) * 1000;
+        clock_gettime(CLOCK_MONOTONIC, &slot.next);
+        addNs(slot.next, slot.periodNs);
+        pthread_mutex_unlock(&slot.mutex);
+        return i;
+    }
+    return -1;
+}
+
+uint32_t periodicWait(int handle) {
+    if (handle < 0 || handle >= MAX_PERIODIC_TIMERS || !periodic_slots[handle].used) return 0;
+    PeriodicSlot& slot = periodic_slots[handle];
+
+    pthread_mutex_lock(&slot.mutex);
+    timespec now{};
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    // Frühere der beiden Deadlines: nächste Periode oder einmaliger Wakeup
+    while (!slot.event && before(now, slot.next) && !(slot.wakeArmed && !before(now, slot.wakeAt))) {
+        const timespec& deadline = slot.wakeArmed && before(slot.wakeAt, slot.next) ? slot.wakeAt : slot.next;
+        pthread_cond_timedwait(&slot.cond, &slot.mutex, &deadline);
+        clock_gettime(CLOCK_MONOTONIC, &now);
+    }
+
+    uint32_t bits = 0;
+    if (slot.event) {
+        bits |= WAKE_EVENT;
+        slot.event = false;
+    }
+    if (slot.wakeArmed && !before(now, slot.wakeAt)) {
+        bits |= WAKE_AT;
+        slot.wakeArmed = false;
+    }
+    if (!before(now, slot.next)) {
+        bits |= WAKE_PERIOD;
+        // Nächste Deadline absolut weiterzählen, verpasste Perioden überspringen (wie esp_timer)
+        addNs(slot.next, slot.periodNs);
+        while (before(slot.next, now)) addNs(slot.next, slot.periodNs);
+    }
+    pthread_mutex_unlock(&slot.mutex);
+    return bits;
+}
+
+void periodicNotify(int handle) {
+    if (handle < 0 || handle >= MAX_PERIODIC_TIMERS || !periodic_slots[handle].condReady) return;
+    PeriodicSlot& slot = periodic_slots[handle];
+    pthread_mutex_lock(&slot.mutex);
+    if (slot.used) {
+        slot.event = true;
+        pthread_cond_signal(&slot.cond);
+    }
+    pthread_mutex_unlock(&slot.mutex);
+}
+
+void periodicWakeAt(int handle, int64_t atUs) {
+    if (handle < 0 || handle >= MAX_PERIODIC_TIMERS || !periodic_slots[handle].used) return;
+    PeriodicSlot& slot = periodic_slots[handle];
+    // nowUs() zählt ebenfalls auf CLOCK_MONOTONIC, daher direkt als Deadline
+    timespec at{};
+    at.tv_sec = static_cast<time_t>(atUs / 1000000);
+    at.tv_nsec = static_cast<long>((atUs % 1000000) * 1000);
+    pthread_mutex_lock(&slot.mutex);
+    slot.wakeAt = at;
+    slot.wakeArmed = true;
+    pthread_cond_signal(&slot.cond);
+    pthread_mutex_unlock(&slot.mutex);
+}
+
+void periodicSetPeriod(int handle, uint32_t periodUs) {
+    if (handle < 0 || handle >= MAX_PERIODIC_TIMERS || !periodic_slots[handle].used) return;
+    PeriodicSlot& slot = periodic_slots[handle];
+    pthread_mutex_lock(&slot.mutex);
+    slot.periodNs = static_cast<int64_t>(periodUs) * 1000;
+    clock_gettime(CLOCK_MONOTONIC, &slot.next);
+    addNs(slot.next, slot.periodNs);
+    pthread_mutex_unlock(&slot.mutex);
+}
+
+void periodicStop(int handle) {
+    if (handle < 0 || handle >= MAX_PERIODIC_TIMERS) return;
+    std::lock_guard<std::mutex> lock(periodic_mutex);
+    PeriodicSlot& slot = periodic_slots[handle];
+    pthread_mutex_lock(&slot.mutex);
+    slot.used = false;
+    pthread_mutex_unlock(&slot.mutex);
+}
+
+bool createTask(TaskFunction fn, const char* /*name*/, uint32_t stackBytes, void* arg, int /*priority*/, int core) {
+    // Gleiche Budgetierung wie der statische Stack-Pool auf dem ESP32, damit Überläufe schon hier auffallen
+    {
+        std::lock_guard<std::mutex> lock(task_pool_mutex);
+        const uint32_t aligned = (stackBytes + 15u) & ~15u;
+        if (task_count >= MAX_TASKS || aligned > TASK_STACK_POOL_BYTES - task_stack_used) return false;
+        task_stack_used += aligned;
+        ++task_count;
+    }
+
+    // Prioritäten werden auf dem Host ignoriert (keine RT-Rechte in CI)
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    size_t stack = stackBytes < PTHREAD_STACK_MIN ? PTHREAD_STACK_MIN : stackBytes;
+    pthread_attr_setstacksize(&attr, stack);
+
+    // Core-Pinning nur, wenn der Host den Core hat (CI-Container oft mit 1 CPU)
+    if (core >= 0 && core < CPU_SETSIZE && CPU_ISSET(core, &hostCpus())) {
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        CPU_SET(core, &cpus);
+        pthread_attr_setaffinity_np(&attr, sizeof(cpus), &cpus);
+    }
+
+    pthread_t thread;
+    TaskStart* start = new TaskStart{fn, arg};
+    bool ok = pthread_create(&thread, &attr, taskTrampoline, start) == 0;
+    if (!ok) delete start;
+    pthread_attr_destroy(&attr);
+    return ok;
+}
+
+void deleteCurrentTask() {
+    pthread_exit(nullptr);
+}
+
+bool taskStackFreeMin(const char* /*name*/, uint32_t& /*bytes*/) {
+    // pthread-Stacks sind größer als auf dem ESP32 und werden nicht vermessen
+    return false;
+}
+
+size_t heapUsedBytes() {
+    // glibc: belegte Bytes im malloc-Heap (Host-Stacks sind mmap und zählen nicht)
+    return mallinfo2().uordblks;
+}
+
+namespace sim {
+
+std::vector<PwmWrite> pwmWrites() {
+    std::lock_guard<std::mutex> lock(pwm_mutex);
+    return writes;
+}
+
+size_t pwmDroppedWrites() {
+    std::lock_guard<std::mutex> lock(pwm_mutex);
+    return dropped;
+}
+
+uint32_t pwmActiveDuty(uint32_t channel) {
+    if (channel >= MAX_PWM_CHANNELS) return 0;
+    std::lock_guard<std::mutex> lock(pwm_mutex);
+    return channels[channel].active;
+}
+
+uint32_t pwmFrequency() {
+    std::lock_guard<std::mutex> lock(pwm_mutex);
+    return pwm_freq_hz;
+}
+
+void pwmReset() {
+    std::lock_guard<std::mutex> lock(pwm_mutex);
+    writes.clear();
+    dropped = 0;
+}
+
+} // namespace sim
+} // namespace hal
+#endif // ESP_PLATFORM
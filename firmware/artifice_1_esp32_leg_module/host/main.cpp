@@ -0,0 +1,572 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "../clock_sync.hpp"
+#include "../command_router.hpp"
+#include "../hal.hpp"
+#include "../logger.hpp"
+#include "../motion_controller.hpp"
+#include "../scheduler.hpp"
+#include "../servo_driver.hpp"
+#include "../task_layout.hpp"
+#include "../trace.hpp"
+#include "servo_model.hpp"
+#include "sim_pwm.hpp"
+#include "summary.hpp"
+
+// Host-Entry: gleicher Controller wie appMain, aber ohne micro-ROS.
+// Kommandos kommen aus einem festen Testmuster, ausgewertet wird der simulierte LEDC.
+
+namespace {
+
+struct Options {
+    uint32_t durationMs = 5000;
+    uint32_t commandPeriodMs = 1000;
+    int lowAngle = 60;
+    int highAngle = 140;
+    trajectory::ProfileType profile = trajectory::ProfileType::SCurve;
+    uint32_t rateHz = MotionController::DEFAULT_LOOP_RATE_HZ;
+    uint32_t rosLoadHz = 0; // 0 = keine simulierte ROS-Last
+    int footDxMm = 0;       // > 0: kartesisches Testmuster, Fuß pendelt um +-dx (IK auf dem Modul)
+    uint32_t gaitMilliHz = 0; // > 0: Gait auf dem Modul statt Testmuster
+    const char* recordPath = nullptr; // Kommando-Mitschnitt für leg_module_replay
+    uint32_t streamHz = 0;    // > 0: Sinus-Stream statt Sprüngen, Frames mit Sender-Zeit
+    uint32_t jitterMs = 0;    // zufällige Zustellverzögerung 0..N ms je Stream-Frame (Reihenfolge bleibt)
+    bool playout = false;     // Playout-Puffer im MotionController
+    uint32_t chunkHz = 0;     // > 0: Sinus als Trajektorien-Chunks (Waypoints mit Modul-Zeit) je Bein
+    const char* tracePath = nullptr; // Trace-Abbild am Ende (für leg_module_trace)
+    uint32_t timedHz = 0;     // > 0: Sinus als zeitgesteuerte Frames (Ausführung in Agent-Zeit, Uhrabgleich simuliert)
+    uint32_t leadMs = 30;     // Vorlauf der Ausführungszeit vor dem Senden
+    int32_t agentDriftPpm = 50; // Gangunterschied der simulierten Agent-Uhr
+};
+
+// Simulierte Agent-Uhr: Epoch-Zeit mit Offset und Drift gegenüber der Modul-Uhr
+struct AgentClock {
+    int64_t epochUs;
+    int32_t driftPpm;
+    int64_t originUs;
+
+    int64_t at(int64_t moduleUs) const {
+        const int64_t t = moduleUs - originUs;
+        return epochUs + t + t * driftPpm / 1000000;
+    }
+};
+
+// Ein Austausch wie rmw_uros_sync_session: Round Trip mit ungleichen Wegen, der Offset-Fehler ist die halbe
+// Asymmetrie (NTP-Mittelpunkt)
+void syncSample(ClockSync& sync, const AgentClock& agent, uint32_t& rng) {
+    rng = rng * 1664525u + 1013904223u;
+    const int64_t up = 200 + (rng >> 8) % 1500;
+    rng = rng * 1664525u + 1013904223u;
+    const int64_t down = 200 + (rng >> 8) % 1500;
+    const int64_t now = hal::nowUs();
+    sync.addSample(now, agent.at(now) + (down - up) / 2, static_cast<uint32_t>(up + down));
+}
+
+// Fußpunkte des kartesischen Testmusters (Mikrometer, Beinkoordinaten)
+const int32_t FOOT_Y_UM = 20000;
+const int32_t FOOT_Z_UM = -110000;
+
+// Abstand des Fußpunkts von der Geraden des Testmusters (parallel zu x bei FOOT_Y_UM / FOOT_Z_UM)
+double lineDeviationUm(const int32_t* foot) {
+    const double dy = foot[1] - FOOT_Y_UM;
+    const double dz = foot[2] - FOOT_Z_UM;
+    return std::sqrt(dy * dy + dz * dz);
+}
+
+// Simulierte ROS-Seite als Slot des Service-Schedulers: CPU-Last wie Serialisierung/Transport, dazu die
+// Loop-Statistik lesen (aus jedem Task erlaubt). Keine Ziele schreiben: Kommandos kommen nur vom Main-Thread
+// über den CommandSender (ein Schreiber), Joint States liest nur der Main-Thread (ein Leser).
+// Zum Vergleich des Control-Jitters mit/ohne Last.
+struct RosLoad {
+    MotionController* controller;
+    uint32_t rateHz;
+    uint32_t cycles; // zuletzt gelesenes Loop-Fenster, nur damit der Lesezugriff nicht wegfällt
+};
+
+void rosLoadSlot(void* arg) {
+    RosLoad* load = static_cast<RosLoad*>(arg);
+    // ca. ein Viertel der Periode "Transport"
+    volatile uint32_t sink = 0;
+    const int64_t busyUntil = hal::nowUs() + 1000000 / load->rateHz / 4;
+    while (hal::nowUs() < busyUntil) sink = sink + 1;
+
+    load->cycles = load->controller->loopTiming().cycles;
+}
+
+// Testmuster als Wire-Frames durch denselben Decode-Pfad wie auf dem Modul (CommandRouter)
+struct CommandSender {
+    CommandRouter* router;
+    uint16_t jointSequence = 0;
+    uint16_t footSequence = 0;
+    uint16_t gaitSequence = 0;
+    uint16_t trajectorySequence = 0;
+
+    void joints(const int32_t* centiDeg, uint32_t stampUs = stamp()) {
+        LegCommand cmd{LEG_COMMAND_VERSION, LEG_COMMAND_JOINTS, ++jointSequence, stampUs, {}};
+        for (size_t i = 0; i < LEG_COMMAND_JOINTS; ++i) cmd.targets[i] = static_cast<int16_t>(centiDeg[i]);
+        send(command_log::FrameKind::Joint, cmd);
+    }
+
+    void feet(uint8_t legMask, const int32_t* footUm) {
+        FootCommand cmd{FOOT_COMMAND_VERSION, legMask, ++footSequence, stamp(), {}};
+        for (size_t leg = 0; leg < FOOT_COMMAND_LEGS; ++leg) {
+            for (size_t a = 0; a < 3; ++a) cmd.feet[leg][a] = static_cast<int16_t>(footUm[leg * 3 + a] / 100);
+        }
+        send(command_log::FrameKind::Foot, cmd);
+    }
+
+    void gait(const gait::GaitParams& p, bool run) {
+        GaitCommand cmd{GAIT_COMMAND_VERSION, static_cast<uint8_t>(run ? GAIT_FLAG_RUN : 0), ++gaitSequence, stamp(),
+                        static_cast<int16_t>(p.strideUm / 100), static_cast<uint16_t>(p.stepHeightUm / 100),
+                        static_cast<uint16_t>(p.frequencyMilliHz), p.phaseOffset, p.dutyFactor, {}};
+        for (size_t a = 0; a < 3; ++a) cmd.neutral[a] = static_cast<int16_t>(p.neutralUm[a] / 100);
+        send(command_log::FrameKind::Gait, cmd);
+    }
+
+    void trajectory(uint8_t leg, uint32_t startUs, uint8_t flags, const TrajectoryPoint* points, uint8_t count) {
+        TrajectoryChunkHeader header{TRAJECTORY_CHUNK_VERSION, leg, ++trajectorySequence, stamp(), startUs, count,
+                                     flags, static_cast<uint8_t>(LegModule::JOINTS_PER_LEG), 0};
+        uint8_t wire[TRAJECTORY_CHUNK_MAX_BYTES];
+        const size_t len = encodeTrajectoryChunk(header, points, wire, sizeof(wire));
+        router->apply(command_log::FrameKind::Trajectory, wire, len, hal::nowUs());
+    }
+
+    void timedJoints(const int32_t* centiDeg, uint32_t executeAtUs, uint32_t stampUs) {
+        TimedLegCommand cmd{TIMED_LEG_COMMAND_VERSION, LEG_COMMAND_JOINTS, ++jointSequence, stampUs, executeAtUs, {}};
+        for (size_t i = 0; i < LEG_COMMAND_JOINTS; ++i) cmd.targets[i] = static_cast<int16_t>(centiDeg[i]);
+        send(command_log::FrameKind::Joint, cmd);
+    }
+
+    static uint32_t stamp() { return static_cast<uint32_t>(hal::nowUs()); }
+
+    template <typename Frame>
+    void send(command_log::FrameKind kind, const Frame& frame) {
+        uint8_t wire[sizeof(Frame)];
+        std::memcpy(wire, &frame, sizeof(Frame));
+        router->apply(kind, wire, sizeof(wire), hal::nowUs());
+    }
+};
+
+void loggerSlot(void*) {
+    logger::service();
+}
+
+void serviceTask(void* arg) {
+    static_cast<Scheduler*>(arg)->run();
+}
+
+bool parseArgs(int argc, char** argv, Options& opt) {
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--duration-ms") == 0 && i + 1 < argc) {
+            opt.durationMs = static_cast<uint32_t>(std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--command-period-ms") == 0 && i + 1 < argc) {
+            opt.commandPeriodMs = static_cast<uint32_t>(std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--profile") == 0 && i + 1 < argc) {
+            const char* name = argv[++i];
+            if (std::strcmp(name, "trapezoidal") == 0) opt.profile = trajectory::ProfileType::Trapezoidal;
+            else if (std::strcmp(name, "scurve") == 0) opt.profile = trajectory::ProfileType::SCurve;
+            else return false;
+        } else if (std::strcmp(argv[i], "--rate-hz") == 0 && i + 1 < argc) {
+            opt.rateHz = static_cast<uint32_t>(std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--ros-load-hz") == 0 && i + 1 < argc) {
+            opt.rosLoadHz = static_cast<uint32_t>(std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--foot-dx-mm") == 0 && i + 1 < argc) {
+            opt.footDxMm = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--gait-mhz") == 0 && i + 1 < argc) {
+            opt.gaitMilliHz = static_cast<uint32_t>(std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--stream-hz") == 0 && i + 1 < argc) {
+            opt.streamHz = static_cast<uint32_t>(std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--jitter-ms") == 0 && i + 1 < argc) {
+            opt.jitterMs = static_cast<uint32_t>(std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--chunk-hz") == 0 && i + 1 < argc) {
+            opt.chunkHz = static_cast<uint32_t>(std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--timed-hz") == 0 && i + 1 < argc) {
+            opt.timedHz = static_cast<uint32_t>(std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--lead-ms") == 0 && i + 1 < argc) {
+            opt.leadMs = static_cast<uint32_t>(std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--agent-drift-ppm") == 0 && i + 1 < argc) {
+            opt.agentDriftPpm = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--playout") == 0) {
+            opt.playout = true;
+        } else if (std::strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            opt.recordPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+            opt.tracePath = argv[++i];
+        } else if (std::strcmp(argv[i], "--low") == 0 && i + 1 < argc) {
+            opt.lowAngle = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--high") == 0 && i + 1 < argc) {
+            opt.highAngle = std::atoi(argv[++i]);
+        } else {
+            printf("usage: %s [--duration-ms N] [--command-period-ms N] [--profile trapezoidal|scurve]"
+                   " [--rate-hz N] [--ros-load-hz N] [--foot-dx-mm N] [--gait-mhz N]"
+                   " [--stream-hz N] [--chunk-hz N] [--timed-hz N] [--lead-ms N] [--agent-drift-ppm N]"
+                   " [--jitter-ms N] [--playout] [--record FILE] [--trace FILE]"
+                   " [--low DEG] [--high DEG]\n", argv[0]);
+            return false;
+        }
+    }
+    return opt.commandPeriodMs > 0;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options opt;
+    if (!parseArgs(argc, argv, opt)) return 1;
+
+    ServoDriver driver;
+    driver.initializePWM();
+
+    MotionController controller(driver);
+    controller.setProfileType(opt.profile);
+    controller.setLoopRateHz(opt.rateHz);
+    controller.setPlayoutEnabled(opt.playout);
+    controller.initialize();
+
+    // Service-Task wie auf dem ESP32: optional die ROS-Last, dazu der Logger-Slot
+    RosLoad load{&controller, opt.rosLoadHz, 0};
+    static Scheduler scheduler;
+    if (opt.rosLoadHz > 0) {
+        const uint32_t period = 1000000 / opt.rosLoadHz;
+        scheduler.addSlot("ros_load", period, period / 2, rosLoadSlot, &load);
+    }
+    scheduler.addSlot("service", task_layout::SERVICE_SLOT_PERIOD_US, task_layout::SERVICE_SLOT_BUDGET_US,
+                      loggerSlot, nullptr);
+    task_layout::start(task_layout::SERVICE, serviceTask, &scheduler);
+
+    // Kommandos gehen als Wire-Frames durch den CommandRouter, optional mitgeschnitten
+    CommandRouter router(&controller);
+    std::vector<uint8_t> recordBuffer(opt.recordPath ? 1u << 20 : 0);
+    command_log::Recorder recorder(recordBuffer.data(), recordBuffer.size());
+    if (opt.recordPath) router.setRecorder(&recorder);
+    CommandSender sender{&router};
+    // Agent-Uhr nur im Timed-Modus abgleichen, sonst bleiben zeitgesteuerte Frames unsynchronisiert (wie im Replay)
+    ClockSync clockSync;
+    if (opt.timedHz > 0) router.setClock(&clockSync);
+
+    // Testmuster: alle Gelenke springen zwischen low/high, oder beide Füße pendeln auf einer Geraden
+    std::vector<int64_t> commandTimes;
+    bool high = false;
+    double footDeviationMax = 0.0;
+    size_t footSamples = 0;
+    int32_t gaitMin[3] = {INT32_MAX, INT32_MAX, INT32_MAX};
+    int32_t gaitMax[3] = {INT32_MIN, INT32_MIN, INT32_MIN};
+    const int64_t start = hal::nowUs();
+    if (opt.gaitMilliHz > 0) {
+        // Gait läuft allein auf dem Modul, hier nur die Fußbahn von Bein 0 mitschreiben.
+        // latestJointState hat genau einen Leser: diesen Thread (die ROS-Last liest nur loopTiming)
+        gait::GaitParams params{40000, 20000, opt.gaitMilliHz, 32768, 39322, {0, FOOT_Y_UM, FOOT_Z_UM}};
+        sender.gait(params, true);
+        while (hal::nowUs() - start < static_cast<int64_t>(opt.durationMs) * 1000) {
+            MotionController::JointState js;
+            if (controller.gaitPhase() != 0 && controller.latestJointState(js)) {
+                int32_t foot[3];
+                kinematics::forward(MotionController::legConfig(0), js.positions, foot);
+                for (size_t a = 0; a < 3; ++a) {
+                    gaitMin[a] = std::min(gaitMin[a], foot[a]);
+                    gaitMax[a] = std::max(gaitMax[a], foot[a]);
+                }
+            }
+            hal::delayMs(2);
+        }
+        sender.gait(params, false);
+        hal::delayMs(500);
+    }
+    if (opt.streamHz > 0) {
+        // Sinus 0.5 Hz, +-40 deg um die Mitte, Frames im festen Sender-Takt; Zustellung mit Jitter wie
+        // über WLAN / XRCE (Frames können sich stauen, die Reihenfolge bleibt)
+        const int64_t period = 1000000 / opt.streamHz;
+        const int32_t center = (opt.lowAngle + opt.highAngle) * 50;
+        int64_t lastDelivery = 0;
+        uint32_t rng = 12345;
+        for (int64_t k = 0; k * period < static_cast<int64_t>(opt.durationMs) * 1000; ++k) {
+            const int64_t sendUs = start + k * period;
+            rng = rng * 1664525u + 1013904223u;
+            const int64_t jitter = opt.jitterMs ? static_cast<int64_t>((rng >> 8) % (opt.jitterMs * 1000)) : 0;
+            const int64_t deliverUs = std::max(lastDelivery, sendUs + jitter);
+            lastDelivery = deliverUs;
+            while (hal::nowUs() < deliverUs) hal::delayMs(1);
+            int32_t frame[MotionController::NUM_SERVOS];
+            const double phase = 2.0 * 3.14159265 * 0.5 * (sendUs - start) / 1e6;
+            for (size_t i = 0; i < MotionController::NUM_SERVOS; ++i) {
+                frame[i] = center + static_cast<int32_t>(4000.0 * std::sin(phase));
+            }
+            sender.joints(frame, static_cast<uint32_t>(sendUs));
+        }
+        hal::delayMs(200);
+    }
+    if (opt.chunkHz > 0) {
+        // Gleicher Sinus als Chunks: je Bein 25 Punkte im 20-ms-Raster (500 ms Vorschau), Start 20 ms nach dem
+        // Senden in Modul-Zeit; jeder Chunk ersetzt den Rest des vorigen. Zustellung mit Jitter wie beim Stream.
+        const int64_t period = 1000000 / opt.chunkHz;
+        const int64_t spacing = 20000;
+        const uint8_t points = 25;
+        const int32_t center = (opt.lowAngle + opt.highAngle) * 50;
+        int64_t lastDelivery = 0;
+        uint32_t rng = 12345;
+        for (int64_t k = 0; k * period < static_cast<int64_t>(opt.durationMs) * 1000; ++k) {
+            const int64_t sendUs = start + k * period;
+            rng = rng * 1664525u + 1013904223u;
+            const int64_t jitter = opt.jitterMs ? static_cast<int64_t>((rng >> 8) % (opt.jitterMs * 1000)) : 0;
+            const int64_t deliverUs = std::max(lastDelivery, sendUs + jitter);
+            lastDelivery = deliverUs;
+            while (hal::nowUs() < deliverUs) hal::delayMs(1);
+            // Punkte auf dem Raster ab sendUs + 20 ms, damit sich überlappende Chunks dieselben Stützstellen haben
+            const int64_t first = ((sendUs - start) / spacing + 1) * spacing;
+            TrajectoryPoint chunk[TRAJECTORY_CHUNK_MAX_POINTS];
+            for (uint8_t p = 0; p < points; ++p) {
+                const int64_t t = first + p * spacing;
+                const double phase = 2.0 * 3.14159265 * 0.5 * t / 1e6;
+                chunk[p].offsetUs = static_cast<uint32_t>(p * spacing);
+                for (size_t j = 0; j < LegModule::JOINTS_PER_LEG; ++j) {
+                    chunk[p].targets[j] = static_cast<int16_t>(center + static_cast<int32_t>(4000.0 * std::sin(phase)));
+                }
+            }
+            for (size_t leg = 0; leg < MotionController::NUM_LEGS; ++leg) {
+                sender.trajectory(static_cast<uint8_t>(leg), static_cast<uint32_t>(start + first),
+                                  TRAJECTORY_FLAG_REPLACE, chunk, points);
+            }
+        }
+        hal::delayMs(600);
+    }
+    std::vector<int64_t> arrivalSpread;
+    std::vector<int64_t> syncErrors;
+    AgentClock agent{1760000000000000LL, opt.agentDriftPpm, hal::nowUs()};
+    if (opt.timedHz > 0) {
+        // Gleicher Sinus als zeitgesteuerte Frames: Ausführung lead ms nach dem Senden in Agent-Zeit, Zustellung mit
+        // Jitter. Uhrabgleich wie in RosInterface: erst 4 Samples im 100-ms-Takt, danach jede Sekunde.
+        uint32_t syncRng = 777;
+        for (int n = 0; n < 4; ++n) {
+            syncSample(clockSync, agent, syncRng);
+            hal::delayMs(100);
+        }
+        int64_t nextSync = hal::nowUs() + 1000000;
+        const int64_t timedStart = hal::nowUs();
+        const int64_t period = 1000000 / opt.timedHz;
+        const int64_t lead = static_cast<int64_t>(opt.leadMs) * 1000;
+        const int32_t center = (opt.lowAngle + opt.highAngle) * 50;
+        int64_t lastDelivery = 0;
+        uint32_t rng = 12345;
+        for (int64_t k = 0; k * period < static_cast<int64_t>(opt.durationMs) * 1000; ++k) {
+            const int64_t sendUs = timedStart + k * period;
+            rng = rng * 1664525u + 1013904223u;
+            const int64_t jitter = opt.jitterMs ? static_cast<int64_t>((rng >> 8) % (opt.jitterMs * 1000)) : 0;
+            const int64_t deliverUs = std::max(lastDelivery, sendUs + jitter);
+            lastDelivery = deliverUs;
+            while (hal::nowUs() < deliverUs) {
+                if (hal::nowUs() >= nextSync) {
+                    syncSample(clockSync, agent, syncRng);
+                    nextSync += 1000000;
+                }
+                hal::delayMs(1);
+            }
+            int32_t frame[MotionController::NUM_SERVOS];
+            const double phase = 2.0 * 3.14159265 * 0.5 * (sendUs - timedStart) / 1e6;
+            for (size_t i = 0; i < MotionController::NUM_SERVOS; ++i) {
+                frame[i] = center + static_cast<int32_t>(4000.0 * std::sin(phase));
+            }
+            // Fehler der Schätzung gegen die wahre Modul-Zeit des Ausführungszeitpunkts
+            const int64_t executeAgent = agent.at(sendUs + lead);
+            int64_t estimated;
+            if (clockSync.toModuleUs(executeAgent, estimated)) syncErrors.push_back(estimated - (sendUs + lead));
+            arrivalSpread.push_back(hal::nowUs() - sendUs);
+            sender.timedJoints(frame, static_cast<uint32_t>(executeAgent), static_cast<uint32_t>(sendUs));
+        }
+        hal::delayMs(200);
+    }
+    while (opt.gaitMilliHz == 0 && opt.streamHz == 0 && opt.chunkHz == 0 && opt.timedHz == 0 && hal::nowUs() - start < static_cast<int64_t>(opt.durationMs) * 1000) {
+        high = !high;
+        commandTimes.push_back(hal::nowUs());
+        if (opt.footDxMm > 0) {
+            const int32_t x = (high ? opt.footDxMm : -opt.footDxMm) * 1000;
+            int32_t feet[MotionController::NUM_LEGS * kinematics::LEG_JOINTS];
+            for (size_t leg = 0; leg < MotionController::NUM_LEGS; ++leg) {
+                feet[leg * kinematics::LEG_JOINTS] = x;
+                feet[leg * kinematics::LEG_JOINTS + 1] = FOOT_Y_UM;
+                feet[leg * kinematics::LEG_JOINTS + 2] = FOOT_Z_UM;
+            }
+            sender.feet(LegModule::allLegsMask(), feet);
+
+            // Bahn über die Vorwärtskinematik der kommandierten Winkel prüfen (Main-Thread ist der einzige Leser)
+            const int64_t until = hal::nowUs() + static_cast<int64_t>(opt.commandPeriodMs) * 1000;
+            while (hal::nowUs() < until) {
+                MotionController::JointState js;
+                if (controller.latestJointState(js) && commandTimes.size() > 1) {
+                    int32_t foot[3];
+                    kinematics::forward(MotionController::legConfig(0), js.positions, foot);
+                    footDeviationMax = std::max(footDeviationMax, lineDeviationUm(foot));
+                    ++footSamples;
+                }
+                hal::delayMs(2);
+            }
+            continue;
+        }
+        int32_t frame[MotionController::NUM_SERVOS];
+        for (size_t i = 0; i < MotionController::NUM_SERVOS; ++i) {
+            frame[i] = (high ? opt.highAngle : opt.lowAngle) * 100;
+        }
+        sender.joints(frame);
+        hal::delayMs(opt.commandPeriodMs);
+    }
+
+    logger::drain();
+    if (opt.recordPath) {
+        FILE* f = std::fopen(opt.recordPath, "wb");
+        if (!f || std::fwrite(recorder.data(), 1, recorder.size(), f) != recorder.size()) {
+            printf("failed to write %s\n", opt.recordPath);
+        } else {
+            printf("recorded %u frames (%zu bytes) to %s\n", recorder.recordCount(), recorder.size(), opt.recordPath);
+        }
+        if (f) std::fclose(f);
+    }
+    if (opt.tracePath) {
+        // Gleiches Abbild wie der Upload auf /leg/<id>/trace, Aufzeichnung steht solange
+        trace::setRecording(false);
+        std::vector<uint8_t> image(trace::dumpBytes());
+        trace::copy(0, image.data(), image.size());
+        trace::setRecording(true);
+        FILE* f = std::fopen(opt.tracePath, "wb");
+        if (!TRACE_ENABLED || !f || std::fwrite(image.data(), 1, image.size(), f) != image.size()) {
+            printf("failed to write trace %s (TRACE_ENABLED=%d)\n", opt.tracePath, TRACE_ENABLED);
+        } else {
+            printf("trace image (%zu bytes) written to %s\n", image.size(), opt.tracePath);
+        }
+        if (f) std::fclose(f);
+    }
+    std::vector<hal::sim::PwmWrite> writes = hal::sim::pwmWrites();
+
+    // Kommando-Latenz: erste Duty-Änderung auf Channel 0 nach dem Kommando
+    std::vector<int64_t> latencies;
+    for (int64_t t : commandTimes) {
+        uint32_t before = 0;
+        bool haveBefore = false;
+        for (const auto& w : writes) {
+            if (w.channel != 0) continue;
+            if (w.t_us < t) { before = w.duty; haveBefore = true; continue; }
+            if (haveBefore && w.duty != before) { latencies.push_back(w.t_us - t); break; }
+            before = w.duty;
+            haveBefore = true;
+        }
+    }
+
+    // Einschwingzeit: letzte Duty-Änderung auf Channel 0 vor dem nächsten Kommando
+    std::vector<int64_t> settleTimes;
+    for (size_t c = 0; c < commandTimes.size(); ++c) {
+        const int64_t t = commandTimes[c];
+        const int64_t next = c + 1 < commandTimes.size() ? commandTimes[c + 1] : INT64_MAX;
+        int64_t lastChange = -1;
+        uint32_t prev = 0;
+        bool havePrev = false;
+        for (const auto& w : writes) {
+            if (w.channel != 0 || w.t_us >= next) continue;
+            if (w.t_us >= t && havePrev && w.duty != prev) lastChange = w.t_us;
+            prev = w.duty;
+            havePrev = true;
+        }
+        if (lastChange >= 0) settleTimes.push_back(lastChange - t);
+    }
+
+    // Latch -> Beginn der PWM-Periode, in der der Duty wirkt
+    std::vector<int64_t> actuationDelays;
+    for (const auto& w : writes) actuationDelays.push_back(w.active_us - w.t_us);
+
+    printf("pwm: %u Hz, %zu writes recorded, %zu dropped\n",
+           hal::sim::pwmFrequency(), writes.size(), hal::sim::pwmDroppedWrites());
+    printSummary("command latency", summarize(latencies));
+    printSummary("settle time", summarize(settleTimes));
+    printSummary("latch to active", summarize(actuationDelays));
+
+    ServoDriver::FrameStats fs = driver.frameStats();
+    printf("frames: %u, channel updates: %u, skipped unchanged: %u\n",
+           fs.frames, fs.channelUpdates, fs.channelsSkipped);
+
+    if (opt.footDxMm > 0) {
+        printf("foot path: max deviation from straight line %.0f um (%zu samples), IK clamped %u, unreachable %u\n",
+               footDeviationMax, footSamples, controller.ikClamped(), controller.ikUnreachable());
+    }
+
+    if (opt.gaitMilliHz > 0) {
+        printf("gait foot leg 0: x %.1f..%.1f mm, z %.1f..%.1f mm, IK clamped %u, unreachable %u, running %d\n",
+               gaitMin[0] / 1000.0, gaitMax[0] / 1000.0, gaitMin[2] / 1000.0, gaitMax[2] / 1000.0,
+               controller.ikClamped(), controller.ikUnreachable(), controller.gaitRunning() ? 1 : 0);
+    }
+
+    if (opt.streamHz > 0 || opt.chunkHz > 0) {
+        // Ruckeln: Änderung der Sollgeschwindigkeit von Tick zu Tick auf Channel 0
+        std::vector<int64_t> velocityStep;
+        int64_t lastT = 0;
+        double lastAngle = 0.0;
+        double lastVelocity = 0.0;
+        bool haveVelocity = false;
+        for (const auto& w : writes) {
+            if (w.channel != LegModule::SERVO_CHANNELS[0].channel) continue;
+            const double angle = ServoModel::angleForDuty(w.duty, 0);
+            if (lastT != 0 && w.t_us > lastT) {
+                const double v = (angle - lastAngle) * 1e6 / (w.t_us - lastT);
+                if (haveVelocity) velocityStep.push_back(static_cast<int64_t>(std::fabs(v - lastVelocity)));
+                lastVelocity = v;
+                haveVelocity = true;
+            }
+            lastT = w.t_us;
+            lastAngle = angle;
+        }
+        printSummary("setpoint velocity step", summarize(velocityStep), "cdeg/s");
+    }
+    if (opt.chunkHz > 0) {
+        printf("trajectory chunks %u Hz, jitter 0..%u ms: %u accepted, %u malformed, waypoints lost %u, queued %u\n",
+               opt.chunkHz, opt.jitterMs, router.trajectoryStats().accepted, router.trajectoryStats().malformed,
+               controller.waypointOverflows(), controller.waypointsQueued(0));
+    }
+    if (opt.streamHz > 0) {
+        PlayoutBuffer::Stats p = controller.playoutStats();
+        printf("stream %u Hz, jitter 0..%u ms, playout %s: delay %u us (target %u), jitter estimate %u us, "
+               "late %u, extrapolated %u, held %u\n", opt.streamHz, opt.jitterMs, opt.playout ? "on" : "off",
+               p.delayUs, p.targetDelayUs, p.jitterUs, p.late, p.extrapolated, p.held);
+    }
+
+    if (opt.timedHz > 0) {
+        // Auf Ankunft angewendet streut die Aktuierung wie die Zustellung; zeitgesteuert bleibt Sync-Fehler + Skew
+        ClockSync::Stats cs = clockSync.stats();
+        MotionController::ScheduleStats ss = controller.scheduleStats();
+        CommandLatency skew = controller.actuationSkew();
+        printSummary("arrival after send", summarize(arrivalSpread));
+        printSummary("clock sync error", summarize(syncErrors));
+        printf("timed frames %u Hz, lead %u ms, jitter 0..%u ms: %u scheduled, %u late, %u rejected, %u cancelled, "
+               "%u overflows, %u unsynced\n", opt.timedHz, opt.leadMs, opt.jitterMs, ss.scheduled, ss.late,
+               ss.rejected, ss.cancelled, ss.overflows, router.unsyncedFrames());
+        printf("clock sync: drift %d ppb (agent %d ppm), residual %u us, rtt min %u us, %u samples, %u skipped\n",
+               cs.driftPpb, opt.agentDriftPpm, cs.residualUs, cs.minRttUs, cs.samples, cs.skipped);
+        printf("actuation skew (latch - execute-at, last window, %u frames): min=%u mean=%u max=%u [us]\n",
+               skew.count, skew.minUs, skew.meanUs, skew.maxUs);
+    }
+
+    CommandLatency l = controller.commandLatency();
+    printf("controller command latency (arrival -> latch, %u commands): min=%u mean=%u max=%u [us]\n",
+           l.count, l.minUs, l.meanUs, l.maxUs);
+
+    MotionController::JointState js;
+    if (controller.latestJointState(js)) {
+        printf("joint state tick %u (frame %u): joint 0 at %d cdeg, %d cdeg/s\n",
+               js.tick, js.appliedSequence, js.positions[0], js.velocities[0]);
+    }
+
+    LoopTiming t = controller.loopTiming();
+    printf("tasks: control core %d, transport core %d, ros load %u Hz\n",
+           task_layout::CONTROL.core, task_layout::SERVICE.core, opt.rosLoadHz);
+    for (size_t i = 0; i < scheduler.slotCount(); ++i) {
+        Scheduler::SlotStats s = scheduler.slotStats(i);
+        printf("slot %-10s period=%u budget=%u runs=%u overruns=%u exec max=%u late max=%u [us]\n",
+               s.name, s.periodUs, s.budgetUs, s.runs, s.overruns, s.execMaxUs, s.lateMaxUs);
+    }
+    printf("control loop @ %u Hz (last window, %u cycles): period min=%u mean=%u max=%u, "
+           "jitter p99=%u max=%u, exec mean=%u max=%u, missed=%u [us]\n",
+           controller.loopRateHz(), t.cycles, t.periodMinUs, t.periodMeanUs, t.periodMaxUs,
+           t.jitterP99Us, t.jitterMaxUs, t.execMeanUs, t.execMaxUs, t.missedPeriods);
+    return 0;
+}
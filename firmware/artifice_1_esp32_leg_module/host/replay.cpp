@@ -0,0 +1,260 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "../command_log.hpp"
+#include "../command_router.hpp"
+#include "../hal.hpp"
+#include "../logger.hpp"
+#include "../motion_controller.hpp"
+#include "../scheduler.hpp"
+#include "../servo_driver.hpp"
+#include "../task_layout.hpp"
+#include "servo_model.hpp"
+#include "sim_pwm.hpp"
+#include "summary.hpp"
+
+// Spielt einen Kommando-Mitschnitt (command_log.hpp, vom Modul oder leg_module_host --record) im
+// Originaltakt durch CommandRouter + MotionController ab, gegen den simulierten LEDC und ein Servo-Modell.
+// Ausgabe: Tracking-Fehler Servo vs. Sollwert, Latenz Frame -> Latch / aktive PWM, CPU-Zeit des Control-Ticks.
+
+namespace {
+
+struct Options {
+    const char* path = nullptr;
+    double slewDegPerS = 460.0; // typischer Hobby-Servo: 0.13 s / 60 deg
+    double tauMs = 20.0;
+    uint32_t rateHz = MotionController::DEFAULT_LOOP_RATE_HZ;
+    trajectory::ProfileType profile = trajectory::ProfileType::SCurve;
+    uint32_t settleMs = 500;    // Nachlauf nach dem letzten Frame
+    bool playout = false;
+};
+
+// Control-Loop-Fenster (1 s), im Service-Task eingesammelt
+struct TimingCollector {
+    MotionController* controller;
+    std::mutex lock;
+    std::vector<LoopTiming> windows;
+    uint32_t lastWindow = 0;
+};
+
+void timingSlot(void* arg) {
+    TimingCollector* c = static_cast<TimingCollector*>(arg);
+    const LoopTiming t = c->controller->loopTiming();
+    if (t.windows == c->lastWindow) return;
+    c->lastWindow = t.windows;
+    std::lock_guard<std::mutex> guard(c->lock);
+    c->windows.push_back(t);
+}
+
+void loggerSlot(void*) {
+    logger::service();
+}
+
+void serviceTask(void* arg) {
+    static_cast<Scheduler*>(arg)->run();
+}
+
+bool parseArgs(int argc, char** argv, Options& opt) {
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--slew-dps") == 0 && i + 1 < argc) {
+            opt.slewDegPerS = std::atof(argv[++i]);
+        } else if (std::strcmp(argv[i], "--tau-ms") == 0 && i + 1 < argc) {
+            opt.tauMs = std::atof(argv[++i]);
+        } else if (std::strcmp(argv[i], "--rate-hz") == 0 && i + 1 < argc) {
+            opt.rateHz = static_cast<uint32_t>(std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--settle-ms") == 0 && i + 1 < argc) {
+            opt.settleMs = static_cast<uint32_t>(std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--playout") == 0) {
+            opt.playout = true;
+        } else if (std::strcmp(argv[i], "--profile") == 0 && i + 1 < argc) {
+            const char* name = argv[++i];
+            if (std::strcmp(name, "trapezoidal") == 0) opt.profile = trajectory::ProfileType::Trapezoidal;
+            else if (std::strcmp(name, "scurve") == 0) opt.profile = trajectory::ProfileType::SCurve;
+            else return false;
+        } else if (argv[i][0] != '-' && !opt.path) {
+            opt.path = argv[i];
+        } else {
+            opt.path = nullptr;
+            break;
+        }
+    }
+    if (!opt.path || opt.tauMs <= 0.0 || opt.slewDegPerS <= 0.0) {
+        printf("usage: %s LOG [--slew-dps N] [--tau-ms N] [--rate-hz N] [--profile trapezoidal|scurve]"
+               " [--settle-ms N] [--playout]\n", argv[0]);
+        return false;
+    }
+    return true;
+}
+
+bool readFile(const char* path, std::vector<uint8_t>& out) {
+    FILE* f = std::fopen(path, "rb");
+    if (!f) return false;
+    uint8_t chunk[4096];
+    size_t n;
+    while ((n = std::fread(chunk, 1, sizeof(chunk), f)) > 0) out.insert(out.end(), chunk, chunk + n);
+    std::fclose(f);
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options opt;
+    if (!parseArgs(argc, argv, opt)) return 1;
+
+    std::vector<uint8_t> log;
+    if (!readFile(opt.path, log)) {
+        printf("cannot read %s\n", opt.path);
+        return 1;
+    }
+    command_log::Reader reader(log.data(), log.size());
+    if (!reader.valid()) {
+        printf("%s is not a command log\n", opt.path);
+        return 1;
+    }
+    if (!reader.matchesTopology()) {
+        printf("%s was recorded on a different module topology\n", opt.path);
+        return 1;
+    }
+    std::vector<command_log::Record> records;
+    command_log::Record rec;
+    while (reader.next(rec)) records.push_back(rec);
+    if (records.empty()) {
+        printf("%s contains no frames\n", opt.path);
+        return 1;
+    }
+
+    ServoDriver driver;
+    driver.initializePWM();
+    MotionController controller(driver);
+    controller.setProfileType(opt.profile);
+    controller.setLoopRateHz(opt.rateHz);
+    controller.setPlayoutEnabled(opt.playout);
+    controller.initialize();
+
+    TimingCollector timing;
+    timing.controller = &controller;
+    static Scheduler scheduler;
+    scheduler.addSlot("service", task_layout::SERVICE_SLOT_PERIOD_US, task_layout::SERVICE_SLOT_BUDGET_US,
+                      loggerSlot, nullptr);
+    scheduler.addSlot("timing", 250000, 1000, timingSlot, &timing);
+    task_layout::start(task_layout::SERVICE, serviceTask, &scheduler);
+    hal::delayMs(100); // Control-Loop läuft
+
+    // Originale Abstände der Frames (Modul-Uhr, low 32 bit, Differenzen überleben den Überlauf)
+    CommandRouter router(&controller);
+    std::vector<int64_t> injectUs;
+    const int64_t start = hal::nowUs();
+    const uint32_t firstArrival = records.front().arrivalUs;
+    for (const command_log::Record& r : records) {
+        const int64_t due = start + static_cast<int64_t>(static_cast<uint32_t>(r.arrivalUs - firstArrival));
+        const int64_t wait = due - hal::nowUs();
+        if (wait > 0) std::this_thread::sleep_for(std::chrono::microseconds(wait));
+        const int64_t now = hal::nowUs();
+        injectUs.push_back(now);
+        if (r.kind == command_log::FrameKind::Trajectory && r.len >= sizeof(TrajectoryChunkHeader)) {
+            // startUs ist Modul-Zeit der Aufnahme: auf die Replay-Uhr verschieben, Abstand zur Ankunft bleibt
+            std::vector<uint8_t> chunk(r.data, r.data + r.len);
+            TrajectoryChunkHeader h;
+            std::memcpy(&h, chunk.data(), sizeof(h));
+            h.startUs = h.startUs - r.arrivalUs + static_cast<uint32_t>(now);
+            std::memcpy(chunk.data(), &h, sizeof(h));
+            router.apply(r.kind, chunk.data(), chunk.size(), now);
+            continue;
+        }
+        router.apply(r.kind, r.data, r.len, now);
+    }
+    hal::delayMs(opt.settleMs);
+    const int64_t end = hal::nowUs();
+    logger::drain();
+
+    std::vector<hal::sim::PwmWrite> writes = hal::sim::pwmWrites();
+
+    // Latenz je Frame: Ankunft -> erster Latch mit geänderter Duty / -> Beginn der aktiven PWM-Periode
+    std::vector<int64_t> toLatch;
+    std::vector<int64_t> toActive;
+    size_t w = 0;
+    for (size_t i = 0; i < injectUs.size(); ++i) {
+        const int64_t next = i + 1 < injectUs.size() ? injectUs[i + 1] : end;
+        while (w < writes.size() && writes[w].t_us < injectUs[i]) ++w;
+        if (w < writes.size() && writes[w].t_us < next) {
+            toLatch.push_back(writes[w].t_us - injectUs[i]);
+            toActive.push_back(writes[w].active_us - injectUs[i]);
+        }
+    }
+
+    // Tracking-Fehler: Servo-Modell gegen den aktiven Sollwert, je Gelenk
+    ServoModel model(opt.slewDegPerS * 100.0, opt.tauMs * 1000.0);
+    std::vector<int64_t> errorRms;
+    std::vector<int64_t> errorMax;
+    double sumSq = 0.0;
+    size_t samples = 0;
+    int64_t worst = 0;
+    for (size_t i = 0; i < ServoDriver::NUM_SERVOS; ++i) {
+        const std::vector<ServoModel::Sample> trace =
+            model.simulate(writes, LegModule::SERVO_CHANNELS[i].channel, i, start, end, 1000);
+        double jointSq = 0.0;
+        int64_t jointMax = 0;
+        for (const ServoModel::Sample& s : trace) {
+            const double e = s.position - s.setpoint;
+            jointSq += e * e;
+            jointMax = std::max(jointMax, static_cast<int64_t>(std::fabs(e)));
+        }
+        if (trace.empty()) continue;
+        errorRms.push_back(static_cast<int64_t>(std::sqrt(jointSq / trace.size())));
+        errorMax.push_back(jointMax);
+        sumSq += jointSq;
+        samples += trace.size();
+        worst = std::max(worst, jointMax);
+    }
+
+    CommandTracker::Stats js = router.commandStats();
+    CommandTracker::Stats fs = router.footCommandStats();
+    CommandTracker::Stats gs = router.gaitCommandStats();
+    CommandTracker::Stats ts = router.trajectoryStats();
+    printf("replayed %zu frames over %.2f s: joint %u (stale %u, malformed %u), foot %u, gait %u, trajectory %u\n",
+           records.size(), (end - start) / 1e6, js.accepted, js.stale, js.malformed, fs.accepted, gs.accepted,
+           ts.accepted);
+    printf("servo model: slew %.0f deg/s, tau %.1f ms, control loop %u Hz\n",
+           opt.slewDegPerS, opt.tauMs, controller.loopRateHz());
+    printSummary("frame -> latch", summarize(toLatch));
+    printSummary("frame -> active pwm", summarize(toActive));
+    CommandLatency l = controller.commandLatency();
+    printf("controller command latency (arrival -> latch, last window, %u commands): min=%u mean=%u max=%u [us]\n",
+           l.count, l.minUs, l.meanUs, l.maxUs);
+    printSummary("tracking error rms/jnt", summarize(errorRms), "cdeg");
+    printSummary("tracking error max/jnt", summarize(errorMax), "cdeg");
+    printf("tracking error overall: rms=%.1f max=%lld [cdeg]\n",
+           samples ? std::sqrt(sumSq / samples) : 0.0, (long long)worst);
+
+    if (opt.playout) {
+        PlayoutBuffer::Stats p = controller.playoutStats();
+        printf("playout: delay %u us (target %u), jitter estimate %u us, late %u, extrapolated %u, held %u\n",
+               p.delayUs, p.targetDelayUs, p.jitterUs, p.late, p.extrapolated, p.held);
+    }
+
+    std::vector<int64_t> execMean;
+    std::vector<int64_t> execMax;
+    uint32_t overruns = 0;
+    {
+        std::lock_guard<std::mutex> guard(timing.lock);
+        for (const LoopTiming& t : timing.windows) {
+            execMean.push_back(t.execMeanUs);
+            execMax.push_back(t.execMaxUs);
+            overruns = t.budgetOverruns; // seit Start
+        }
+    }
+    printSummary("tick cpu mean/window", summarize(execMean));
+    printSummary("tick cpu max/window", summarize(execMax));
+    printf("control budget overruns: %u, frames %u, IK clamped %u, unreachable %u\n",
+           overruns, driver.frameStats().frames, controller.ikClamped(), controller.ikUnreachable());
+    return 0;
+}
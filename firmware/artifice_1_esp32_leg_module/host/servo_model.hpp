@@ -0,0 +1,61 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "../servo_driver.hpp"
+#include "sim_pwm.hpp"
+
+// Simulated hobby servo behind one LEDC channel: the active duty is the setpoint, the horn follows with a
+// first-order lag (tauUs) and never faster than the slew rate. Angles in centi-degrees.
+class ServoModel {
+public:
+    ServoModel(double slewCentiDegPerS, double tauUs) : slew(slewCentiDegPerS), tau(tauUs) {}
+
+    // Commanded angle of a duty (inverse of the calibration of servo index)
+    static double angleForDuty(uint32_t duty, size_t index) {
+        const servo_calibration::ServoCalibration& cal = ServoDriver::CALIBRATION[index];
+        const double pulse = static_cast<double>(duty) * servo_calibration::PWM_PERIOD_US / servo_calibration::DUTY_MAX;
+        double a = (pulse - cal.minPulseUs) * servo_calibration::MAX_ANGLE_CDEG / (cal.maxPulseUs - cal.minPulseUs);
+        a -= cal.offset;
+        return cal.direction < 0 ? servo_calibration::MAX_ANGLE_CDEG - a : a;
+    }
+
+    struct Sample {
+        int64_t tUs;
+        double setpoint;  // active duty as angle
+        double position;  // simulated horn
+    };
+
+    // Runs the model over the recorded writes of one channel from fromUs to toUs in stepUs steps.
+    // The horn starts at the first active setpoint.
+    std::vector<Sample> simulate(const std::vector<hal::sim::PwmWrite>& writes, uint32_t channel, size_t index,
+                                 int64_t fromUs, int64_t toUs, int64_t stepUs) const {
+        std::vector<Sample> out;
+        size_t next = 0;
+        bool have = false;
+        double setpoint = 0.0;
+        double position = 0.0;
+        for (int64_t t = fromUs; t <= toUs; t += stepUs) {
+            // Duty wirkt ab dem Beginn der PWM-Periode (active_us), nicht ab dem Latch
+            while (next < writes.size() && writes[next].active_us <= t) {
+                if (writes[next].channel == channel) {
+                    setpoint = angleForDuty(writes[next].duty, index);
+                    if (!have) position = setpoint;
+                    have = true;
+                }
+                ++next;
+            }
+            if (!have) continue;
+            double v = (setpoint - position) / tau * 1e6;
+            if (v > slew) v = slew;
+            if (v < -slew) v = -slew;
+            position += v * stepUs / 1e6;
+            out.push_back({t, setpoint, position});
+        }
+        return out;
+    }
+
+private:
+    double slew;
+    double tau;
+};
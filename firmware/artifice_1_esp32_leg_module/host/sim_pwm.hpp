@@ -0,0 +1,31 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Host-only view into the simulated LEDC of hal_linux.cpp
+namespace hal {
+namespace sim {
+
+// One latched duty (pwmUpdateDuty / pwmLatch), timestamps from hal::nowUs()
+struct PwmWrite {
+    int64_t t_us;        // latch request
+    int64_t active_us;   // start of the PWM period in which the duty becomes active
+    uint32_t channel;
+    uint32_t duty;
+};
+
+static const size_t MAX_PWM_CHANNELS = 16;
+static const size_t MAX_RECORDED_WRITES = 1u << 20;
+
+// Snapshot of all recorded writes in chronological order
+std::vector<PwmWrite> pwmWrites();
+// Writes lost because MAX_RECORDED_WRITES was reached
+size_t pwmDroppedWrites();
+// Duty that is currently active on the channel
+uint32_t pwmActiveDuty(uint32_t channel);
+uint32_t pwmFrequency();
+void pwmReset();
+
+} // namespace sim
+} // namespace hal
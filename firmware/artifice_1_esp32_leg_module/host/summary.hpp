@@ -0,0 +1,32 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+// min / avg / max of a host measurement, printed in one aligned line
+struct Summary {
+    int64_t min = 0;
+    int64_t max = 0;
+    double avg = 0.0;
+    size_t count = 0;
+};
+
+inline Summary summarize(std::vector<int64_t> values) {
+    Summary s;
+    if (values.empty()) return s;
+    std::sort(values.begin(), values.end());
+    int64_t sum = 0;
+    for (int64_t v : values) sum += v;
+    s.min = values.front();
+    s.max = values.back();
+    s.avg = static_cast<double>(sum) / values.size();
+    s.count = values.size();
+    return s;
+}
+
+inline void printSummary(const char* name, const Summary& s, const char* unit = "us") {
+    printf("%-24s n=%-6zu min=%-8lld avg=%-10.1f max=%lld [%s]\n",
+           name, s.count, (long long)s.min, s.avg, (long long)s.max, unit);
+}
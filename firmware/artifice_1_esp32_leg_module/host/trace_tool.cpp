@@ -0,0 +1,235 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "../command_log.hpp"
+#include "../trace.hpp"
+
+// Trace-Abbild (trace.hpp) -> Chrome / Perfetto JSON und Latenz-Histogramme.
+// Eingabe: Datei von `leg_module_host --trace` oder die zusammengesetzten Chunks von /leg/<id>/trace
+// (Payload ab ChunkHeader::offset hintereinander). Zeitachse: Sync-Events bilden den Zyklenzähler jedes Cores
+// auf hal::nowUs() ab, damit liegen beide Cores auf einer Achse.
+
+namespace {
+
+struct TimedEvent {
+    double us;
+    uint32_t core;
+    trace::Id id;
+    uint32_t arg;
+};
+
+const char* callbackName(uint32_t kind) {
+    switch (kind) {
+        case static_cast<uint32_t>(command_log::FrameKind::Joint): return "cb joint";
+        case static_cast<uint32_t>(command_log::FrameKind::Foot): return "cb foot";
+        case static_cast<uint32_t>(command_log::FrameKind::Gait): return "cb gait";
+        case static_cast<uint32_t>(command_log::FrameKind::Trajectory): return "cb trajectory";
+        case trace::JOINT_STATE_CALLBACK: return "cb joint_state";
+        default: return "cb ?";
+    }
+}
+
+// Name eines Begin/End-Paars, leer für andere Events
+std::string spanName(const TimedEvent& e) {
+    switch (e.id) {
+        case trace::Id::LoopBegin: case trace::Id::LoopEnd: return "control tick";
+        case trace::Id::ExecutorBegin: case trace::Id::ExecutorEnd: return "executor spin";
+        case trace::Id::CallbackBegin: case trace::Id::CallbackEnd: return callbackName(e.arg);
+        case trace::Id::LedcBegin: case trace::Id::LedcEnd: return "ledc write";
+        case trace::Id::SlotBegin: case trace::Id::SlotEnd: return "slot " + std::to_string(e.arg);
+        default: return "";
+    }
+}
+
+bool isBegin(trace::Id id) {
+    return id == trace::Id::LoopBegin || id == trace::Id::ExecutorBegin || id == trace::Id::CallbackBegin ||
+           id == trace::Id::LedcBegin || id == trace::Id::SlotBegin;
+}
+
+bool readFile(const char* path, std::vector<uint8_t>& out) {
+    FILE* f = std::fopen(path, "rb");
+    if (!f) return false;
+    uint8_t buf[4096];
+    size_t n;
+    while ((n = std::fread(buf, 1, sizeof(buf), f)) > 0) out.insert(out.end(), buf, buf + n);
+    std::fclose(f);
+    return true;
+}
+
+// Events eines Cores in Ring-Reihenfolge mit Zeit in us, relativ zum ersten Sync des Abbilds
+bool decodeCore(const uint8_t* data, uint32_t core, uint32_t eventsPerCore, uint32_t cyclesPerUs,
+                bool& haveRef, uint32_t& refUs, std::vector<TimedEvent>& out) {
+    uint32_t head;
+    std::memcpy(&head, data, sizeof(head));
+    const trace::Event* events = reinterpret_cast<const trace::Event*>(data + sizeof(head));
+    std::vector<trace::Event> ordered;
+    const uint32_t first = head > eventsPerCore ? head - eventsPerCore : 0;
+    for (uint32_t k = first; k != head; ++k) {
+        trace::Event e;
+        std::memcpy(&e, &events[k & (eventsPerCore - 1)], sizeof(e));
+        if (e.seq == static_cast<uint16_t>(k + 1)) ordered.push_back(e);
+    }
+    // Anker: jeweils der letzte Sync davor, für den Anfang der erste danach
+    const trace::Event* anchor = nullptr;
+    for (const trace::Event& e : ordered) {
+        if (e.id == static_cast<uint16_t>(trace::Id::Sync)) {
+            anchor = &e;
+            break;
+        }
+    }
+    if (!anchor) return false;
+    if (!haveRef) {
+        haveRef = true;
+        refUs = anchor->arg;
+    }
+    for (const trace::Event& e : ordered) {
+        if (e.id == static_cast<uint16_t>(trace::Id::Sync)) {
+            anchor = &e;
+            continue;
+        }
+        const double anchorUs = static_cast<double>(static_cast<int32_t>(anchor->arg - refUs));
+        const double deltaUs = static_cast<double>(static_cast<int32_t>(e.cycles - anchor->cycles)) / cyclesPerUs;
+        out.push_back({anchorUs + deltaUs, core, static_cast<trace::Id>(e.id), e.arg});
+    }
+    return true;
+}
+
+void printHistogram(const std::string& name, std::vector<double> values) {
+    if (values.empty()) return;
+    std::sort(values.begin(), values.end());
+    const auto pct = [&](double p) { return values[static_cast<size_t>(p * (values.size() - 1))]; };
+    printf("%-16s n=%-6zu min=%-8.1f p50=%-8.1f p99=%-8.1f max=%-8.1f [us]\n", name.c_str(), values.size(),
+           values.front(), pct(0.5), pct(0.99), values.back());
+    // Zweierpotenz-Buckets in us: <1, 1-2, 2-4, ...
+    std::vector<size_t> buckets(16, 0);
+    for (double v : values) {
+        size_t b = 0;
+        while (b + 1 < buckets.size() && v >= static_cast<double>(1u << b)) ++b;
+        ++buckets[b];
+    }
+    printf("%-16s", "");
+    for (size_t b = 0; b < buckets.size(); ++b) {
+        if (buckets[b] == 0) continue;
+        if (b == 0) printf(" <1:%zu", buckets[b]);
+        else printf(" %u-%u:%zu", 1u << (b - 1), 1u << b, buckets[b]);
+    }
+    printf("\n");
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const char* input = nullptr;
+    const char* jsonPath = nullptr;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+            jsonPath = argv[++i];
+        } else if (!input && argv[i][0] != '-') {
+            input = argv[i];
+        } else {
+            input = nullptr;
+            break;
+        }
+    }
+    if (!input) {
+        printf("usage: %s TRACE [--json OUT]\n", argv[0]);
+        return 1;
+    }
+
+    std::vector<uint8_t> image;
+    trace::DumpHeader header;
+    if (!readFile(input, image) || image.size() < sizeof(header)) {
+        printf("cannot read %s\n", input);
+        return 1;
+    }
+    std::memcpy(&header, image.data(), sizeof(header));
+    const size_t ringBytes = sizeof(uint32_t) + static_cast<size_t>(header.eventsPerCore) * sizeof(trace::Event);
+    if (header.magic != trace::DUMP_MAGIC || header.version != trace::DUMP_VERSION || header.cyclesPerUs == 0 ||
+        (header.eventsPerCore & (header.eventsPerCore - 1)) != 0 ||
+        image.size() < sizeof(header) + header.cores * ringBytes) {
+        printf("%s is not a complete trace image (version %u)\n", input, trace::DUMP_VERSION);
+        return 1;
+    }
+
+    std::vector<TimedEvent> events;
+    bool haveRef = false;
+    uint32_t refUs = 0;
+    for (uint32_t core = 0; core < header.cores; ++core) {
+        const size_t before = events.size();
+        if (!decodeCore(image.data() + sizeof(header) + core * ringBytes, core, header.eventsPerCore,
+                        header.cyclesPerUs, haveRef, refUs, events)) {
+            printf("core %u: no events\n", core);
+            continue;
+        }
+        printf("core %u: %zu events\n", core, events.size() - before);
+    }
+    std::stable_sort(events.begin(), events.end(),
+                     [](const TimedEvent& a, const TimedEvent& b) { return a.us < b.us; });
+    if (events.empty()) return 1;
+
+    // Dauer je Begin/End-Paar (je Core und Name), Periode des Control-Ticks, Ankünfte im Fast-Path
+    std::map<std::string, std::vector<double>> spans;
+    std::map<std::pair<uint32_t, std::string>, double> open;
+    std::vector<double> period;
+    double lastPeriodic = -1.0;
+    for (const TimedEvent& e : events) {
+        if (e.id == trace::Id::LoopBegin && (e.arg & 1u)) { // hal::WAKE_PERIOD
+            if (lastPeriodic >= 0.0) period.push_back(e.us - lastPeriodic);
+            lastPeriodic = e.us;
+        }
+        const std::string name = spanName(e);
+        if (name.empty()) continue;
+        const auto key = std::make_pair(e.core, name);
+        if (isBegin(e.id)) {
+            open[key] = e.us;
+        } else {
+            auto it = open.find(key);
+            if (it == open.end()) continue; // Begin vor dem Ringanfang
+            spans[name].push_back(e.us - it->second);
+            open.erase(it);
+        }
+    }
+    printf("window %.1f ms\n", (events.back().us - events.front().us) / 1000.0);
+    printHistogram("tick period", period);
+    for (const auto& s : spans) printHistogram(s.first, s.second);
+
+    if (jsonPath) {
+        FILE* f = std::fopen(jsonPath, "w");
+        if (!f) {
+            printf("cannot write %s\n", jsonPath);
+            return 1;
+        }
+        // Chrome Trace Event Format, ts in us; eine Spur je Core
+        std::fprintf(f, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+        for (uint32_t core = 0; core < header.cores; ++core) {
+            std::fprintf(f, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%u,\"args\":{\"name\":\"core %u\"}},\n",
+                         core, core);
+        }
+        const double origin = events.front().us;
+        for (size_t i = 0; i < events.size(); ++i) {
+            const TimedEvent& e = events[i];
+            const char* sep = i + 1 < events.size() ? ",\n" : "\n";
+            const std::string name = spanName(e);
+            if (e.id == trace::Id::FastFrame) {
+                std::fprintf(f, "{\"name\":\"fast frame\",\"ph\":\"i\",\"s\":\"t\",\"ts\":%.3f,\"pid\":0,\"tid\":%u,"
+                             "\"args\":{\"sequence\":%u}}%s", e.us - origin, e.core, e.arg, sep);
+            } else if (!name.empty()) {
+                std::fprintf(f, "{\"name\":\"%s\",\"ph\":\"%s\",\"ts\":%.3f,\"pid\":0,\"tid\":%u,\"args\":{\"arg\":%u}}%s",
+                             name.c_str(), isBegin(e.id) ? "B" : "E", e.us - origin, e.core, e.arg, sep);
+            } else {
+                std::fprintf(f, "{\"name\":\"event %u\",\"ph\":\"i\",\"s\":\"t\",\"ts\":%.3f,\"pid\":0,\"tid\":%u}%s",
+                             static_cast<unsigned>(e.id), e.us - origin, e.core, sep);
+            }
+        }
+        std::fprintf(f, "]}\n");
+        std::fclose(f);
+        printf("%zu events written to %s (chrome://tracing, ui.perfetto.dev)\n", events.size(), jsonPath);
+    }
+    return 0;
+}
@@ -0,0 +1,202 @@
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "../hal.hpp"
+#include "../transport.hpp"
+#include "summary.hpp"
+
+// Round-Trip- und Durchsatz-Benchmark des Transport-Layers: der UDP-Backend des Moduls spricht über Loopback
+// mit einem Agent-Stand-in, der jedes Datagramm (optional verzögert) zurückschickt. Je Nachrichtenrate und
+// Payload-Größe: RTT-Verteilung, Verluste, Durchsatz; dazu die Drahtzeit derselben Nachricht über UART
+// (XRCE serielles Framing) als Vergleich für die Wahl von Transport, MTU und History.
+
+namespace {
+
+struct Options {
+    uint32_t durationMs = 1000;   // je Messpunkt
+    uint16_t port = 18888;
+    uint32_t agentDelayUs = 0;    // Verarbeitungszeit des Stand-ins
+    uint32_t uartBaud = 921600;
+    std::vector<uint32_t> rates{50, 200, 1000};
+    std::vector<uint32_t> sizes{20, 64, 256, 512};
+};
+
+// XRCE serielles Framing: Flag, Quell-/Zieladresse, Länge (2), CRC (2); Escapes ignoriert
+const uint32_t UART_FRAMING_BYTES = 7;
+
+struct Header {
+    uint32_t sequence;
+    int64_t sendUs;
+};
+
+// Agent-Stand-in: Echo auf 127.0.0.1:port
+void agentStandIn(uint16_t port, uint32_t delayUs, std::atomic<bool>* running, std::atomic<bool>* ready) {
+    const int fd = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (fd < 0 || bind(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) != 0) {
+        printf("agent stand-in: cannot bind port %u\n", port);
+        if (fd >= 0) close(fd);
+        ready->store(true);
+        return;
+    }
+    timeval timeout{0, 50000};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    ready->store(true);
+    uint8_t buf[2048];
+    while (running->load()) {
+        sockaddr_in from{};
+        socklen_t fromLen = sizeof(from);
+        const ssize_t n = recvfrom(fd, buf, sizeof(buf), 0, reinterpret_cast<sockaddr*>(&from), &fromLen);
+        if (n <= 0) continue;
+        if (delayUs) std::this_thread::sleep_for(std::chrono::microseconds(delayUs));
+        sendto(fd, buf, static_cast<size_t>(n), 0, reinterpret_cast<const sockaddr*>(&from), fromLen);
+    }
+    close(fd);
+}
+
+std::vector<uint32_t> parseList(const char* text) {
+    std::vector<uint32_t> out;
+    for (const char* p = text; *p;) {
+        out.push_back(static_cast<uint32_t>(std::strtoul(p, nullptr, 10)));
+        const char* comma = std::strchr(p, ',');
+        if (!comma) break;
+        p = comma + 1;
+    }
+    return out;
+}
+
+bool parseArgs(int argc, char** argv, Options& opt) {
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--duration-ms") == 0 && i + 1 < argc) {
+            opt.durationMs = static_cast<uint32_t>(std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--port") == 0 && i + 1 < argc) {
+            opt.port = static_cast<uint16_t>(std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--agent-delay-us") == 0 && i + 1 < argc) {
+            opt.agentDelayUs = static_cast<uint32_t>(std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--uart-baud") == 0 && i + 1 < argc) {
+            opt.uartBaud = static_cast<uint32_t>(std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--rates") == 0 && i + 1 < argc) {
+            opt.rates = parseList(argv[++i]);
+        } else if (std::strcmp(argv[i], "--sizes") == 0 && i + 1 < argc) {
+            opt.sizes = parseList(argv[++i]);
+        } else {
+            printf("usage: %s [--duration-ms N] [--rates HZ,HZ,..] [--sizes BYTES,BYTES,..] [--port N]"
+                   " [--agent-delay-us N] [--uart-baud N]\n", argv[0]);
+            return false;
+        }
+    }
+    for (uint32_t s : opt.sizes) {
+        if (s < sizeof(Header) || s > 2048) {
+            printf("payload sizes must be %zu..2048 bytes\n", sizeof(Header));
+            return false;
+        }
+    }
+    return opt.durationMs > 0 && !opt.rates.empty() && !opt.sizes.empty();
+}
+
+int64_t percentile(std::vector<int64_t> values, double p) {
+    if (values.empty()) return 0;
+    std::sort(values.begin(), values.end());
+    return values[static_cast<size_t>(p * (values.size() - 1))];
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options opt;
+    if (!parseArgs(argc, argv, opt)) return 1;
+
+    std::atomic<bool> running{true};
+    std::atomic<bool> ready{false};
+    std::thread agent(agentStandIn, opt.port, opt.agentDelayUs, &running, &ready);
+    while (!ready.load()) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+    // Derselbe Backend-Code wie auf dem Modul, nur mit Loopback-Adresse
+    transport::Config config = transport::defaultConfig();
+    config.kind = transport::Kind::Udp;
+    config.agentIp = "127.0.0.1";
+    config.agentPort = opt.port;
+    if (!transport::select(config) || !transport::open()) {
+        printf("cannot open %s transport to 127.0.0.1:%u\n", "udp", opt.port);
+        running.store(false);
+        agent.join();
+        return 1;
+    }
+
+    printf("transport %s -> agent stand-in 127.0.0.1:%u (echo, %u us processing), %u ms per point\n",
+           transport::active()->name, opt.port, opt.agentDelayUs, opt.durationMs);
+    printf("%6s %6s | %6s %6s %5s | %8s %8s %8s %8s | %10s | %11s %10s\n", "rate", "bytes", "sent", "recv", "lost",
+           "rtt min", "p50", "p99", "max", "kB/s echo", "uart wire", "uart max");
+
+    std::vector<uint8_t> out(2048);
+    std::vector<uint8_t> in(2048);
+    uint32_t sequence = 0;
+    for (uint32_t size : opt.sizes) {
+        // Drahtzeit einer Nachricht über UART (8N1 = 10 Bit pro Byte), Obergrenze der Nachrichtenrate
+        const uint32_t uartWireUs = static_cast<uint32_t>(
+            (static_cast<uint64_t>(size + UART_FRAMING_BYTES) * 10 * 1000000) / opt.uartBaud);
+        for (uint32_t rate : opt.rates) {
+            if (rate == 0) continue;
+            const int64_t period = 1000000 / rate;
+            const uint32_t firstSequence = sequence + 1;
+            std::vector<int64_t> rtt;
+            uint32_t sent = 0;
+            const int64_t start = hal::nowUs();
+            const int64_t stop = start + static_cast<int64_t>(opt.durationMs) * 1000;
+            int64_t nextSend = start;
+            // Senden im festen Takt, dazwischen Antworten lesen (ein Task wie die XRCE-Session);
+            // nach dem letzten Senden 100 ms auf Nachzügler warten
+            while (true) {
+                const int64_t now = hal::nowUs();
+                if (now >= stop + 100000) break;
+                if (now >= nextSend && now < stop) {
+                    Header h{++sequence, now};
+                    std::memcpy(out.data(), &h, sizeof(h));
+                    if (transport::write(out.data(), size) == size) ++sent;
+                    nextSend += period;
+                    continue;
+                }
+                const int64_t until = now < stop ? nextSend : stop + 100000;
+                const int timeoutMs = static_cast<int>(std::max<int64_t>(0, (until - now) / 1000));
+                const size_t n = transport::read(in.data(), in.size(), timeoutMs);
+                if (n < sizeof(Header)) continue;
+                Header h;
+                std::memcpy(&h, in.data(), sizeof(h));
+                if (h.sequence < firstSequence) continue; // Nachzügler des vorigen Messpunkts
+                rtt.push_back(hal::nowUs() - h.sendUs);
+            }
+            const Summary s = summarize(rtt);
+            const uint32_t received = static_cast<uint32_t>(rtt.size());
+            const double kBps = static_cast<double>(received) * size / (opt.durationMs / 1000.0) / 1000.0;
+            printf("%6u %6u | %6u %6u %5u | %8lld %8lld %8lld %8lld | %10.1f | %8u us %6u/s\n",
+                   rate, size, sent, received, sent > received ? sent - received : 0, (long long)s.min,
+                   (long long)percentile(rtt, 0.5), (long long)percentile(rtt, 0.99), (long long)s.max, kBps,
+                   uartWireUs, uartWireUs ? 1000000 / uartWireUs : 0);
+        }
+    }
+
+    transport::close();
+    running.store(false);
+    agent.join();
+    transport::Stats ts = transport::stats();
+    printf("transport counters: %u packets out (%u bytes), %u in (%u bytes), %u write errors, %u read timeouts\n",
+           ts.packetsOut, ts.bytesOut, ts.packetsIn, ts.bytesIn, ts.writeErrors, ts.readTimeouts);
+    printf("uart columns: wire time of one message at %u baud incl. %u framing bytes, max one-way message rate\n",
+           opt.uartBaud, UART_FRAMING_BYTES);
+    return 0;
+}
@@ -0,0 +1,36 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include "module_topology.hpp"
+
+// Packed joint state frame for the whole module (all legs), little endian, 10 + 4 * joints bytes (34 for 2x3).
+// Sent as the payload of a std_msgs/UInt8MultiArray on /leg/<id>/joint_states.
+static const uint8_t JOINT_STATE_VERSION = 1;
+static const size_t JOINT_STATE_JOINTS = LegModule::SERVOS;
+
+#pragma pack(push, 1)
+struct JointStateFrame {
+    uint8_t version;                            // JOINT_STATE_VERSION
+    uint8_t jointCount;                         // JOINT_STATE_JOINTS
+    uint16_t sequence;                          // +1 per published frame, wraps
+    uint32_t stampUs;                           // module clock (low 32 bit) of the control tick
+    uint16_t commandSequence;                   // sequence of the last accepted LegCommand
+    int16_t positions[JOINT_STATE_JOINTS];      // commanded positions, centi-degrees, left leg first
+    int16_t velocities[JOINT_STATE_JOINTS];     // deci-degrees / s
+};
+#pragma pack(pop)
+
+static_assert(sizeof(JointStateFrame) == 10 + 4 * JOINT_STATE_JOINTS, "JointStateFrame wire size");
+
+inline size_t encodeJointState(const JointStateFrame& state, uint8_t* data, size_t capacity) {
+    if (capacity < sizeof(JointStateFrame)) return 0;
+    std::memcpy(data, &state, sizeof(JointStateFrame));
+    return sizeof(JointStateFrame);
+}
+
+inline bool decodeJointState(const uint8_t* data, size_t len, JointStateFrame& out) {
+    if (!data || len != sizeof(JointStateFrame)) return false;
+    std::memcpy(&out, data, sizeof(JointStateFrame));
+    return out.version == JOINT_STATE_VERSION && out.jointCount == JOINT_STATE_JOINTS;
+}
@@ -0,0 +1,255 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include "module_topology.hpp"
+
+// Packed command frame for the whole module (all legs), little endian, 8 + 2 * joints bytes (20 for 2x3).
+// Sent as the payload of a std_msgs/UInt8MultiArray on /leg/<id>/cmd_joint_positions.
+static const uint8_t LEG_COMMAND_VERSION = 1;
+static const size_t LEG_COMMAND_JOINTS = LegModule::SERVOS;
+
+#pragma pack(push, 1)
+struct LegCommand {
+    uint8_t version;                     // LEG_COMMAND_VERSION
+    uint8_t jointCount;                  // LEG_COMMAND_JOINTS
+    uint16_t sequence;                   // +1 per frame, wraps
+    uint32_t stampUs;                    // sender clock (low 32 bit), monotonic per sender
+    int16_t targets[LEG_COMMAND_JOINTS]; // centi-degrees, left leg first
+};
+#pragma pack(pop)
+
+static_assert(sizeof(LegCommand) == 8 + 2 * LEG_COMMAND_JOINTS, "LegCommand wire size");
+
+inline bool decodeLegCommand(const uint8_t* data, size_t len, LegCommand& out) {
+    if (!data || len != sizeof(LegCommand)) return false;
+    std::memcpy(&out, data, sizeof(LegCommand));
+    return out.version == LEG_COMMAND_VERSION && out.jointCount == LEG_COMMAND_JOINTS;
+}
+
+inline size_t encodeLegCommand(const LegCommand& cmd, uint8_t* data, size_t capacity) {
+    if (capacity < sizeof(LegCommand)) return 0;
+    std::memcpy(data, &cmd, sizeof(LegCommand));
+    return sizeof(LegCommand);
+}
+
+// Joint frame with an execute-at time, same topic and sequence as LegCommand, 12 + 2 * joints bytes (24 for 2x3).
+// Applied on the control tick at executeAtUs instead of on arrival, so modules synced to the same agent clock
+// (clock_sync.hpp) move together regardless of their transport delay. Told apart from LegCommand by the version.
+static const uint8_t TIMED_LEG_COMMAND_VERSION = 2;
+
+#pragma pack(push, 1)
+struct TimedLegCommand {
+    uint8_t version;                     // TIMED_LEG_COMMAND_VERSION
+    uint8_t jointCount;                  // LEG_COMMAND_JOINTS
+    uint16_t sequence;                   // shared with LegCommand
+    uint32_t stampUs;                    // sender clock (low 32 bit), monotonic per sender
+    uint32_t executeAtUs;                // agent clock (low 32 bit of the session epoch in us)
+    int16_t targets[LEG_COMMAND_JOINTS]; // centi-degrees, left leg first
+};
+#pragma pack(pop)
+
+static_assert(sizeof(TimedLegCommand) == 12 + 2 * LEG_COMMAND_JOINTS, "TimedLegCommand wire size");
+
+inline bool decodeTimedLegCommand(const uint8_t* data, size_t len, TimedLegCommand& out) {
+    if (!data || len != sizeof(TimedLegCommand)) return false;
+    std::memcpy(&out, data, sizeof(TimedLegCommand));
+    return out.version == TIMED_LEG_COMMAND_VERSION && out.jointCount == LEG_COMMAND_JOINTS;
+}
+
+inline size_t encodeTimedLegCommand(const TimedLegCommand& cmd, uint8_t* data, size_t capacity) {
+    if (capacity < sizeof(TimedLegCommand)) return 0;
+    std::memcpy(data, &cmd, sizeof(TimedLegCommand));
+    return sizeof(TimedLegCommand);
+}
+
+// Packed foot target frame, little endian, 8 + 6 * legs bytes (20 for 2 legs), on /leg/<id>/cmd_foot_positions.
+// Legs in legMask switch to Cartesian mode and move their foot in a straight line to the target (on-device IK).
+static const uint8_t FOOT_COMMAND_VERSION = 1;
+static const size_t FOOT_COMMAND_LEGS = LegModule::LEGS;
+
+#pragma pack(push, 1)
+struct FootCommand {
+    uint8_t version;                         // FOOT_COMMAND_VERSION
+    uint8_t legMask;                         // bit n = leg n (0 = left), other legs keep their targets
+    uint16_t sequence;                       // +1 per frame, wraps
+    uint32_t stampUs;                        // sender clock (low 32 bit), monotonic per sender
+    int16_t feet[FOOT_COMMAND_LEGS][3];      // x, y, z per leg in 0.1 mm, leg frame (x forward, y outward, z up)
+};
+#pragma pack(pop)
+
+static_assert(sizeof(FootCommand) == 8 + 6 * FOOT_COMMAND_LEGS, "FootCommand wire size");
+
+inline bool decodeFootCommand(const uint8_t* data, size_t len, FootCommand& out) {
+    if (!data || len != sizeof(FootCommand)) return false;
+    std::memcpy(&out, data, sizeof(FootCommand));
+    return out.version == FOOT_COMMAND_VERSION && out.legMask != 0 && (out.legMask >> FOOT_COMMAND_LEGS) == 0;
+}
+
+inline size_t encodeFootCommand(const FootCommand& cmd, uint8_t* data, size_t capacity) {
+    if (capacity < sizeof(FootCommand)) return 0;
+    std::memcpy(data, &cmd, sizeof(FootCommand));
+    return sizeof(FootCommand);
+}
+
+// Packed gait frame, little endian, 24 bytes, on /leg/<id>/cmd_gait.
+// Starts, retunes or stops the on-device gait generator; joint or foot commands stop it as well.
+static const uint8_t GAIT_COMMAND_VERSION = 1;
+static const uint8_t GAIT_FLAG_RUN = 0x01;
+
+#pragma pack(push, 1)
+struct GaitCommand {
+    uint8_t version;          // GAIT_COMMAND_VERSION
+    uint8_t flags;            // GAIT_FLAG_RUN: walk, cleared: stop and return to neutral
+    uint16_t sequence;        // +1 per frame, wraps
+    uint32_t stampUs;         // sender clock (low 32 bit), monotonic per sender
+    int16_t stride;           // 0.1 mm, negative = walk backwards
+    uint16_t stepHeight;      // 0.1 mm
+    uint16_t frequencyMilliHz;
+    uint16_t phaseOffset;     // 1/65536 cycle, leg n+1 relative to leg n
+    uint16_t dutyFactor;      // 1/65536, stance share
+    int16_t neutral[3];       // x, y, z in 0.1 mm, leg frame (center of the stride)
+};
+#pragma pack(pop)
+
+static_assert(sizeof(GaitCommand) == 24, "GaitCommand wire size");
+
+inline bool decodeGaitCommand(const uint8_t* data, size_t len, GaitCommand& out) {
+    if (!data || len != sizeof(GaitCommand)) return false;
+    std::memcpy(&out, data, sizeof(GaitCommand));
+    return out.version == GAIT_COMMAND_VERSION && (out.flags & ~GAIT_FLAG_RUN) == 0;
+}
+
+inline size_t encodeGaitCommand(const GaitCommand& cmd, uint8_t* data, size_t capacity) {
+    if (capacity < sizeof(GaitCommand)) return 0;
+    std::memcpy(data, &cmd, sizeof(GaitCommand));
+    return sizeof(GaitCommand);
+}
+
+// Timestamped joint waypoints for one leg, little endian, variable length, on /leg/<id>/cmd_trajectory:
+// TrajectoryChunkHeader, then count TrajectoryPoints (16 + 10 * count bytes for 3 joints per leg).
+// The module queues the points and interpolates between them (cubic Hermite) against its own clock.
+static const uint8_t TRAJECTORY_CHUNK_VERSION = 1;
+static const size_t TRAJECTORY_CHUNK_MAX_POINTS = 50;
+static const uint8_t TRAJECTORY_FLAG_REPLACE = 0x01;          // drop queued points from the first new one on
+static const uint8_t TRAJECTORY_FLAG_START_ON_ARRIVAL = 0x02; // startUs ignored, offsets count from arrival
+static const uint8_t TRAJECTORY_FLAG_AGENT_CLOCK = 0x04;      // startUs on the agent clock (clock_sync.hpp)
+
+#pragma pack(push, 1)
+struct TrajectoryChunkHeader {
+    uint8_t version;      // TRAJECTORY_CHUNK_VERSION
+    uint8_t leg;          // 0 = left
+    uint16_t sequence;    // +1 per chunk, wraps (all legs share one sequence)
+    uint32_t stampUs;     // sender clock (low 32 bit), monotonic per sender
+    uint32_t startUs;     // module clock (low 32 bit) of offset 0, e.g. from the joint state stamps,
+                          // or agent clock with TRAJECTORY_FLAG_AGENT_CLOCK
+    uint8_t count;        // points following the header, 1..TRAJECTORY_CHUNK_MAX_POINTS
+    uint8_t flags;        // TRAJECTORY_FLAG_*
+    uint8_t jointsPerLeg; // LegModule::JOINTS_PER_LEG
+    uint8_t reserved;
+};
+
+struct TrajectoryPoint {
+    uint32_t offsetUs;                            // after startUs, strictly increasing within the chunk
+    int16_t targets[LegModule::JOINTS_PER_LEG];   // centi-degrees
+};
+#pragma pack(pop)
+
+static_assert(sizeof(TrajectoryChunkHeader) == 16, "TrajectoryChunkHeader wire size");
+static_assert(sizeof(TrajectoryPoint) == 4 + 2 * LegModule::JOINTS_PER_LEG, "TrajectoryPoint wire size");
+
+static const size_t TRAJECTORY_CHUNK_MAX_BYTES =
+    sizeof(TrajectoryChunkHeader) + TRAJECTORY_CHUNK_MAX_POINTS * sizeof(TrajectoryPoint);
+
+// points must hold TRAJECTORY_CHUNK_MAX_POINTS entries
+inline bool decodeTrajectoryChunk(const uint8_t* data, size_t len, TrajectoryChunkHeader& header,
+                                  TrajectoryPoint* points) {
+    if (!data || len < sizeof(TrajectoryChunkHeader)) return false;
+    std::memcpy(&header, data, sizeof(header));
+    if (header.version != TRAJECTORY_CHUNK_VERSION || header.leg >= LegModule::LEGS ||
+        header.jointsPerLeg != LegModule::JOINTS_PER_LEG || header.count == 0 ||
+        header.count > TRAJECTORY_CHUNK_MAX_POINTS ||
+        (header.flags & ~(TRAJECTORY_FLAG_REPLACE | TRAJECTORY_FLAG_START_ON_ARRIVAL |
+                          TRAJECTORY_FLAG_AGENT_CLOCK)) != 0) {
+        return false;
+    }
+    if (len != sizeof(header) + header.count * sizeof(TrajectoryPoint)) return false;
+    std::memcpy(points, data + sizeof(header), header.count * sizeof(TrajectoryPoint));
+    for (size_t i = 1; i < header.count; ++i) {
+        if (points[i].offsetUs <= points[i - 1].offsetUs) return false;
+    }
+    return true;
+}
+
+inline size_t encodeTrajectoryChunk(const TrajectoryChunkHeader& header, const TrajectoryPoint* points,
+                                    uint8_t* data, size_t capacity) {
+    const size_t len = sizeof(header) + header.count * sizeof(TrajectoryPoint);
+    if (capacity < len) return 0;
+    std::memcpy(data, &header, sizeof(header));
+    std::memcpy(data + sizeof(header), points, header.count * sizeof(TrajectoryPoint));
+    return len;
+}
+
+// Sequence/stamp bookkeeping of the incoming stream (single writer, counters readable from anywhere)
+class CommandTracker {
+public:
+    struct Stats {
+        uint32_t accepted;
+        uint32_t dropped;   // frames missing in the sequence
+        uint32_t stale;     // duplicate or older than the last accepted frame
+        uint32_t malformed; // wrong size / version
+    };
+
+    // Returns true if the frame is newer than the last accepted one
+    bool accept(const LegCommand& cmd) { return accept(cmd.sequence, cmd.stampUs); }
+    bool accept(const TimedLegCommand& cmd) { return accept(cmd.sequence, cmd.stampUs); }
+    bool accept(const FootCommand& cmd) { return accept(cmd.sequence, cmd.stampUs); }
+    bool accept(const GaitCommand& cmd) { return accept(cmd.sequence, cmd.stampUs); }
+    bool accept(const TrajectoryChunkHeader& chunk) { return accept(chunk.sequence, chunk.stampUs); }
+
+    bool accept(uint16_t sequence, uint32_t stampUs) {
+        if (has_last) {
+            const int16_t seqDiff = static_cast<int16_t>(sequence - last_sequence);
+            const int32_t stampDiff = static_cast<int32_t>(stampUs - last_stamp);
+            if (seqDiff <= 0 || stampDiff < 0) {
+                stale.fetch_add(1, std::memory_order_relaxed);
+                // Dauerhaft "alte" Frames: Sender wurde neu gestartet -> neu synchronisieren
+                if (++consecutive_stale < RESYNC_AFTER_STALE) return false;
+            } else if (seqDiff > 1) {
+                dropped.fetch_add(static_cast<uint32_t>(seqDiff - 1), std::memory_order_relaxed);
+            }
+        }
+        consecutive_stale = 0;
+        has_last = true;
+        last_sequence = sequence;
+        last_stamp = stampUs;
+        accepted.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    // Sequence of the last accepted frame (0 before the first one), same task as accept()
+    uint16_t lastSequence() const { return last_sequence; }
+
+    void rejectMalformed() { malformed.fetch_add(1, std::memory_order_relaxed); }
+
+    // Sender restarted: next frame is accepted regardless of its sequence
+    void resync() { has_last = false; }
+
+    Stats stats() const {
+        return {accepted.load(std::memory_order_relaxed), dropped.load(std::memory_order_relaxed),
+                stale.load(std::memory_order_relaxed), malformed.load(std::memory_order_relaxed)};
+    }
+
+private:
+    static const uint32_t RESYNC_AFTER_STALE = 8;
+
+    bool has_last = false;
+    uint32_t consecutive_stale = 0;
+    uint16_t last_sequence = 0;
+    uint32_t last_stamp = 0;
+    std::atomic<uint32_t> accepted{0};
+    std::atomic<uint32_t> dropped{0};
+    std::atomic<uint32_t> stale{0};
+    std::atomic<uint32_t> malformed{0};
+};
@@ -0,0 +1,76 @@
+#include "leg_kinematics.hpp"
+#include <cmath>
+
+namespace kinematics {
+
+namespace {
+
+const float CDEG_PER_RAD = 18000.0f / 3.14159265f;
+
+// Gelenkwinkel (rad) -> Servo-Winkel mit Limits, meldet ob geklemmt wurde
+int32_t toServo(const JointMap& map, float jointRad, bool& clamped) {
+    int32_t servo = map.zeroCentiDeg + map.direction * static_cast<int32_t>(std::lround(jointRad * CDEG_PER_RAD));
+    if (servo < map.minCentiDeg) { servo = map.minCentiDeg; clamped = true; }
+    if (servo > map.maxCentiDeg) { servo = map.maxCentiDeg; clamped = true; }
+    return servo;
+}
+
+float toJoint(const JointMap& map, int32_t servoCentiDeg) {
+    return static_cast<float>((servoCentiDeg - map.zeroCentiDeg) * map.direction) / CDEG_PER_RAD;
+}
+
+} // namespace
+
+IkResult inverse(const LegConfig& cfg, const int32_t* footUm, int32_t* servoCentiDeg) {
+    const LegGeometry& g = cfg.geometry;
+    const float x = footUm[0] * 0.001f;
+    const float y = footUm[1] * 0.001f;
+    const float z = footUm[2] * 0.001f;
+
+    // Abduktion: Fuß in der y-z-Ebene, Oberschenkel-Ebene um hipOffset nach außen versetzt
+    const float dyz2 = y * y + z * z;
+    const float offset2 = g.hipOffsetMm * g.hipOffsetMm;
+    if (dyz2 <= offset2) return IkResult::Unreachable;
+    const float h = std::sqrt(dyz2 - offset2); // Beinlänge nach unten in der Oberschenkel-Ebene
+    const float hip = std::atan2(y, -z) - std::atan2(g.hipOffsetMm, h);
+
+    // Zwei-Gelenk-Kette in der Ebene (x, h), Reichweite auf den Arbeitsraum klemmen
+    bool clamped = false;
+    float r = std::sqrt(x * x + h * h);
+    const float rMax = g.thighMm + g.shinMm;
+    const float rMin = std::fabs(g.thighMm - g.shinMm) + 0.001f;
+    if (r > rMax) { r = rMax; clamped = true; }
+    if (r < rMin) { r = rMin; clamped = true; }
+
+    float cosKnee = (r * r - g.thighMm * g.thighMm - g.shinMm * g.shinMm) / (2.0f * g.thighMm * g.shinMm);
+    if (cosKnee > 1.0f) cosKnee = 1.0f;
+    if (cosKnee < -1.0f) cosKnee = -1.0f;
+    const float knee = -std::acos(cosKnee); // Knie knickt nach hinten
+    const float thigh = std::atan2(x, h) - std::atan2(g.shinMm * std::sin(knee), g.thighMm + g.shinMm * std::cos(knee));
+
+    servoCentiDeg[0] = toServo(cfg.joints[0], hip, clamped);
+    servoCentiDeg[1] = toServo(cfg.joints[1], thigh, clamped);
+    servoCentiDeg[2] = toServo(cfg.joints[2], knee, clamped);
+    return clamped ? IkResult::Clamped : IkResult::Ok;
+}
+
+void forward(const LegConfig& cfg, const int32_t* servoCentiDeg, int32_t* footUm) {
+    const LegGeometry& g = cfg.geometry;
+    const float hip = toJoint(cfg.joints[0], servoCentiDeg[0]);
+    const float thigh = toJoint(cfg.joints[1], servoCentiDeg[1]);
+    const float knee = toJoint(cfg.joints[2], servoCentiDeg[2]);
+
+    // Ebene: x nach vorn, h nach unten
+    const float x = g.thighMm * std::sin(thigh) + g.shinMm * std::sin(thigh + knee);
+    const float h = g.thighMm * std::cos(thigh) + g.shinMm * std::cos(thigh + knee);
+
+    // Ebene um die Abduktionsachse drehen, Versatz hipOffset nach außen
+    const float y = g.hipOffsetMm * std::cos(hip) + h * std::sin(hip);
+    const float z = g.hipOffsetMm * std::sin(hip) - h * std::cos(hip);
+
+    footUm[0] = static_cast<int32_t>(std::lround(x * 1000.0f));
+    footUm[1] = static_cast<int32_t>(std::lround(y * 1000.0f));
+    footUm[2] = static_cast<int32_t>(std::lround(z * 1000.0f));
+}
+
+} // namespace kinematics
@@ -0,0 +1,42 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// Inverse / forward kinematics of one 3-DOF leg (hip abduction, thigh pitch, knee pitch), single precision.
+// Leg frame at the hip abduction axis: x forward, y outward, z up, foot positions in micrometers.
+// Joint angles are 0 with the leg hanging straight down, the JointMap converts them to servo centi-degrees.
+namespace kinematics {
+
+static const size_t LEG_JOINTS = 3; // Hüfte, Oberschenkel, Knie
+
+struct LegGeometry {
+    float hipOffsetMm; // lateral offset abduction axis -> thigh plane
+    float thighMm;
+    float shinMm;
+};
+
+// servo = zeroCentiDeg + direction * joint, clamped to minCentiDeg..maxCentiDeg
+struct JointMap {
+    int32_t zeroCentiDeg;
+    int8_t direction;
+    int32_t minCentiDeg;
+    int32_t maxCentiDeg;
+};
+
+struct LegConfig {
+    LegGeometry geometry;
+    JointMap joints[LEG_JOINTS];
+};
+
+enum class IkResult : uint8_t {
+    Ok,
+    Clamped,    // target outside the workspace or joint limits, nearest reachable pose returned
+    Unreachable // inside the hip offset circle, servo angles unchanged
+};
+
+// footUm: x, y, z in micrometers -> servoCentiDeg for hip, thigh, knee
+IkResult inverse(const LegConfig& cfg, const int32_t* footUm, int32_t* servoCentiDeg);
+// servoCentiDeg -> foot position in micrometers
+void forward(const LegConfig& cfg, const int32_t* servoCentiDeg, int32_t* footUm);
+
+} // namespace kinematics
@@ -0,0 +1,96 @@
+#include "logger.hpp"
+#include "hal.hpp"
+#include "ring_queue.hpp"
+#include <atomic>
+#include <cstdio>
+
+namespace logger {
+
+namespace {
+
+// Kompakter Binär-Record, Formatierung erst im Service-Slot
+struct Record {
+    uint32_t timestampMs;
+    Level level;
+    uint8_t argc;
+    const char* format;
+    int32_t args[MAX_ARGS];
+};
+
+static const size_t RING_SIZE = 64;
+
+RingQueue<Record, RING_SIZE> ring;
+std::atomic<uint32_t> dropped{0};
+std::atomic<uint8_t> min_level{static_cast<uint8_t>(Level::Debug)};
+std::atomic<PublishHook> publish_hook{nullptr};
+
+// D < L < E
+uint8_t rank(Level level) {
+    switch (level) {
+        case Level::Debug: return 0;
+        case Level::Log:   return 1;
+        default:           return 2;
+    }
+}
+
+uint32_t reported_drops = 0; // nur vom Service-Task
+
+} // namespace
+
+void service() {
+    drain();
+
+    // Verlorene Records einmal melden, nicht pro Record
+    const uint32_t drops = dropped.load(std::memory_order_relaxed);
+    if (drops != reported_drops) {
+        LOG_E("logger: %u records dropped", drops - reported_drops);
+        reported_drops = drops;
+    }
+}
+
+void setPublishHook(PublishHook hook) {
+    publish_hook.store(hook);
+}
+
+void setMinLevel(Level level) {
+    min_level.store(rank(level), std::memory_order_relaxed);
+}
+
+uint32_t droppedRecords() {
+    return dropped.load(std::memory_order_relaxed);
+}
+
+void write(Level level, const char* format, size_t argc, const int32_t* args) {
+    if (rank(level) < min_level.load(std::memory_order_relaxed)) return;
+
+    Record r;
+    r.timestampMs = static_cast<uint32_t>(hal::nowUs() / 1000);
+    r.level = level;
+    r.argc = static_cast<uint8_t>(argc);
+    r.format = format;
+    for (size_t i = 0; i < MAX_ARGS; ++i) r.args[i] = i < argc ? args[i] : 0;
+
+    if (!ring.push(r)) dropped.fetch_add(1, std::memory_order_relaxed);
+}
+
+size_t drain() {
+    size_t count = 0;
+    Record r;
+    char line[MAX_LINE];
+    while (ring.pop(r)) {
+        // "<Level> [ms] text", erstes Zeichen = Level wie im README
+        int len = snprintf(line, sizeof(line), "%c [%u] ", static_cast<char>(r.level), (unsigned)r.timestampMs);
+        if (len < 0) len = 0;
+        int body = snprintf(line + len, sizeof(line) - len, r.format, r.args[0], r.args[1], r.args[2], r.args[3]);
+        if (body > 0) len += body;
+        if (len >= static_cast<int>(sizeof(line))) len = sizeof(line) - 1;
+
+        printf("%s\n", line);
+        PublishHook hook = publish_hook.load();
+        if (hook) hook(line, static_cast<size_t>(len));
+        ++count;
+    }
+    return count;
+}
+
+} // namespace logger
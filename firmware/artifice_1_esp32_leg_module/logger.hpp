@@ -0,0 +1,47 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// Deferred logging: the hot path only stores format pointer + integer args in a lock-free ring,
+// the service slot of the service task (logger::service) formats the records and writes them to UART and the
+// optional publish hook.
+// Formats must be string literals and take at most 4 integer (32-bit) arguments.
+namespace logger {
+
+enum class Level : uint8_t {
+    Debug = 'D',
+    Log   = 'L',
+    Error = 'E'
+};
+
+static const size_t MAX_ARGS = 4;
+static const size_t MAX_LINE = 96;
+
+// Called from drain() for every formatted line (e.g. ROS publisher), line starts with the level char
+using PublishHook = void (*)(const char* line, size_t len);
+
+void setPublishHook(PublishHook hook);
+// Records below this level are dropped at the call site
+void setMinLevel(Level level);
+// Records lost because the ring was full
+uint32_t droppedRecords();
+// Formats and writes all pending records, returns number of records (service slot and host)
+size_t drain();
+// drain() plus a one-time report of dropped records, called from the service slot
+void service();
+
+// Internal: stores one record, never blocks
+void write(Level level, const char* format, size_t argc, const int32_t* args);
+
+template <typename... Args>
+inline void log(Level level, const char* format, Args... args) {
+    static_assert(sizeof...(Args) <= MAX_ARGS, "logger supports at most 4 arguments");
+    const int32_t values[MAX_ARGS + 1] = {static_cast<int32_t>(args)..., 0};
+    write(level, format, sizeof...(Args), values);
+}
+
+} // namespace logger
+
+#define LOG_D(...) logger::log(logger::Level::Debug, __VA_ARGS__)
+#define LOG_L(...) logger::log(logger::Level::Log, __VA_ARGS__)
+#define LOG_E(...) logger::log(logger::Level::Error, __VA_ARGS__)
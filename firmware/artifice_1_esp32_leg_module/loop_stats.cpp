@@ -0,0 +1,140 @@
+#include "loop_stats.hpp"
+#include <cstring>
+
+void LoopStats::reset(uint32_t nominalPeriodUs, uint32_t windowCycles, uint32_t budgetUs) {
+    nominal_us = nominalPeriodUs;
+    window_cycles = windowCycles > 0 ? windowCycles : 1;
+    budget_us = budgetUs > 0 ? budgetUs : nominalPeriodUs;
+    cycles = 0;
+    missed = 0;
+    overruns = 0;
+    windows = 0;
+    period_sum = 0;
+    exec_sum = 0;
+    std::memset(jitter_histogram, 0, sizeof(jitter_histogram));
+    publish();
+}
+
+void LoopStats::record(uint32_t periodUs, uint32_t execUs) {
+    if (cycles == 0 || periodUs < period_min) period_min = periodUs;
+    if (cycles == 0 || periodUs > period_max) period_max = periodUs;
+    period_sum += periodUs;
+
+    const uint32_t jitter = periodUs > nominal_us ? periodUs - nominal_us : nominal_us - periodUs;
+    if (cycles == 0 || jitter > jitter_max) jitter_max = jitter;
+    size_t bucket = jitter / JITTER_BUCKET_US;
+    if (bucket >= JITTER_BUCKETS) bucket = JITTER_BUCKETS - 1;
+    ++jitter_histogram[bucket];
+
+    exec_sum += execUs;
+    if (cycles == 0 || execUs > exec_max) exec_max = execUs;
+    if (execUs > budget_us) ++overruns;
+
+    // Verpasste Perioden: Wakeup kam mehr als eine halbe Periode zu spät
+    if (nominal_us > 0 && periodUs > nominal_us + nominal_us / 2) {
+        missed += (periodUs - nominal_us / 2) / nominal_us;
+    }
+
+    if (++cycles >= window_cycles) {
+        publish();
+        cycles = 0;
+        period_sum = 0;
+        exec_sum = 0;
+        std::memset(jitter_histogram, 0, sizeof(jitter_histogram));
+    }
+}
+
+void LoopStats::publish() {
+    LoopTiming t;
+    t.nominalPeriodUs = nominal_us;
+    t.cycles = cycles;
+    t.missedPeriods = missed;
+    t.budgetUs = budget_us;
+    t.budgetOverruns = overruns;
+    if (cycles > 0) {
+        t.periodMinUs = period_min;
+        t.periodMaxUs = period_max;
+        t.periodMeanUs = static_cast<uint32_t>(period_sum / cycles);
+        t.jitterMaxUs = jitter_max;
+        t.execMeanUs = static_cast<uint32_t>(exec_sum / cycles);
+        t.execMaxUs = exec_max;
+
+        // p99 aus dem Histogramm (obere Bucketgrenze)
+        const uint32_t rank = cycles - cycles / 100;
+        uint32_t seen = 0;
+        for (size_t i = 0; i < JITTER_BUCKETS; ++i) {
+            seen += jitter_histogram[i];
+            if (seen >= rank) {
+                t.jitterP99Us = (i == JITTER_BUCKETS - 1) ? jitter_max
+                                                          : static_cast<uint32_t>((i + 1) * JITTER_BUCKET_US);
+                break;
+            }
+        }
+        t.windows = ++windows;
+    } else {
+        t.windows = windows;
+    }
+
+    const uint32_t seq = sequence.load(std::memory_order_relaxed);
+    sequence.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    published = t;
+    sequence.store(seq + 2, std::memory_order_release);
+}
+
+LoopTiming LoopStats::snapshot() const {
+    LoopTiming copy;
+    uint32_t before, after;
+    do {
+        before = sequence.load(std::memory_order_acquire);
+        copy = published;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        after = sequence.load(std::memory_order_relaxed);
+    } while ((before & 1u) || before != after);
+    return copy;
+}
+
+void LatencyStats::record(uint32_t latencyUs) {
+    if (count == 0 || latencyUs < min_us) min_us = latencyUs;
+    if (count == 0 || latencyUs > max_us) max_us = latencyUs;
+    sum_us += latencyUs;
+    last_us = latencyUs;
+    ++count;
+
+    // Kommandos sind selten, daher wird auch das laufende Fenster veröffentlicht
+    const bool windowDone = count >= WINDOW_COMMANDS;
+    if (windowDone) ++windows;
+    publish();
+    if (windowDone) {
+        count = 0;
+        sum_us = 0;
+    }
+}
+
+void LatencyStats::publish() {
+    CommandLatency l;
+    l.count = count;
+    l.minUs = min_us;
+    l.meanUs = count > 0 ? static_cast<uint32_t>(sum_us / count) : 0;
+    l.maxUs = max_us;
+    l.lastUs = last_us;
+    l.windows = windows;
+
+    const uint32_t seq = sequence.load(std::memory_order_relaxed);
+    sequence.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    published = l;
+    sequence.store(seq + 2, std::memory_order_release);
+}
+
+CommandLatency LatencyStats::snapshot() const {
+    CommandLatency copy;
+    uint32_t before, after;
+    do {
+        before = sequence.load(std::memory_order_acquire);
+        copy = published;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        after = sequence.load(std::memory_order_relaxed);
+    } while ((before & 1u) || before != after);
+    return copy;
+}
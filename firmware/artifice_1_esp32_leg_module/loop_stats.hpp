@@ -0,0 +1,93 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// Timing statistics of one completed measurement window of a periodic loop
+struct LoopTiming {
+    uint32_t nominalPeriodUs = 0;
+    uint32_t cycles = 0;          // cycles in this window
+    uint32_t periodMinUs = 0;
+    uint32_t periodMaxUs = 0;
+    uint32_t periodMeanUs = 0;
+    uint32_t jitterP99Us = 0;     // |period - nominal|, 99th percentile
+    uint32_t jitterMaxUs = 0;
+    uint32_t execMeanUs = 0;      // loop body execution time
+    uint32_t execMaxUs = 0;
+    uint32_t missedPeriods = 0;   // since start
+    uint32_t budgetUs = 0;        // execution budget per cycle
+    uint32_t budgetOverruns = 0;  // cycles with exec > budget, since start
+    uint32_t windows = 0;         // completed windows since start
+};
+
+// Collects period/jitter/execution statistics of a periodic loop.
+// record() is called by the loop itself (single writer), snapshot() from any task.
+class LoopStats {
+public:
+    // windowCycles: number of cycles per published window (e.g. loop rate -> 1 s windows),
+    // budgetUs: execution time per cycle above which an overrun is counted (0 = nominal period)
+    void reset(uint32_t nominalPeriodUs, uint32_t windowCycles, uint32_t budgetUs = 0);
+    // periodUs: time since the previous wakeup, execUs: loop body duration
+    void record(uint32_t periodUs, uint32_t execUs);
+    // Last completed window, consistent copy
+    LoopTiming snapshot() const;
+
+private:
+    static const uint32_t JITTER_BUCKET_US = 5;
+    static const size_t JITTER_BUCKETS = 200; // 0..1 ms, letzter Bucket = Überlauf
+
+    void publish();
+
+    // nur vom Loop-Task geschrieben
+    uint32_t nominal_us = 0;
+    uint32_t window_cycles = 1;
+    uint32_t cycles = 0;
+    uint32_t period_min = 0;
+    uint32_t period_max = 0;
+    uint64_t period_sum = 0;
+    uint32_t jitter_max = 0;
+    uint64_t exec_sum = 0;
+    uint32_t exec_max = 0;
+    uint32_t missed = 0;
+    uint32_t budget_us = 0;
+    uint32_t overruns = 0;
+    uint32_t windows = 0;
+    uint32_t jitter_histogram[JITTER_BUCKETS] = {};
+
+    // Seqlock: ungerade = Schreiber aktiv
+    std::atomic<uint32_t> sequence{0};
+    LoopTiming published{};
+};
+
+// Command latency (sample arrival -> first LEDC latch of the new frame), current window of up to WINDOW_COMMANDS
+struct CommandLatency {
+    uint32_t count = 0;   // commands in the current window
+    uint32_t minUs = 0;
+    uint32_t meanUs = 0;
+    uint32_t maxUs = 0;
+    uint32_t lastUs = 0;  // most recent command
+    uint32_t windows = 0; // completed windows since start
+};
+
+// Collects command latencies, same single-writer / seqlock scheme as LoopStats
+class LatencyStats {
+public:
+    static const uint32_t WINDOW_COMMANDS = 32;
+
+    void record(uint32_t latencyUs);
+    CommandLatency snapshot() const;
+
+private:
+    void publish();
+
+    // nur vom Loop-Task geschrieben
+    uint32_t count = 0;
+    uint32_t min_us = 0;
+    uint32_t max_us = 0;
+    uint64_t sum_us = 0;
+    uint32_t last_us = 0;
+    uint32_t windows = 0;
+
+    std::atomic<uint32_t> sequence{0};
+    CommandLatency published{};
+};
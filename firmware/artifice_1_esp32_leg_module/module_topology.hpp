@@ -0,0 +1,131 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include "leg_kinematics.hpp"
+#include "servo_calibration.hpp"
+#include "trajectory.hpp"
+
+// Compile-time description of one leg module: legs, joints per leg, servo pins / LEDC channels, calibration
+// and limits. Driver, motion controller and wire formats are sized from the selected variant, so the same
+// firmware builds for 2- or 4-leg modules with 3 or 4 joints per leg (at most 16 servos, one LEDC channel each).
+// Servo order everywhere: leg 0 first, per leg hip, thigh, knee (IK joints), then the extra joint if any.
+namespace topology {
+
+struct ServoChannel {
+    int pin;           // GPIO
+    uint32_t channel;  // LEDC channel 0-15 (hal: 0-7 high-speed, 8-15 low-speed group)
+};
+
+template <size_t Legs, size_t JointsPerLeg>
+struct ModuleTopology {
+    static constexpr size_t LEGS = Legs;
+    static constexpr size_t JOINTS_PER_LEG = JointsPerLeg;
+    static constexpr size_t SERVOS = Legs * JointsPerLeg;
+    // The first IK_JOINTS of a leg follow the IK in Cartesian mode, extra joints (foot) hold their position
+    static constexpr size_t IK_JOINTS = kinematics::LEG_JOINTS;
+
+    static_assert(Legs >= 1 && Legs <= 8, "leg masks are 8 bit");
+    static_assert(JointsPerLeg >= IK_JOINTS && JointsPerLeg <= 4, "3 or 4 joints per leg");
+    static_assert(SERVOS <= 16, "ESP32 LEDC has 16 channels (8 per speed group)");
+
+    static constexpr size_t servo(size_t leg, size_t joint) { return leg * JointsPerLeg + joint; }
+    static constexpr size_t legOf(size_t servo) { return servo / JointsPerLeg; }
+    static constexpr uint8_t allLegsMask() { return static_cast<uint8_t>((1u << Legs) - 1); }
+};
+
+// Every channel used once, otherwise two servos would share one duty register
+template <size_t N>
+constexpr bool uniqueChannels(const ServoChannel (&servos)[N]) {
+    for (size_t i = 0; i < N; ++i) {
+        if (servos[i].channel >= 16) return false;
+        for (size_t j = i + 1; j < N; ++j) {
+            if (servos[i].channel == servos[j].channel || servos[i].pin == servos[j].pin) return false;
+        }
+    }
+    return true;
+}
+
+// Latch mask of all channels of the module
+template <size_t N>
+constexpr uint32_t channelMask(const ServoChannel (&servos)[N]) {
+    uint32_t mask = 0;
+    for (size_t i = 0; i < N; ++i) mask |= 1u << servos[i].channel;
+    return mask;
+}
+
+static constexpr servo_calibration::ServoCalibration DEFAULT_SERVO = {0, 1, 500, 2500};
+// Hüfte, Oberschenkel, Knie, Fuß: 400 deg/s, 8000 deg/s^2
+static constexpr trajectory::JointLimits DEFAULT_JOINT_LIMITS = {40000, 800000};
+// Hüftversatz 20 mm, Oberschenkel 60 mm, Unterschenkel 70 mm
+static constexpr kinematics::LegGeometry DEFAULT_GEOMETRY = {20.0f, 60.0f, 70.0f};
+// Servo 90 deg = Gelenk 0 (Bein senkrecht), rechte Beine gespiegelt montiert
+static constexpr kinematics::LegConfig LEFT_LEG = {
+    DEFAULT_GEOMETRY, {{9000, 1, 4500, 13500}, {9000, 1, 0, 18000}, {9000, -1, 9000, 18000}}};
+static constexpr kinematics::LegConfig RIGHT_LEG = {
+    DEFAULT_GEOMETRY, {{9000, -1, 4500, 13500}, {9000, -1, 0, 18000}, {9000, 1, 0, 9000}}};
+
+// Artifice I: ein Modul = linkes + rechtes Bein, je 3 Gelenke
+struct TwoLegs3Dof : ModuleTopology<2, 3> {
+    static constexpr ServoChannel SERVO_CHANNELS[SERVOS] = {
+        {19, 0}, {18, 1}, {5, 2},
+        {17, 3}, {16, 4}, {4, 5}
+    };
+    static constexpr servo_calibration::ServoCalibration CALIBRATION[SERVOS] = {
+        DEFAULT_SERVO, DEFAULT_SERVO, DEFAULT_SERVO,
+        DEFAULT_SERVO, DEFAULT_SERVO, DEFAULT_SERVO
+    };
+    static constexpr trajectory::JointLimits JOINT_LIMITS[SERVOS] = {
+        DEFAULT_JOINT_LIMITS, DEFAULT_JOINT_LIMITS, DEFAULT_JOINT_LIMITS,
+        DEFAULT_JOINT_LIMITS, DEFAULT_JOINT_LIMITS, DEFAULT_JOINT_LIMITS
+    };
+    static constexpr kinematics::LegConfig LEG_CONFIG[LEGS] = {LEFT_LEG, RIGHT_LEG};
+};
+
+// Zwei Beinpaare mit 3 Gelenken, z.B. Quadruped aus einem Modul
+struct FourLegs3Dof : ModuleTopology<4, 3> {
+    static constexpr ServoChannel SERVO_CHANNELS[SERVOS] = {
+        {19, 0}, {18, 1}, {5, 2},
+        {17, 3}, {16, 4}, {4, 5},
+        {13, 6}, {12, 7}, {14, 8},
+        {27, 9}, {26, 10}, {25, 11}
+    };
+    static constexpr servo_calibration::ServoCalibration CALIBRATION[SERVOS] = {
+        DEFAULT_SERVO, DEFAULT_SERVO, DEFAULT_SERVO, DEFAULT_SERVO, DEFAULT_SERVO, DEFAULT_SERVO,
+        DEFAULT_SERVO, DEFAULT_SERVO, DEFAULT_SERVO, DEFAULT_SERVO, DEFAULT_SERVO, DEFAULT_SERVO
+    };
+    static constexpr trajectory::JointLimits JOINT_LIMITS[SERVOS] = {
+        DEFAULT_JOINT_LIMITS, DEFAULT_JOINT_LIMITS, DEFAULT_JOINT_LIMITS,
+        DEFAULT_JOINT_LIMITS, DEFAULT_JOINT_LIMITS, DEFAULT_JOINT_LIMITS,
+        DEFAULT_JOINT_LIMITS, DEFAULT_JOINT_LIMITS, DEFAULT_JOINT_LIMITS,
+        DEFAULT_JOINT_LIMITS, DEFAULT_JOINT_LIMITS, DEFAULT_JOINT_LIMITS
+    };
+    static constexpr kinematics::LegConfig LEG_CONFIG[LEGS] = {LEFT_LEG, RIGHT_LEG, LEFT_LEG, RIGHT_LEG};
+};
+
+// Linkes + rechtes Bein mit zusätzlichem Fußgelenk (4 Gelenke)
+struct TwoLegs4Dof : ModuleTopology<2, 4> {
+    static constexpr ServoChannel SERVO_CHANNELS[SERVOS] = {
+        {19, 0}, {18, 1}, {5, 2}, {13, 6},
+        {17, 3}, {16, 4}, {4, 5}, {12, 7}
+    };
+    static constexpr servo_calibration::ServoCalibration CALIBRATION[SERVOS] = {
+        DEFAULT_SERVO, DEFAULT_SERVO, DEFAULT_SERVO, DEFAULT_SERVO,
+        DEFAULT_SERVO, DEFAULT_SERVO, DEFAULT_SERVO, DEFAULT_SERVO
+    };
+    static constexpr trajectory::JointLimits JOINT_LIMITS[SERVOS] = {
+        DEFAULT_JOINT_LIMITS, DEFAULT_JOINT_LIMITS, DEFAULT_JOINT_LIMITS, DEFAULT_JOINT_LIMITS,
+        DEFAULT_JOINT_LIMITS, DEFAULT_JOINT_LIMITS, DEFAULT_JOINT_LIMITS, DEFAULT_JOINT_LIMITS
+    };
+    static constexpr kinematics::LegConfig LEG_CONFIG[LEGS] = {LEFT_LEG, RIGHT_LEG};
+};
+
+} // namespace topology
+
+// Module variant of this build, e.g. -DLEG_MODULE_TOPOLOGY=topology::FourLegs3Dof
+#ifndef LEG_MODULE_TOPOLOGY
+#define LEG_MODULE_TOPOLOGY topology::TwoLegs3Dof
+#endif
+
+using LegModule = LEG_MODULE_TOPOLOGY;
+
+static_assert(topology::uniqueChannels(LegModule::SERVO_CHANNELS), "servo pins / LEDC channels must be unique");
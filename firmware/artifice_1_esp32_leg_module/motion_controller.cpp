@@ -1,80 +1,702 @@
 #include "motion_controller.hpp"
 #include "servo_driver.hpp"
-#include <cstdio>
+#include "hal.hpp"
+#include "logger.hpp"
+#include "task_layout.hpp"
+#include "trace.hpp"
 
 MotionController* MotionController::globalInstance = nullptr;
 
+// Playout: mindestens 2 ms, höchstens 60 ms Verzögerung (4 x Jitter), 40 ms extrapolieren, dann halten
+const PlayoutBuffer::Config MotionController::PLAYOUT_CONFIG = {2000, 60000, 40000, 4};
+
+// Fuß: 300 mm/s, 3 m/s^2 je Achse
+const trajectory::JointLimits MotionController::FOOT_LIMITS[kinematics::LEG_JOINTS] = {
+    {300000, 3000000}, {300000, 3000000}, {300000, 3000000}
+};
+
 MotionController::MotionController(ServoDriver& driver) 
     : driver(&driver) // speichere Pointer intern
 {
     // Optional: setze globale Instance
     globalInstance = this;
+    for (size_t leg = 0; leg < NUM_LEGS; ++leg) waypoint_queues[leg] = trajectory::WaypointQueue(JOINTS_PER_LEG);
 }
 
 void MotionController::initialize() {
     // Initialisiere Startwinkel für alle Servos
+    int32_t frame[NUM_SERVOS];
     for (size_t i = 0; i < NUM_SERVOS; ++i) {
-        current_angles[i].store(START_ANGLE);
-        target_angles[i].store(START_ANGLE);
-        driver->setAngle(START_ANGLE, i);
+        current_angles[i].store(START_ANGLE * 100);
+        loop_targets[i] = START_ANGLE * 100;
+        command_staging.targets[i] = START_ANGLE * 100;
+        frame[i] = START_ANGLE * 100;
     }
+    driver->writeFrame(frame);
+    ready_us.store(static_cast<uint32_t>(hal::nowUs()));
+    LOG_L("module topology: %u legs x %u joints", static_cast<unsigned>(NUM_LEGS), static_cast<unsigned>(JOINTS_PER_LEG));
 
-    // Nur ein Task für alle Servos
-    BaseType_t ok = xTaskCreate(taskWrapper, "servo_task", 4096, nullptr, 5, nullptr);
-    if (ok != pdPASS) {
-        printf("Failed to create main servo task\n");
+    // Nur ein Task für alle Servos, allein auf dem Control-Core
+    bool ok = task_layout::start(task_layout::CONTROL, taskWrapper, nullptr);
+    if (!ok) {
+        LOG_E("Failed to create main servo task");
     }
 }
 
 
-void MotionController::spin() {
-    while (true) {
-        // print a message every 10 seconds to show that we are alive
-        static int counter = 0;
-        if (++counter % 200 == 0) {
-            printf("MotionController alive\n");
-            counter = 0;
+void MotionController::reportHealth() {
+    LoopTiming t = loopTiming();
+    LOG_L("MotionController alive: period %u us (min %u max %u) @ %u Hz",
+          t.periodMeanUs, t.periodMinUs, t.periodMaxUs, loopRateHz());
+    LOG_L("control jitter p99 %u max %u us, exec max %u us, missed %u",
+          t.jitterP99Us, t.jitterMaxUs, t.execMaxUs, t.missedPeriods);
+    if (t.budgetOverruns > 0) {
+        LOG_E("control budget %u us exceeded %u times", t.budgetUs, t.budgetOverruns);
+    }
+    if (ik_clamped.load() > 0 || ik_unreachable.load() > 0) {
+        LOG_E("IK: %u ticks clamped, %u unreachable", ik_clamped.load(), ik_unreachable.load());
+    }
+    if (playoutEnabled()) {
+        PlayoutBuffer::Stats p = playoutStats();
+        LOG_L("playout delay %u us (target %u), jitter %u us", p.delayUs, p.targetDelayUs, p.jitterUs);
+        LOG_L("playout late %u, extrapolated %u, held %u, overflows %u", p.late, p.extrapolated, p.held, p.overflows);
+    }
+    if (waypointOverflows() > 0) {
+        LOG_E("waypoints: %u chunks, %u points lost (queue full)", chunk_overflows.load(), waypoint_overflows.load());
+    }
+    CommandLatency l = commandLatency();
+    LOG_L("command latency min %u mean %u max %u us (n=%u)", l.minUs, l.meanUs, l.maxUs, l.count);
+    ScheduleStats ss = scheduleStats();
+    if (ss.scheduled > 0 || ss.rejected > 0 || ss.overflows > 0) {
+        LOG_L("timed frames %u, late %u, cancelled %u, pending %u", ss.scheduled, ss.late, ss.cancelled, ss.pending);
+        CommandLatency k = actuationSkew();
+        LOG_L("actuation skew min %u mean %u max %u us (n=%u)", k.minUs, k.meanUs, k.maxUs, k.count);
+        if (ss.rejected > 0 || ss.overflows > 0) {
+            LOG_E("timed frames: %u too far ahead, %u lost (schedule full)", ss.rejected, ss.overflows);
         }
-        vTaskDelay(pdMS_TO_TICKS(50));
     }
 }
 
 void MotionController::setTargetAngle(int angle, int index) {
-    if (index < 0 || index >= static_cast<int>(ServoDriver::NUM_SERVOS)) return;
-    target_angles[index].store(angle);
-    printf("Target angle set for servo %d: %d\n", index, angle);
+    if (index < 0 || index >= static_cast<int>(NUM_SERVOS)) return;
+    command_staging.targets[index] = angle * 100;
+    command_staging.cartesianMask &= static_cast<uint8_t>(~(1u << LegModule::legOf(index)));
+    publishCommand(hal::nowUs());
+    LOG_D("Target angle set for servo %d: %d", index, angle);
+}
+
+void MotionController::setLegTargets(size_t leg, const int32_t* centiDeg, size_t count) {
+    if (leg >= NUM_LEGS) return;
+    if (count > JOINTS_PER_LEG) count = JOINTS_PER_LEG;
+    for (size_t j = 0; j < count; ++j) {
+        command_staging.targets[LegModule::servo(leg, j)] = centiDeg[j];
+    }
+    command_staging.cartesianMask &= static_cast<uint8_t>(~(1u << leg));
+    publishCommand(hal::nowUs());
+    LOG_D("Target frame %u set for leg %u", command_staging.sequence, leg);
+}
+
+void MotionController::setTargetFrame(const int32_t* centiDeg, int64_t arrivalUs) {
+    for (size_t i = 0; i < NUM_SERVOS; ++i) command_staging.targets[i] = centiDeg[i];
+    command_staging.cartesianMask = 0;
+    publishCommand(arrivalUs != 0 ? arrivalUs : hal::nowUs());
+}
+
+void MotionController::streamTargetFrame(const int32_t* centiDeg, uint32_t senderStampUs, int64_t arrivalUs) {
+    if (!playout_enabled.load()) {
+        setTargetFrame(centiDeg, arrivalUs);
+        return;
+    }
+    // Staging aktuell halten, damit spätere Einzel-Kommandos auf dem gestreamten Stand aufsetzen
+    for (size_t i = 0; i < NUM_SERVOS; ++i) command_staging.targets[i] = centiDeg[i];
+    command_staging.cartesianMask = 0;
+
+    // Jeder Frame zählt (Interpolation), daher Queue statt Triple-Buffer; kein Wecken, abgespielt wird im Takt
+    StreamFrame frame;
+    for (size_t i = 0; i < NUM_SERVOS; ++i) frame.targets[i] = centiDeg[i];
+    frame.senderStampUs = senderStampUs;
+    frame.arrivalUs = arrivalUs != 0 ? arrivalUs : hal::nowUs();
+    if (!stream_queue.push(frame)) stream_overflows.fetch_add(1, std::memory_order_relaxed);
+}
+
+void MotionController::scheduleTargetFrame(const int32_t* centiDeg, int64_t executeAtUs, int64_t arrivalUs) {
+    if (arrivalUs == 0) arrivalUs = hal::nowUs();
+    // Weit in der Zukunft: eher ein falscher Sync als Absicht
+    if (executeAtUs - arrivalUs > MAX_SCHEDULE_AHEAD_US) {
+        timed_rejected.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    if (executeAtUs <= arrivalUs) timed_late.fetch_add(1, std::memory_order_relaxed);
+    // Staging auf den zuletzt geplanten Stand, spätere Einzel-Kommandos setzen dort auf
+    for (size_t i = 0; i < NUM_SERVOS; ++i) command_staging.targets[i] = centiDeg[i];
+    command_staging.cartesianMask = 0;
+
+    TimedFrame frame;
+    for (size_t i = 0; i < NUM_SERVOS; ++i) frame.targets[i] = centiDeg[i];
+    frame.executeAtUs = executeAtUs;
+    if (!timed_queue.push(frame)) {
+        timed_overflows.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    timed_scheduled.fetch_add(1, std::memory_order_relaxed);
+
+    // Servo-Task einsortieren lassen, er stellt den Wakeup auf den Ausführungszeitpunkt
+    const int timer = control_timer.load();
+    if (timer >= 0) hal::periodicNotify(timer);
+}
+
+MotionController::ScheduleStats MotionController::scheduleStats() const {
+    return {timed_scheduled.load(std::memory_order_relaxed), timed_late.load(std::memory_order_relaxed),
+            timed_rejected.load(std::memory_order_relaxed), timed_cancelled.load(std::memory_order_relaxed),
+            timed_overflows.load(std::memory_order_relaxed), timed_pending.load(std::memory_order_relaxed)};
+}
+
+void MotionController::cancelSchedule() {
+    timed_cancelled.fetch_add(static_cast<uint32_t>(schedule_count), std::memory_order_relaxed);
+    schedule_count = 0;
+    timed_pending.store(0);
+}
+
+PlayoutBuffer::Stats MotionController::playoutStats() const {
+    PlayoutBuffer::Stats copy;
+    uint32_t before, after;
+    do {
+        before = playout_stats_seq.load(std::memory_order_acquire);
+        copy = playout_stats_copy;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        after = playout_stats_seq.load(std::memory_order_relaxed);
+    } while ((before & 1u) || before != after);
+    copy.overflows += stream_overflows.load(std::memory_order_relaxed);
+    return copy;
+}
+
+void MotionController::publishPlayoutStats() {
+    const uint32_t seq = playout_stats_seq.load(std::memory_order_relaxed);
+    playout_stats_seq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    playout_stats_copy = playout.stats();
+    playout_stats_seq.store(seq + 2, std::memory_order_release);
+}
+
+void MotionController::setFootTargets(uint8_t legMask, const int32_t* footUm, int64_t arrivalUs) {
+    for (size_t leg = 0; leg < NUM_LEGS; ++leg) {
+        if (!(legMask & (1u << leg))) continue;
+        for (size_t a = 0; a < kinematics::LEG_JOINTS; ++a) {
+            command_staging.feet[leg * kinematics::LEG_JOINTS + a] = footUm[leg * kinematics::LEG_JOINTS + a];
+        }
+        command_staging.cartesianMask |= static_cast<uint8_t>(1u << leg);
+    }
+    publishCommand(arrivalUs != 0 ? arrivalUs : hal::nowUs());
+}
+
+void MotionController::setLegWaypoints(size_t leg, const trajectory::Waypoint* points, size_t count, bool replace,
+                                       int64_t arrivalUs) {
+    if (leg >= NUM_LEGS || count == 0) return;
+    if (count > MAX_CHUNK_POINTS) count = MAX_CHUNK_POINTS;
+    // Staging auf das Ende der Bahn, spätere Einzel-Kommandos setzen dort auf
+    for (size_t j = 0; j < JOINTS_PER_LEG; ++j) {
+        command_staging.targets[LegModule::servo(leg, j)] = points[count - 1].centiDeg[j];
+    }
+    command_staging.cartesianMask &= static_cast<uint8_t>(~(1u << leg));
+
+    chunk_staging.leg = static_cast<uint8_t>(leg);
+    chunk_staging.replace = replace;
+    chunk_staging.count = static_cast<uint8_t>(count);
+    chunk_staging.arrivalUs = arrivalUs != 0 ? arrivalUs : hal::nowUs();
+    for (size_t i = 0; i < count; ++i) chunk_staging.points[i] = points[i];
+    if (!chunk_queue.push(chunk_staging)) {
+        chunk_overflows.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    const int timer = control_timer.load();
+    if (timer >= 0) hal::periodicNotify(timer);
+}
+
+void MotionController::applyWaypointChunk(const WaypointChunk& chunk, int64_t nowUs) {
+    const size_t leg = chunk.leg;
+    const uint8_t bit = static_cast<uint8_t>(1u << leg);
+    trajectory::WaypointQueue& queue = waypoint_queues[leg];
+
+    // Waypoints übernehmen das Bein; Gait und Stream bewegen alle Beine und enden hier
+    if (gait_state.load() != GaitState::Off) stopGait();
+    if (streaming) stopStream();
+    loop_cartesian_mask &= static_cast<uint8_t>(~bit);
+
+    // Bahn beginnt an der aktuellen Stellung, nicht am alten Ziel
+    if (!(waypoint_mask & bit)) queue.clear();
+    if (queue.empty()) {
+        int32_t current[trajectory::WaypointQueue::MAX_JOINTS] = {};
+        for (size_t j = 0; j < JOINTS_PER_LEG; ++j) current[j] = current_angles[LegModule::servo(leg, j)].load();
+        queue.begin(nowUs, current);
+    }
+    const uint32_t lostBefore = queue.overflows();
+    queue.append(chunk.points, chunk.count, chunk.replace, nowUs);
+    if (queue.overflows() != lostBefore) {
+        waypoint_overflows.fetch_add(queue.overflows() - lostBefore, std::memory_order_relaxed);
+    }
+    waypoint_mask |= bit;
+    waypoint_depth[leg].store(static_cast<uint32_t>(queue.size()));
+}
+
+void MotionController::stopWaypoints() {
+    for (size_t leg = 0; leg < NUM_LEGS; ++leg) {
+        waypoint_queues[leg].clear();
+        waypoint_depth[leg].store(0);
+    }
+    waypoint_mask = 0;
+}
+
+void MotionController::publishCommand(int64_t arrivalUs) {
+    // Immer den kompletten Frame übergeben, der Servo-Task sieht nie halbe Updates
+    ++command_staging.sequence;
+    command_staging.arrivalUs = arrivalUs;
+    command_frames.writeBuffer() = command_staging;
+    command_frames.publish();
+
+    // Servo-Task sofort wecken statt bis zum nächsten Tick zu warten
+    const int timer = control_timer.load();
+    if (timer >= 0) hal::periodicNotify(timer);
+}
+
+void MotionController::publishFastFrame() {
+    fast_frames.publish();
+    const int timer = control_timer.load();
+    if (timer >= 0) hal::periodicNotify(timer);
+}
+
+void MotionController::publishState(int64_t nowUs, const int32_t* frame) {
+    // Geschwindigkeit aus zwei aufeinanderfolgenden Samples, kein Warten auf den Leser
+    JointState& state = state_frames.writeBuffer();
+    const int64_t dt = nowUs - last_frame_us;
+    for (size_t i = 0; i < NUM_SERVOS; ++i) {
+        state.positions[i] = frame[i];
+        state.velocities[i] = (last_frame_us != 0 && dt > 0)
+            ? static_cast<int32_t>((static_cast<int64_t>(frame[i] - last_frame[i]) * 1000000) / dt) : 0;
+        last_frame[i] = frame[i];
+    }
+    state.tick = ++state_tick;
+    state.appliedSequence = applied_sequence.load();
+    state.stampUs = nowUs;
+    last_frame_us = nowUs;
+    state_frames.publish();
+    state_ready.store(true);
+}
+
+bool MotionController::latestJointState(JointState& out) {
+    if (!state_ready.load()) return false;
+    state_frames.consume(); // ohne neuen Zustand bleibt der zuletzt übernommene gültig
+    out = state_frames.readBuffer();
+    return true;
+}
+
+void MotionController::setGait(const gait::GaitParams& params, bool run, int64_t arrivalUs) {
+    ++gait_staging.sequence;
+    gait_staging.arrivalUs = arrivalUs != 0 ? arrivalUs : hal::nowUs();
+    gait_staging.run = run;
+    gait_staging.params = params;
+    gait_commands.writeBuffer() = gait_staging;
+    gait_commands.publish();
+
+    const int timer = control_timer.load();
+    if (timer >= 0) hal::periodicNotify(timer);
+}
+
+void MotionController::applyGaitCommand(const GaitCommand& cmd) {
+    gait_generator.setParams(cmd.params);
+    if (cmd.run && gait_state.load() == GaitState::Off) {
+        // Erst zum Startpunkt des Zyklus fahren (gerade Linie), dann läuft die Phase
+        gait_generator.reset();
+        for (size_t leg = 0; leg < NUM_LEGS; ++leg) {
+            gait_generator.foot(leg, &loop_feet[leg * kinematics::LEG_JOINTS]);
+        }
+        loop_cartesian_mask = LegModule::allLegsMask();
+        gait_state.store(GaitState::Approach);
+    } else if (!cmd.run && gait_state.load() != GaitState::Off) {
+        stopGait();
+    }
+}
+
+void MotionController::stopGait() {
+    // Füße zurück zum Neutralpunkt, Start der Bahn aus der aktuellen Stellung
+    const gait::GaitParams& p = gait_generator.params();
+    for (size_t leg = 0; leg < NUM_LEGS; ++leg) {
+        for (size_t a = 0; a < kinematics::LEG_JOINTS; ++a) {
+            loop_feet[leg * kinematics::LEG_JOINTS + a] = p.neutralUm[a];
+        }
+    }
+    loop_cartesian_mask = LegModule::allLegsMask();
+    gait_state.store(GaitState::Off);
+}
+
+void MotionController::setProfileType(trajectory::ProfileType type) {
+    profile_type.store(type);
+}
+
+void MotionController::setLoopRateHz(uint32_t hz) {
+    if (hz < MIN_LOOP_RATE_HZ) hz = MIN_LOOP_RATE_HZ;
+    if (hz > MAX_LOOP_RATE_HZ) hz = MAX_LOOP_RATE_HZ;
+    loop_rate_hz.store(hz);
+}
+
+void MotionController::updateLeg(size_t leg, int64_t nowUs, int32_t* frame) {
+    if (loop_cartesian_mask & (1u << leg)) {
+        updateLegCartesian(leg, nowUs, frame);
+        return;
+    }
+
+    const size_t first = LegModule::servo(leg, 0);
+    trajectory::LegTrajectory& traj = leg_trajectories[leg];
+
+    // Wechsel aus dem kartesischen Modus / Gait: immer neu ab der aktuellen Stellung planen
+    const int32_t* targets = &loop_targets[first];
+    bool retarget = (joint_plan_stale & (1u << leg)) != 0;
+    joint_plan_stale &= static_cast<uint8_t>(~(1u << leg));
+    foot_plan_valid &= static_cast<uint8_t>(~(1u << leg));
+    for (size_t j = 0; j < JOINTS_PER_LEG; ++j) {
+        if (targets[j] != traj.target()[j]) retarget = true;
+    }
+
+    // Neues Ziel: Profil ab der aktuellen Position neu planen, alle Gelenke kommen gleichzeitig an
+    if (retarget) {
+        int32_t start[JOINTS_PER_LEG];
+        for (size_t j = 0; j < JOINTS_PER_LEG; ++j) start[j] = current_angles[first + j].load();
+        traj.plan(start, targets, &LegModule::JOINT_LIMITS[first], JOINTS_PER_LEG, profile_type.load(), nowUs);
+    }
+
+    traj.sample(nowUs, &frame[first]);
+    for (size_t j = 0; j < JOINTS_PER_LEG; ++j) {
+        current_angles[first + j].store(frame[first + j]);
+    }
+}
+
+void MotionController::updateLegCartesian(size_t leg, int64_t nowUs, int32_t* frame) {
+    const size_t first = LegModule::servo(leg, 0);
+    const size_t axes = kinematics::LEG_JOINTS;
+    trajectory::LegTrajectory& traj = foot_trajectories[leg];
+    int32_t* foot = &current_feet[leg * axes];
+    const int32_t* target = &loop_feet[leg * axes];
+
+    // Wechsel aus dem Gelenk-Modus / Gait: Startpunkt per Vorwärtskinematik aus der aktuellen Stellung
+    bool retarget = false;
+    joint_plan_stale |= static_cast<uint8_t>(1u << leg);
+    if (!(foot_plan_valid & (1u << leg))) {
+        int32_t angles[kinematics::LEG_JOINTS];
+        for (size_t j = 0; j < axes; ++j) angles[j] = current_angles[first + j].load();
+        kinematics::forward(LegModule::LEG_CONFIG[leg], angles, foot);
+        foot_plan_valid |= static_cast<uint8_t>(1u << leg);
+        retarget = true;
+    }
+    for (size_t a = 0; a < axes; ++a) {
+        if (target[a] != traj.target()[a]) retarget = true;
+    }
+
+    // Gerade Linie im Raum: alle Achsen folgen demselben normierten Profil
+    if (retarget) {
+        traj.plan(foot, target, FOOT_LIMITS, axes, profile_type.load(), nowUs);
+    }
+    traj.sample(nowUs, foot);
+    writeLegAngles(leg, foot, frame);
+}
+
+void MotionController::updateLegWaypoints(size_t leg, int64_t nowUs, int64_t dtUs, int32_t* frame) {
+    const size_t first = LegModule::servo(leg, 0);
+    int32_t sampled[trajectory::WaypointQueue::MAX_JOINTS];
+    const trajectory::WaypointQueue::Sample s = waypoint_queues[leg].sample(nowUs, sampled);
+    if (s != trajectory::WaypointQueue::Sample::Empty) {
+        for (size_t j = 0; j < JOINTS_PER_LEG; ++j) loop_targets[first + j] = sampled[j];
+    }
+    // Letzter Punkt erreicht: ab dem nächsten Tick hält die Gelenk-Trajektorie das Ziel
+    if (s != trajectory::WaypointQueue::Sample::Moving) waypoint_mask &= static_cast<uint8_t>(~(1u << leg));
+    waypoint_depth[leg].store(static_cast<uint32_t>(waypoint_queues[leg].size()));
+    followLegTargets(leg, dtUs, frame);
+}
+
+void MotionController::followLegTargets(size_t leg, int64_t dtUs, int32_t* frame) {
+    // Ziel kommt jeden Tick geglättet (Playout-Puffer / Waypoint-Spline): direkt folgen, nur auf die
+    // Gelenkgeschwindigkeit begrenzt (keine neue Trajektorie pro Tick)
+    joint_plan_stale |= static_cast<uint8_t>(1u << leg);
+    foot_plan_valid &= static_cast<uint8_t>(~(1u << leg));
+    for (size_t j = 0; j < JOINTS_PER_LEG; ++j) {
+        const size_t i = LegModule::servo(leg, j);
+        const int32_t current = current_angles[i].load();
+        const int32_t maxStep = static_cast<int32_t>(
+            static_cast<int64_t>(LegModule::JOINT_LIMITS[i].maxVelocity) * dtUs / 1000000);
+        int32_t step = loop_targets[i] - current;
+        if (step > maxStep) step = maxStep;
+        if (step < -maxStep) step = -maxStep;
+        frame[i] = current + step;
+        current_angles[i].store(frame[i]);
+    }
+}
+
+void MotionController::stopStream() {
+    streaming = false;
+    playout.reset();
+    publishPlayoutStats();
+}
+
+void MotionController::updateLegGait(size_t leg, int32_t* frame) {
+    // Fußpunkt direkt aus dem Gait, die Fuß-Trajektorie ist danach veraltet
+    joint_plan_stale |= static_cast<uint8_t>(1u << leg);
+    foot_plan_valid &= static_cast<uint8_t>(~(1u << leg));
+    int32_t* foot = &current_feet[leg * kinematics::LEG_JOINTS];
+    gait_generator.foot(leg, foot);
+    writeLegAngles(leg, foot, frame);
+}
+
+void MotionController::writeLegAngles(size_t leg, const int32_t* footUm, int32_t* frame) {
+    const size_t first = LegModule::servo(leg, 0);
+    const size_t axes = kinematics::LEG_JOINTS;
+    int32_t angles[kinematics::LEG_JOINTS];
+    const kinematics::IkResult result = kinematics::inverse(LegModule::LEG_CONFIG[leg], footUm, angles);
+    if (result == kinematics::IkResult::Unreachable) {
+        // Stellung halten
+        ik_unreachable.fetch_add(1, std::memory_order_relaxed);
+        for (size_t j = 0; j < axes; ++j) angles[j] = current_angles[first + j].load();
+    } else if (result == kinematics::IkResult::Clamped) {
+        ik_clamped.fetch_add(1, std::memory_order_relaxed);
+    }
+    for (size_t j = 0; j < axes; ++j) {
+        frame[first + j] = angles[j];
+        current_angles[first + j].store(angles[j]);
+    }
+    // Zusätzliche Gelenke (Fuß) gehören nicht zur IK und halten ihre Stellung
+    for (size_t j = axes; j < JOINTS_PER_LEG; ++j) frame[first + j] = current_angles[first + j].load();
 }
 
 void MotionController::allServosLoop() {
-    const int stepSize = 1;     // Schrittweite
-    const int loopDelayMs = 20; // Zykluszeit für alle Servos (momentan extra langsam für Testzwecke)
+    // Trajektorien starten auf der Startposition
+    for (size_t leg = 0; leg < NUM_LEGS; ++leg) {
+        int32_t start[JOINTS_PER_LEG];
+        for (size_t j = 0; j < JOINTS_PER_LEG; ++j) start[j] = current_angles[LegModule::servo(leg, j)].load();
+        leg_trajectories[leg].plan(start, start, &LegModule::JOINT_LIMITS[LegModule::servo(leg, 0)],
+                                   JOINTS_PER_LEG, profile_type.load(), hal::nowUs());
+    }
+
+    // Feste Kadenz über Timer statt vTaskDelay: Periode hängt nicht von der Laufzeit des Loops ab
+    uint32_t rate = loop_rate_hz.load();
+    int timer = hal::periodicStart(1000000 / rate);
+    if (timer < 0) {
+        LOG_E("Failed to start control loop timer");
+        return;
+    }
+    control_timer.store(timer);
+    loop_stats.reset(1000000 / rate, rate, 1000000 / rate * CONTROL_BUDGET_PERCENT / 100);
+    int64_t lastWake = hal::nowUs();
 
     while (true) {
+        const uint32_t wake = hal::periodicWait(timer);
+        const int64_t now = hal::nowUs();
+        TRACE_EVENT(LoopBegin, wake);
+
+        // Neuester vollständiger Kommando-Frame, falls vorhanden
+        const bool newCommand = command_frames.consume();
+        if (newCommand) {
+            const JointFrame& cmd = command_frames.readBuffer();
+            for (size_t i = 0; i < NUM_SERVOS; ++i) loop_targets[i] = cmd.targets[i];
+            for (size_t i = 0; i < NUM_LEGS * kinematics::LEG_JOINTS; ++i) loop_feet[i] = cmd.feet[i];
+            loop_cartesian_mask = cmd.cartesianMask;
+            // Kommando vom Brain hat Vorrang vor dem Gait, Einzel-/Fuß-Kommandos beenden den Stream
+            if (gait_state.load() != GaitState::Off) gait_state.store(GaitState::Off);
+            if (streaming) stopStream();
+            if (waypoint_mask) stopWaypoints();
+            fast_following = false;
+            applied_sequence.store(cmd.sequence);
+            pending_arrival_us = cmd.arrivalUs;
+        }
+        // Fast-Path: neuester Frame direkt aus dem Slot, in dem er dekodiert wurde
+        const bool newFast = fast_frames.consume();
+        if (newFast) {
+            const FastSlot& fast = fast_frames.readBuffer();
+            for (size_t i = 0; i < NUM_SERVOS; ++i) loop_targets[i] = fast.frame.command.targets[i];
+            loop_cartesian_mask = 0;
+            if (gait_state.load() != GaitState::Off) gait_state.store(GaitState::Off);
+            if (streaming) stopStream();
+            if (waypoint_mask) stopWaypoints();
+            fast_following = true;
+            pending_fast_us = fast.parsedUs;
+        }
+        // Gestreamte Frames: alle in den Playout-Puffer, nicht nur der neueste
+        StreamFrame streamed;
+        bool newStream = false;
+        while (stream_queue.pop(streamed)) {
+            playout.push(streamed.targets, streamed.senderStampUs, streamed.arrivalUs);
+            if (pending_arrival_us == 0) pending_arrival_us = streamed.arrivalUs;
+            newStream = true;
+        }
+        if (newStream && !streaming) {
+            streaming = true;
+            fast_following = false;
+            loop_cartesian_mask = 0;
+            if (gait_state.load() != GaitState::Off) gait_state.store(GaitState::Off);
+            if (waypoint_mask) stopWaypoints();
+        }
+        // Waypoint-Chunks: jeder ergänzt / ersetzt die Queue seines Beins
+        bool newChunk = false;
+        while (chunk_queue.pop(chunk_in)) {
+            applyWaypointChunk(chunk_in, now);
+            fast_following = false;
+            if (pending_arrival_us == 0) pending_arrival_us = chunk_in.arrivalUs;
+            newChunk = true;
+        }
+
+        const bool newGait = gait_commands.consume();
+        if (newGait) {
+            if (streaming) stopStream();
+            fast_following = false;
+            if (waypoint_mask) stopWaypoints();
+            const GaitCommand& cmd = gait_commands.readBuffer();
+            applyGaitCommand(cmd);
+            if (pending_arrival_us == 0) pending_arrival_us = cmd.arrivalUs;
+        }
+        // Andere Kommandos übernehmen: noch wartende zeitgesteuerte Frames verfallen
+        if ((newCommand || newFast || newStream || newChunk || newGait) && schedule_count > 0) cancelSchedule();
+        // Zeitgesteuerte Frames nach Ausführungszeit einsortieren
+        TimedFrame timed;
+        while (timed_queue.pop(timed)) {
+            if (schedule_count == MAX_SCHEDULED) {
+                timed_overflows.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+            size_t pos = schedule_count;
+            for (; pos > 0 && schedule[pos - 1].executeAtUs > timed.executeAtUs; --pos) schedule[pos] = schedule[pos - 1];
+            schedule[pos] = timed;
+            ++schedule_count;
+        }
+        // Fällige übernehmen; mehrere fällige (verspätet angekommen) -> nur der jüngste zählt
+        size_t due = 0;
+        while (due < schedule_count && schedule[due].executeAtUs <= now) ++due;
+        const bool newTimed = due > 0;
+        int64_t executeAt = 0;
+        if (newTimed) {
+            const TimedFrame& frame = schedule[due - 1];
+            for (size_t i = 0; i < NUM_SERVOS; ++i) loop_targets[i] = frame.targets[i];
+            loop_cartesian_mask = 0;
+            if (gait_state.load() != GaitState::Off) gait_state.store(GaitState::Off);
+            if (streaming) stopStream();
+            if (waypoint_mask) stopWaypoints();
+            fast_following = false;
+            executeAt = frame.executeAtUs;
+            for (size_t i = due; i < schedule_count; ++i) schedule[i - due] = schedule[i];
+            schedule_count -= due;
+        }
+        timed_pending.store(static_cast<uint32_t>(schedule_count));
+        // Eigener Wakeup genau zum nächsten Ausführungszeitpunkt, unabhängig vom Periodenraster
+        if (schedule_count > 0 && schedule[0].executeAtUs != armed_wake_us) {
+            armed_wake_us = schedule[0].executeAtUs;
+            hal::periodicWakeAt(timer, armed_wake_us);
+        }
+
+        // Event ohne neuen Frame (schon im letzten Tick übernommen) -> auf den nächsten Tick warten
+        if (!(wake & hal::WAKE_PERIOD) && !newCommand && !newFast && !newGait && !newChunk && !newTimed) {
+            TRACE_EVENT(LoopEnd, 0);
+            continue;
+        }
 
-        for (size_t i = 0; i < NUM_SERVOS; ++i) {
+        // Startpunkt erreicht -> Gait-Phase läuft ab jetzt
+        if (gait_state.load() == GaitState::Approach) {
+            bool arrived = true;
+            for (size_t i = 0; i < NUM_LEGS * kinematics::LEG_JOINTS; ++i) {
+                arrived = arrived && current_feet[i] == loop_feet[i];
+            }
+            if (arrived) {
+                gait_state.store(GaitState::Running);
+                last_gait_us = now;
+            }
+        }
+        const bool gaitRunning = gait_state.load() == GaitState::Running;
+        if (gaitRunning) {
+            gait_generator.advance(now - last_gait_us);
+            last_gait_us = now;
+            gait_phase.store(gait_generator.cyclePhase());
+        }
 
-            int current = current_angles[i].load();
-            int target  = target_angles[i].load();
+        // Zeit seit dem letzten Tick, Geschwindigkeitsgrenze für Stream und Waypoints
+        const int64_t tickDt = last_tick_us != 0 ? now - last_tick_us : 0;
+        last_tick_us = now;
 
-            if (current < target) {
-                current += stepSize;
-                if (current > target) current = target; // overshoot vermeiden
+        // Stream: Ziel für diesen Tick aus dem Playout-Puffer (interpoliert / extrapoliert / gehalten)
+        if (streaming) {
+            int32_t played[NUM_SERVOS];
+            if (playout.sample(now, played) != PlayoutBuffer::Output::Empty) {
+                for (size_t i = 0; i < NUM_SERVOS; ++i) loop_targets[i] = played[i];
             }
-            else if (current > target) {
-                current -= stepSize;
-                if (current < target) current = target;
+            publishPlayoutStats();
+        }
+
+        // Bei Kommando-Event sofort neu planen, nicht erst mit dem nächsten Tick
+        int32_t frame[NUM_SERVOS];
+        for (size_t leg = 0; leg < NUM_LEGS; ++leg) {
+            if (gaitRunning) updateLegGait(leg, frame);
+            else if (streaming || fast_following) followLegTargets(leg, tickDt, frame);
+            else if (waypoint_mask & (1u << leg)) updateLegWaypoints(leg, now, tickDt, frame);
+            else updateLeg(leg, now, frame);
+        }
+        // Ein Batch pro Tick, unveränderte Channels werden übersprungen
+        const size_t changed = driver->writeFrame(frame);
+
+        publishState(now, frame);
+
+        // Latenz Ankunft -> erster LEDC-Latch, der das neue Kommando umsetzt
+        if (pending_arrival_us != 0) {
+            if (changed > 0) {
+                latency_stats.record(static_cast<uint32_t>(hal::nowUs() - pending_arrival_us));
+                pending_arrival_us = 0;
+            } else if (wake & hal::WAKE_PERIOD) {
+                // Ziel entspricht der aktuellen Position -> keine Bewegung, nichts zu messen
+                bool atTarget = true;
+                for (size_t leg = 0; leg < NUM_LEGS; ++leg) {
+                    if (loop_cartesian_mask & (1u << leg)) {
+                        for (size_t a = 0; a < kinematics::LEG_JOINTS; ++a) {
+                            const size_t i = leg * kinematics::LEG_JOINTS + a;
+                            atTarget = atTarget && current_feet[i] == loop_feet[i];
+                        }
+                    } else {
+                        for (size_t j = 0; j < JOINTS_PER_LEG; ++j) {
+                            const size_t i = LegModule::servo(leg, j);
+                            atTarget = atTarget && frame[i] == loop_targets[i];
+                        }
+                    }
+                }
+                if (atTarget) pending_arrival_us = 0;
             }
+        }
+
+        // Zeitgesteuert: Abstand des Latches zum vorgegebenen Zeitpunkt, auch ohne Bewegung (gleicher Tick zählt)
+        if (newTimed) {
+            const int64_t skew = hal::nowUs() - executeAt;
+            actuation_skew.record(static_cast<uint32_t>(skew < 0 ? -skew : skew));
+        }
 
-            current_angles[i].store(current);
-            driver->setAngle(current, i);
+        // Fast-Path: Frame fertig geparst -> erster Latch, der ihn umsetzt (Ziel erreicht = nichts zu messen)
+        if (pending_fast_us != 0) {
+            if (changed > 0) {
+                fast_latency.record(static_cast<uint32_t>(hal::nowUs() - pending_fast_us));
+                pending_fast_us = 0;
+            } else if (wake & hal::WAKE_PERIOD) {
+                pending_fast_us = 0;
+            }
         }
 
-        // EIN Delay für ALLE Servos
-        vTaskDelay(pdMS_TO_TICKS(loopDelayMs));
+        TRACE_EVENT(LoopEnd, changed);
+
+        // Nur echte Perioden gehen in die Jitter-Statistik
+        if (!(wake & hal::WAKE_PERIOD)) continue;
+        loop_stats.record(static_cast<uint32_t>(now - lastWake), static_cast<uint32_t>(hal::nowUs() - now));
+        lastWake = now;
+
+        // Rate geändert -> Periode des laufenden Timers umstellen (Handle und Wakeup bleiben), Statistik von vorn
+        if (loop_rate_hz.load() != rate) {
+            rate = loop_rate_hz.load();
+            hal::periodicSetPeriod(timer, 1000000 / rate);
+            loop_stats.reset(1000000 / rate, rate, 1000000 / rate * CONTROL_BUDGET_PERCENT / 100);
+            lastWake = hal::nowUs();
+        }
     }
 }
 
 void MotionController::taskWrapper(void* param) {
     if (globalInstance) globalInstance->allServosLoop();
-    vTaskDelete(nullptr);
+    hal::deleteCurrentTask();
 }
@@ -1,26 +1,285 @@
 #pragma once
 #include <atomic>
+#include "fast_frame.hpp"
+#include "frame_buffer.hpp"
+#include "gait.hpp"
+#include "leg_kinematics.hpp"
+#include "loop_stats.hpp"
+#include "module_topology.hpp"
+#include "playout_buffer.hpp"
+#include "ring_queue.hpp"
 #include "servo_driver.hpp"
-#include "freertos/FreeRTOS.h"
-#include "freertos/task.h"
+#include "trajectory.hpp"
+#include "waypoint_queue.hpp"
+
+// Joint stream through the playout (jitter) buffer from boot, switchable at runtime
+#ifndef JOINT_PLAYOUT_ENABLED
+#define JOINT_PLAYOUT_ENABLED 0
+#endif
 
 class MotionController {
 public:
     MotionController(ServoDriver& driver); // constcuctor mit Referenz auf ServoDriver
     void initialize();
+    // Command side (single writer, e.g. the ROS executor task): each call publishes a complete frame
     void setTargetAngle(int angle, int index);
-    void spin();
+    // Sets the first count joints of one leg in centi-degrees as one frame
+    void setLegTargets(size_t leg, const int32_t* centiDeg, size_t count);
+    // Sets all NUM_SERVOS targets in centi-degrees as one frame.
+    // arrivalUs: hal::nowUs() when the command arrived (0 = now), start of the latency measurement
+    void setTargetFrame(const int32_t* centiDeg, int64_t arrivalUs = 0);
+    // Frame of the streamed joint topic with its sender timestamp. With playout enabled it goes through the
+    // jitter buffer (smooth, adds playoutStats().delayUs of latency), otherwise it is a plain setTargetFrame.
+    void streamTargetFrame(const int32_t* centiDeg, uint32_t senderStampUs, int64_t arrivalUs);
+    // Joint frame applied on the control tick at executeAtUs (module clock, e.g. an agent execute-at time
+    // converted by ClockSync) instead of on arrival: the loop is woken at that instant. Frames run in time order,
+    // one whose time has already passed runs at once (counted late), frames more than MAX_SCHEDULE_AHEAD_US ahead
+    // are rejected. Any other command cancels the frames still waiting.
+    void scheduleTargetFrame(const int32_t* centiDeg, int64_t executeAtUs, int64_t arrivalUs = 0);
+    struct ScheduleStats {
+        uint32_t scheduled; // accepted since start
+        uint32_t late;      // arrived after their execute-at time
+        uint32_t rejected;  // too far ahead
+        uint32_t cancelled; // dropped by another command before their time
+        uint32_t overflows; // queue / schedule full
+        uint32_t pending;   // waiting now
+    };
+    ScheduleStats scheduleStats() const;
+    // |LEDC latch - executeAtUs| of the scheduled frames, current window
+    CommandLatency actuationSkew() const { return actuation_skew.snapshot(); }
+    void setPlayoutEnabled(bool enabled) { playout_enabled.store(enabled); }
+    bool playoutEnabled() const { return playout_enabled.load(); }
+    // Delay / jitter / late-frame counters of the playout buffer, readable from any task
+    PlayoutBuffer::Stats playoutStats() const;
+    // Cartesian foot targets (x, y, z in micrometers per leg, NUM_LEGS * 3 entries) for the legs in legMask.
+    // These legs move their foot on a straight line, joint angles come from the on-device IK every tick.
+    // Joint targets (setTargetFrame / setLegTargets) switch a leg back to joint mode.
+    void setFootTargets(uint8_t legMask, const int32_t* footUm, int64_t arrivalUs = 0);
+    // IK calls that had to clamp (workspace / joint limits) or could not reach the target, since start
+    uint32_t ikClamped() const { return ik_clamped.load(); }
+    uint32_t ikUnreachable() const { return ik_unreachable.load(); }
+    static const kinematics::LegConfig& legConfig(size_t leg) { return LegModule::LEG_CONFIG[leg]; }
+    // Timestamped waypoints (module clock) for one leg, played from a look-ahead queue with cubic Hermite
+    // interpolation. replace: the points take over the queued tail from points[0] on, otherwise appended.
+    // Joint, foot, stream or gait commands end the waypoint motion of the legs they move.
+    void setLegWaypoints(size_t leg, const trajectory::Waypoint* points, size_t count, bool replace,
+                         int64_t arrivalUs = 0);
+    // Waypoints still queued for one leg (0 = not following waypoints), readable from any task
+    uint32_t waypointsQueued(size_t leg) const { return leg < NUM_LEGS ? waypoint_depth[leg].load() : 0; }
+    // Chunks / points lost because a queue was full, since start
+    uint32_t waypointOverflows() const { return chunk_overflows.load() + waypoint_overflows.load(); }
+    // Gait engine: run = true starts walking (feet first move to the start of the cycle), false stops it and
+    // returns the feet to the neutral point. New parameters apply on the next tick, the phase continues.
+    // Any joint or foot command stops the gait as well.
+    void setGait(const gait::GaitParams& params, bool run, int64_t arrivalUs = 0);
+    bool gaitRunning() const { return gait_state.load() != GaitState::Off; }
+    // Phase of the running gait, 2^32 = one cycle
+    uint32_t gaitPhase() const { return gait_phase.load(); }
+    // Raw fast path (fast_link.hpp): frame decoded in place by one producer task, parsedUs set on completion.
+    // The loop follows fast frames directly (velocity-limited, no re-planning); any ROS joint, foot, stream,
+    // gait or waypoint command takes over again. ROS joint commands start from the last ROS frame.
+    struct FastSlot {
+        FastJointFrame frame;
+        int64_t parsedUs;   // hal::nowUs() when the frame was complete and checked
+    };
+    FastSlot& fastFrameSlot() { return fast_frames.writeBuffer(); }
+    // Hands the slot to the control loop and wakes it, the producer gets a fresh slot
+    void publishFastFrame();
+    // Fast frame parsed -> LEDC latch latency of the current window
+    CommandLatency fastLatency() const { return fast_latency.snapshot(); }
+    // Sequence number of the last frame the control loop has taken over
+    uint32_t appliedSequence() const { return applied_sequence.load(); }
+    void setProfileType(trajectory::ProfileType type);
+    // Boot -> start pose written to the servos (holding torque), 0 before initialize()
+    uint32_t readyUs() const { return ready_us.load(); }
+    // Control loop rate, clamped to MIN_LOOP_RATE_HZ..MAX_LOOP_RATE_HZ, applied on the next cycle
+    void setLoopRateHz(uint32_t hz);
+    uint32_t loopRateHz() const { return loop_rate_hz.load(); }
+    // Period/jitter statistics of the last completed 1 s window
+    LoopTiming loopTiming() const { return loop_stats.snapshot(); }
+    // Command arrival -> LEDC latch latency of the current window
+    CommandLatency commandLatency() const { return latency_stats.snapshot(); }
+    // Alive/timing report, called from the slow health slot of the service scheduler
+    void reportHealth();
 
     static MotionController* globalInstance;
 
-    static const size_t NUM_SERVOS = 6;
+    // Sizes of the module variant (module_topology.hpp), extra joints after the IK joints of each leg
+    static const size_t NUM_SERVOS = LegModule::SERVOS;
+    static const size_t NUM_LEGS = LegModule::LEGS;
+    static const size_t JOINTS_PER_LEG = LegModule::JOINTS_PER_LEG;
+    static_assert(NUM_SERVOS == ServoDriver::NUM_SERVOS, "driver and controller built for different modules");
+    static_assert(JOINTS_PER_LEG <= trajectory::LegTrajectory::MAX_JOINTS, "leg trajectory too small");
+    static_assert(NUM_SERVOS <= PlayoutBuffer::MAX_JOINTS, "playout buffer too small");
+    static_assert(JOINTS_PER_LEG <= trajectory::WaypointQueue::MAX_JOINTS, "waypoint too small");
+
+    // Points per setLegWaypoints call, more are ignored
+    static const size_t MAX_CHUNK_POINTS = 50;
+    // Scheduled frames waiting at once, and how far ahead they may be
+    static const size_t MAX_SCHEDULED = 8;
+    static const int64_t MAX_SCHEDULE_AHEAD_US = 2000000;
+
+    // Playout buffer defaults: 2..60 ms delay (4 x jitter), 40 ms extrapolation
+    static const PlayoutBuffer::Config PLAYOUT_CONFIG;
+
+    static const uint32_t MIN_LOOP_RATE_HZ = 50;
+    static const uint32_t MAX_LOOP_RATE_HZ = 1000;
+    static const uint32_t DEFAULT_LOOP_RATE_HZ = 50;
+    // Execution budget of one control tick in percent of the period
+    static const uint32_t CONTROL_BUDGET_PERCENT = 50;
+
+    // Commanded positions and velocities of one control tick
+    struct JointState {
+        uint32_t tick;                  // control loop writes since start
+        uint32_t appliedSequence;       // JointFrame sequence the tick was computed from
+        int64_t stampUs;
+        int32_t positions[NUM_SERVOS];  // centi-degrees
+        int32_t velocities[NUM_SERVOS]; // centi-degrees / s
+    };
+
+    // Complete set of joint targets, handed over as a whole
+    struct JointFrame {
+        uint32_t sequence;
+        int64_t arrivalUs;           // hal::nowUs() when the command arrived
+        int32_t targets[NUM_SERVOS]; // centi-degrees
+        uint8_t cartesianMask;       // bit n: leg n follows feet[] instead of targets[]
+        int32_t feet[NUM_LEGS * kinematics::LEG_JOINTS]; // micrometers, x/y/z per leg
+    };
+
+    // Latest joint state of the control loop (single reader task, never blocks the loop).
+    // Returns false until the loop has produced its first state.
+    bool latestJointState(JointState& out);
 
 private:
+    enum class GaitState : uint8_t { Off, Approach, Running };
+
+    struct GaitCommand {
+        uint32_t sequence;
+        int64_t arrivalUs;
+        bool run;
+        gait::GaitParams params;
+    };
+
     void allServosLoop();           // Neuer gemeinsamer Loop
-    static void taskWrapper(void*); // FreeRTOS Wrapper
+    // Waypoint-Chunk Kommando -> Servo-Task
+    struct WaypointChunk {
+        uint8_t leg;
+        bool replace;
+        uint8_t count;
+        int64_t arrivalUs;
+        trajectory::Waypoint points[MAX_CHUNK_POINTS];
+    };
+
+    void applyGaitCommand(const GaitCommand& cmd);
+    void applyWaypointChunk(const WaypointChunk& chunk, int64_t nowUs);
+    void stopWaypoints();
+    void stopGait();
+    void updateLegGait(size_t leg, int32_t* frame);
+    void writeLegAngles(size_t leg, const int32_t* footUm, int32_t* frame);
+    void publishCommand(int64_t arrivalUs);
+    void publishState(int64_t nowUs, const int32_t* frame);
+    void updateLeg(size_t leg, int64_t nowUs, int32_t* frame);
+    void updateLegCartesian(size_t leg, int64_t nowUs, int32_t* frame);
+    void updateLegWaypoints(size_t leg, int64_t nowUs, int64_t dtUs, int32_t* frame);
+    void followLegTargets(size_t leg, int64_t dtUs, int32_t* frame);
+    void stopStream();
+    void cancelSchedule();
+    void publishPlayoutStats();
+    static void taskWrapper(void*); // Task Wrapper (hal::createTask)
     static const int START_ANGLE = 100;
 
+    // Velocity/acceleration limits of the foot per axis (micrometers);
+    // joint limits and leg geometry come from LegModule
+    static const trajectory::JointLimits FOOT_LIMITS[kinematics::LEG_JOINTS];
+
     ServoDriver* driver;
-    std::atomic<int> current_angles[NUM_SERVOS];
-    std::atomic<int> target_angles[NUM_SERVOS];
+    std::atomic<int> current_angles[NUM_SERVOS]; // centi-degrees
+
+    // Frame-Übergabe Kommando -> Servo-Task
+    TripleBuffer<JointFrame> command_frames;
+    JointFrame command_staging{};       // nur Writer, letzter vollständiger Stand
+    std::atomic<uint32_t> applied_sequence{0};
+    std::atomic<trajectory::ProfileType> profile_type{trajectory::ProfileType::SCurve};
+    std::atomic<uint32_t> loop_rate_hz{DEFAULT_LOOP_RATE_HZ};
+    LoopStats loop_stats;
+    LatencyStats latency_stats;
+    std::atomic<int> control_timer{-1}; // hal::periodicNotify bei neuem Kommando
+    std::atomic<uint32_t> ready_us{0};
+
+    // Zustands-Übergabe Servo-Task -> Service-Task (Joint-State-Publisher)
+    TripleBuffer<JointState> state_frames;
+    std::atomic<bool> state_ready{false};
+    std::atomic<uint32_t> ik_clamped{0};
+    std::atomic<uint32_t> ik_unreachable{0};
+
+    // Gestreamte Frames mit Sender-Zeit -> Playout-Puffer im Servo-Task
+    struct StreamFrame {
+        int32_t targets[NUM_SERVOS];
+        uint32_t senderStampUs;
+        int64_t arrivalUs;
+    };
+    RingQueue<StreamFrame, 16> stream_queue;
+    std::atomic<bool> playout_enabled{JOINT_PLAYOUT_ENABLED != 0};
+    std::atomic<uint32_t> stream_overflows{0};
+    // Seqlock-Kopie der Playout-Statistik für andere Tasks
+    std::atomic<uint32_t> playout_stats_seq{0};
+    PlayoutBuffer::Stats playout_stats_copy{};
+
+    // Zeitgesteuerte Frames -> Servo-Task, dort nach Ausführungszeit einsortiert
+    struct TimedFrame {
+        int32_t targets[NUM_SERVOS];
+        int64_t executeAtUs;
+    };
+    RingQueue<TimedFrame, MAX_SCHEDULED> timed_queue;
+    std::atomic<uint32_t> timed_scheduled{0};
+    std::atomic<uint32_t> timed_late{0};
+    std::atomic<uint32_t> timed_rejected{0};
+    std::atomic<uint32_t> timed_cancelled{0};
+    std::atomic<uint32_t> timed_overflows{0};
+    std::atomic<uint32_t> timed_pending{0};
+    LatencyStats actuation_skew;
+
+    // Waypoint-Chunks, jeder zählt -> Queue; Staging nur Writer (zu groß für den Stack)
+    RingQueue<WaypointChunk, 4> chunk_queue;
+    WaypointChunk chunk_staging{};
+    std::atomic<uint32_t> chunk_overflows{0};
+    std::atomic<uint32_t> waypoint_overflows{0};
+    std::atomic<uint32_t> waypoint_depth[NUM_LEGS] = {};
+
+    // Fast-Path-Frames, direkt im Slot dekodiert -> Servo-Task
+    TripleBuffer<FastSlot> fast_frames;
+    LatencyStats fast_latency;
+
+    // Gait-Übergabe Kommando -> Servo-Task
+    TripleBuffer<GaitCommand> gait_commands;
+    GaitCommand gait_staging{};
+    std::atomic<GaitState> gait_state{GaitState::Off};
+    std::atomic<uint32_t> gait_phase{0};
+
+    // nur vom Servo-Task benutzt
+    int32_t loop_targets[NUM_SERVOS] = {};
+    int64_t pending_arrival_us = 0; // Kommando übernommen, aber noch kein Channel geschrieben
+    int32_t last_frame[NUM_SERVOS] = {};
+    int64_t last_frame_us = 0;
+    uint32_t state_tick = 0;
+    trajectory::LegTrajectory leg_trajectories[NUM_LEGS];
+    uint8_t loop_cartesian_mask = 0;
+    uint8_t joint_plan_stale = 0;  // Ausgabe kam nicht aus der Gelenk-Trajektorie -> neu planen
+    uint8_t foot_plan_valid = 0;   // Fuß-Trajektorie passt zur aktuellen Stellung
+    int32_t loop_feet[NUM_LEGS * kinematics::LEG_JOINTS] = {};
+    int32_t current_feet[NUM_LEGS * kinematics::LEG_JOINTS] = {};
+    trajectory::LegTrajectory foot_trajectories[NUM_LEGS];
+    gait::GaitGenerator gait_generator;
+    int64_t last_gait_us = 0;
+    PlayoutBuffer playout{PLAYOUT_CONFIG, NUM_SERVOS};
+    bool streaming = false;        // Ausgabe kommt aus dem Playout-Puffer
+    bool fast_following = false;   // Ausgabe folgt den Fast-Path-Frames
+    int64_t pending_fast_us = 0;   // Fast-Frame übernommen, aber noch kein Channel geschrieben
+    trajectory::WaypointQueue waypoint_queues[NUM_LEGS];
+    WaypointChunk chunk_in{};
+    uint8_t waypoint_mask = 0;     // Bein n folgt seiner Waypoint-Queue
+    int64_t last_tick_us = 0;
+    TimedFrame schedule[MAX_SCHEDULED] = {}; // aufsteigend nach executeAtUs
+    size_t schedule_count = 0;
+    int64_t armed_wake_us = 0;     // periodicWakeAt für schedule[0] gesetzt
 };
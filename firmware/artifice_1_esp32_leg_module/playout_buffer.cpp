@@ -0,0 +1,133 @@
+#include "playout_buffer.hpp"
+#include <cstring>
+
+PlayoutBuffer::PlayoutBuffer(const Config& config, size_t joints)
+    : cfg(config), num_joints(joints > MAX_JOINTS ? MAX_JOINTS : joints)
+{
+    reset();
+}
+
+void PlayoutBuffer::reset() {
+    first = 0;
+    count = 0;
+    have_clock = false;
+    have_previous = false;
+    jitter_q4 = 0;
+    delay_us = cfg.minDelayUs;
+    last_sample_us = 0;
+    counters = Stats{};
+    counters.delayUs = cfg.minDelayUs;
+    counters.targetDelayUs = cfg.minDelayUs;
+}
+
+void PlayoutBuffer::push(const int32_t* targets, uint32_t senderStampUs, int64_t arrivalUs) {
+    int64_t senderUs;
+    if (!have_clock) {
+        senderUs = senderStampUs;
+        base_transit_us = arrivalUs - senderUs;
+        have_clock = true;
+    } else {
+        // 32-bit Sender-Uhr entpacken, Differenzen überleben den Überlauf
+        senderUs = last_sender_us + static_cast<int32_t>(senderStampUs - last_stamp);
+        if (senderUs <= last_sender_us) return; // doppelt / vertauscht, Tracker lässt das normalerweise nicht durch
+
+        // Interarrival-Jitter nach RFC 3550: J += (|D| - J) / 16
+        int64_t d = (arrivalUs - last_arrival_us) - (senderUs - last_sender_us);
+        if (d < 0) d = -d;
+        if (d > 1000000) d = 1000000;
+        jitter_q4 += static_cast<int32_t>(d) - ((jitter_q4 + 8) >> 4);
+
+        // Schnellster Transit = Basis; langsam nach oben, damit Uhrendrift Sender/Modul nicht wegläuft
+        const int64_t transit = arrivalUs - senderUs;
+        if (transit < base_transit_us) base_transit_us = transit;
+        else base_transit_us += (transit - base_transit_us) / 256;
+    }
+    last_stamp = senderStampUs;
+    last_sender_us = senderUs;
+    last_arrival_us = arrivalUs;
+    ++counters.frames;
+    counters.jitterUs = static_cast<uint32_t>(jitter_q4 >> 4);
+
+    // Zu spät: Abspielzeitpunkt schon vorbei (bis dahin wurde extrapoliert)
+    if (arrivalUs > senderUs + base_transit_us + delay_us) ++counters.late;
+
+    if (count == CAPACITY) {
+        previous = frames[first];
+        have_previous = true;
+        first = (first + 1) % CAPACITY;
+        --count;
+        ++counters.overflows;
+    }
+    Frame& f = frames[(first + count) % CAPACITY];
+    f.senderUs = senderUs;
+    std::memcpy(f.targets, targets, num_joints * sizeof(int32_t));
+    ++count;
+}
+
+void PlayoutBuffer::updateDelay(int64_t nowUs) {
+    int64_t target = static_cast<int64_t>(counters.jitterUs) * cfg.jitterMultiplier;
+    if (target < cfg.minDelayUs) target = cfg.minDelayUs;
+    if (target > cfg.maxDelayUs) target = cfg.maxDelayUs;
+
+    // Verzögerung höchstens 1/16 der verstrichenen Zeit ändern -> Abspieltempo weicht < 7 % ab, kein Sprung
+    const int64_t dt = last_sample_us != 0 ? nowUs - last_sample_us : 0;
+    last_sample_us = nowUs;
+    const int64_t step = dt / 16;
+    if (delay_us < target) delay_us = delay_us + step < target ? delay_us + step : target;
+    else if (delay_us > target) delay_us = delay_us - step > target ? delay_us - step : target;
+
+    counters.delayUs = static_cast<uint32_t>(delay_us);
+    counters.targetDelayUs = static_cast<uint32_t>(target);
+}
+
+PlayoutBuffer::Output PlayoutBuffer::sample(int64_t nowUs, int32_t* out) {
+    if (count == 0) return Output::Empty;
+    updateDelay(nowUs);
+
+    // Abspielpunkt in Sender-Zeit
+    const int64_t play = nowUs - base_transit_us - delay_us;
+
+    // Abgespielte Frames verwerfen, der letzte davor bleibt für die Extrapolation
+    while (count >= 2 && at(1).senderUs <= play) {
+        previous = frames[first];
+        have_previous = true;
+        first = (first + 1) % CAPACITY;
+        --count;
+    }
+
+    const Frame& a = at(0);
+    if (play < a.senderUs) {
+        std::memcpy(out, a.targets, num_joints * sizeof(int32_t));
+        return Output::Waiting;
+    }
+
+    if (count >= 2) {
+        const Frame& b = at(1);
+        const int64_t span = b.senderUs - a.senderUs;
+        const int64_t t = play - a.senderUs;
+        for (size_t i = 0; i < num_joints; ++i) {
+            out[i] = a.targets[i] + static_cast<int32_t>((static_cast<int64_t>(b.targets[i] - a.targets[i]) * t) / span);
+        }
+        return Output::Interpolated;
+    }
+
+    // Nächster Frame fehlt: kurz linear weiter, dann halten
+    int64_t beyond = play - a.senderUs;
+    Output result = Output::Extrapolated;
+    if (beyond > cfg.maxExtrapolationUs) {
+        beyond = cfg.maxExtrapolationUs;
+        result = Output::Held;
+    }
+    if (!have_previous || beyond == 0) {
+        std::memcpy(out, a.targets, num_joints * sizeof(int32_t));
+    } else {
+        const int64_t span = a.senderUs - previous.senderUs;
+        for (size_t i = 0; i < num_joints; ++i) {
+            out[i] = a.targets[i] +
+                     static_cast<int32_t>((static_cast<int64_t>(a.targets[i] - previous.targets[i]) * beyond) / span);
+        }
+    }
+    if (result == Output::Held) ++counters.held;
+    else ++counters.extrapolated;
+    return result;
+}
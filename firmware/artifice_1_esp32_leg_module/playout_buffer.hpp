@@ -0,0 +1,79 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// Adaptive playout (jitter) buffer for a streamed joint target sequence. Frames carry the sender clock;
+// the buffer estimates the transit time and its jitter (RFC 3550 style), plays the stream out with a small
+// adaptive delay and interpolates between the buffered frames. If the next frame is late it extrapolates from
+// the last two frames for at most maxExtrapolationUs and then holds. Owned by the control task.
+class PlayoutBuffer {
+public:
+    static const size_t MAX_JOINTS = 24;
+    static const size_t CAPACITY = 8;
+
+    struct Config {
+        uint32_t minDelayUs;         // never play out earlier than this behind the fastest frame
+        uint32_t maxDelayUs;         // upper bound of the added latency
+        uint32_t maxExtrapolationUs; // beyond the newest frame, then hold
+        uint32_t jitterMultiplier;   // target delay = multiplier * jitter estimate
+    };
+
+    enum class Output : uint8_t {
+        Empty,        // no frame yet, out untouched
+        Waiting,      // playout point before the oldest frame, holding it
+        Interpolated,
+        Extrapolated, // late frame, linear from the last two
+        Held          // late beyond maxExtrapolationUs
+    };
+
+    struct Stats {
+        uint32_t delayUs;        // currently applied playout delay (added latency on top of the transit)
+        uint32_t targetDelayUs;  // where the delay is heading
+        uint32_t jitterUs;       // interarrival jitter estimate
+        uint32_t frames;         // frames pushed since reset
+        uint32_t late;           // frames that arrived after their playout point
+        uint32_t extrapolated;   // output ticks
+        uint32_t held;           // output ticks
+        uint32_t overflows;      // oldest frame dropped because the buffer was full
+    };
+
+    PlayoutBuffer(const Config& config, size_t joints);
+
+    // Forget all frames and the clock estimate (stream restarted / other command source took over)
+    void reset();
+    bool empty() const { return count == 0; }
+
+    // senderStampUs: sender clock (low 32 bit), arrivalUs: local clock when the frame arrived
+    void push(const int32_t* targets, uint32_t senderStampUs, int64_t arrivalUs);
+    // Targets at local time nowUs
+    Output sample(int64_t nowUs, int32_t* out);
+
+    Stats stats() const { return counters; }
+
+private:
+    struct Frame {
+        int64_t senderUs; // entpackte Sender-Zeit
+        int32_t targets[MAX_JOINTS];
+    };
+
+    const Frame& at(size_t i) const { return frames[(first + i) % CAPACITY]; }
+    void updateDelay(int64_t nowUs);
+
+    Config cfg;
+    size_t num_joints;
+    Frame frames[CAPACITY];
+    size_t first = 0;
+    size_t count = 0;
+    Frame previous{};            // zuletzt abgespielter Frame, Stützpunkt der Extrapolation
+    bool have_previous = false;
+
+    bool have_clock = false;
+    uint32_t last_stamp = 0;
+    int64_t last_sender_us = 0;
+    int64_t last_arrival_us = 0;
+    int64_t base_transit_us = 0; // schnellster Transit, folgt langsam der Uhrendrift
+    int32_t jitter_q4 = 0;       // Jitter * 16
+    int64_t delay_us = 0;
+    int64_t last_sample_us = 0;
+    Stats counters{};
+};
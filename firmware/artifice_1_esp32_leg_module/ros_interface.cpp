@@ -1,100 +1,591 @@
 #include "ros_interface.hpp"
 #include "motion_controller.hpp"
+#include "hal.hpp"
+#include "logger.hpp"
+#include "task_layout.hpp"
+#include "trace.hpp"
+#include "transport.hpp"
+#include <rcutils/allocator.h>
+#include <rmw_microros/rmw_microros.h>
+#include <uxr/client/transport.h>
 #include <cstdio>
+#include <cstring>
 
 // Makros für Fehlerbehandlung
-#define RCCHECK(fn) { rcl_ret_t temp_rc = fn; if(temp_rc != RCL_RET_OK){printf("Failed on line %d: %d\n",__LINE__,(int)temp_rc); vTaskDelete(nullptr);}}
-#define RCSOFTCHECK(fn) { rcl_ret_t temp_rc = fn; if(temp_rc != RCL_RET_OK){printf("Soft fail on line %d: %d\n",__LINE__,(int)temp_rc);}}
+#define RCRETURN(fn) { rcl_ret_t temp_rc = fn; if(temp_rc != RCL_RET_OK){LOG_E("Failed on line %d: %d",__LINE__,(int)temp_rc); return false;}}
+#define RCSOFTCHECK(fn) { rcl_ret_t temp_rc = fn; if(temp_rc != RCL_RET_OK){LOG_E("Soft fail on line %d: %d",__LINE__,(int)temp_rc);}}
 
 RosInterface* RosInterface::globalInstance = nullptr;
 
+namespace {
+
+// rcl/rclc/rmw-Speicher aus einem statischen Puffer, nach initialize() eingefroren
+alignas(8) uint8_t rcl_arena_buffer[RCL_ARENA_BYTES];
+StaticArena rcl_arena(rcl_arena_buffer, sizeof(rcl_arena_buffer));
+
+void* arenaAllocate(size_t size, void*) { return rcl_arena.allocate(size); }
+void arenaDeallocate(void* ptr, void*) { rcl_arena.deallocate(ptr); }
+void* arenaReallocate(void* ptr, size_t size, void*) { return rcl_arena.reallocate(ptr, size); }
+void* arenaZeroAllocate(size_t count, size_t size, void*) { return rcl_arena.zeroAllocate(count, size); }
+
+// XRCE-Session -> gewählter Transport-Backend (transport.hpp)
+bool transportOpen(uxrCustomTransport*) { return transport::open(); }
+bool transportClose(uxrCustomTransport*) { transport::close(); return true; }
+size_t transportWrite(uxrCustomTransport*, const uint8_t* buf, size_t len, uint8_t* err) {
+    const size_t n = transport::write(buf, len);
+    if(n == 0) *err = 1;
+    return n;
+}
+size_t transportRead(uxrCustomTransport*, uint8_t* buf, size_t len, int timeout, uint8_t* err) {
+    (void)err; // Timeout ist kein Fehler
+    return transport::read(buf, len, timeout);
+}
+
+// Antwort des Agents höchstens bis zum nächsten Slot abwarten (mindestens 1 ms)
+int agentTimeoutMs(uint32_t maxUs) {
+    uint32_t timeout_ms = maxUs / 1000;
+    if(timeout_ms < 1) timeout_ms = 1;
+    if(timeout_ms > RosInterface::AGENT_PING_TIMEOUT_MS) timeout_ms = RosInterface::AGENT_PING_TIMEOUT_MS;
+    return static_cast<int>(timeout_ms);
+}
+
+// Stack-Reserve des Service-Tasks nach rclc-Setup / -Abbau (0 = nicht messbar)
+uint32_t serviceStackFree() {
+    uint32_t bytes = 0;
+    return hal::taskStackFreeMin(task_layout::SERVICE.name, bytes) ? bytes : 0;
+}
+
+#if COMMAND_LOG_BYTES > 0
+// Mitschnitt der Kommando-Frames, ein Fenster bis der Puffer voll ist
+uint8_t command_log_storage[COMMAND_LOG_BYTES];
+command_log::Recorder command_recorder(command_log_storage, sizeof(command_log_storage));
+#endif
+
+} // namespace
+
+StaticArena::Stats RosInterface::allocatorStats() {
+    return rcl_arena.stats();
+}
+
 RosInterface::RosInterface(MotionController* controller)
-    : motionController(controller)
+    : motionController(controller), router(controller)
 {
     globalInstance = this;
+    router.setClock(&clock_sync);
+#if COMMAND_LOG_BYTES > 0
+    router.setRecorder(&command_recorder);
+#endif
 }
 
 RosInterface::~RosInterface() {
-    cleanup();
+    destroyEntities();
 }
 
 void RosInterface::initialize() {
-    allocator = rcl_get_default_allocator();
-    RCCHECK(rclc_support_init(&support, 0, nullptr, &allocator));
+    // Arena-Allocator auch als rcutils-Default, damit rcl/rmw-interne Allokationen nicht auf den Heap gehen
+    allocator = rcutils_get_zero_initialized_allocator();
+    allocator.allocate = arenaAllocate;
+    allocator.deallocate = arenaDeallocate;
+    allocator.reallocate = arenaReallocate;
+    allocator.zero_allocate = arenaZeroAllocate;
+    allocator.state = nullptr;
+    if(!rcutils_set_default_allocator(&allocator)) LOG_E("Failed to set default allocator");
+
+    // Empfangs-/Sendepuffer statisch (kein allocate), überleben jeden Reconnect
+    cmd_msg.data.data = cmd_buffer;
+    cmd_msg.data.capacity = sizeof(cmd_buffer);
+    cmd_msg.data.size = 0;
+    foot_msg.data.data = foot_buffer;
+    foot_msg.data.capacity = sizeof(foot_buffer);
+    foot_msg.data.size = 0;
+    gait_msg.data.data = gait_buffer;
+    gait_msg.data.capacity = sizeof(gait_buffer);
+    gait_msg.data.size = 0;
+    trajectory_msg.data.data = trajectory_buffer;
+    trajectory_msg.data.capacity = sizeof(trajectory_buffer);
+    trajectory_msg.data.size = 0;
+    log_msg.data.data = log_msg_buffer;
+    log_msg.data.capacity = sizeof(log_msg_buffer);
+    log_msg.data.size = 0;
+    joint_state_msg.data.data = joint_state_buffer;
+    joint_state_msg.data.capacity = sizeof(joint_state_buffer);
+    joint_state_msg.data.size = 0;
+    command_log_msg.data.data = command_log_buffer;
+    command_log_msg.data.capacity = sizeof(command_log_buffer);
+    command_log_msg.data.size = 0;
+    trace_msg.data.data = trace_buffer;
+    trace_msg.data.capacity = sizeof(trace_buffer);
+    trace_msg.data.size = 0;
+
+    // Transport explizit statt aus der micro-ROS-Buildkonfiguration (RMW_UXRCE_TRANSPORT=custom)
+    const transport::Backend* backend = transport::active();
+    if(!backend) {
+        LOG_E("transport %u not available on this platform", static_cast<unsigned>(transport::config().kind));
+    } else if(rmw_uros_set_custom_transport(backend->framed, nullptr, transportOpen, transportClose,
+                                            transportWrite, transportRead) != RMW_RET_OK) {
+        LOG_E("Failed to register custom transport");
+    }
+
+    // Agent wird im Hintergrund gesucht (spinTransport), Servos laufen schon
+    link_state.store(LinkState::WaitingForAgent);
+    next_ping_us = hal::nowUs();
+    retry_us = AGENT_RETRY_MIN_US;
+    LOG_L("waiting for micro-ROS agent");
+}
+
+bool RosInterface::createEntities() {
+    created_entities = 0;
+    RCRETURN(rclc_support_init(&support, 0, nullptr, &allocator));
+    ++created_entities;
 
     // Node erstellen
-    RCCHECK(rclc_node_init_default(&node, "servo_subscriber_cpp", "", &support));
-    printf("Node created successfully\n");
+    RCRETURN(rclc_node_init_default(&node, "servo_subscriber_cpp", "", &support));
+    ++created_entities;
+
+    // Eine Subscription für das ganze Modul: /leg/<id>/cmd_joint_positions
+    char cmd_topic[48];
+    snprintf(cmd_topic, sizeof(cmd_topic), "/leg/%d/cmd_joint_positions", LEG_MODULE_ID);
+    RCRETURN(rclc_subscription_init_default(
+        &subscriber_cmd,
+        &node,
+        ROSIDL_GET_MSG_TYPE_SUPPORT(std_msgs, msg, UInt8MultiArray),
+        cmd_topic));
+    ++created_entities;
+
+    // Fußziele je Bein: /leg/<id>/cmd_foot_positions
+    char foot_topic[48];
+    snprintf(foot_topic, sizeof(foot_topic), "/leg/%d/cmd_foot_positions", LEG_MODULE_ID);
+    RCRETURN(rclc_subscription_init_default(
+        &subscriber_foot,
+        &node,
+        ROSIDL_GET_MSG_TYPE_SUPPORT(std_msgs, msg, UInt8MultiArray),
+        foot_topic));
+    ++created_entities;
 
-    // Speicher für Nachrichten initialisieren
-    msg_left.data.capacity = 10;
-    msg_left.data.data = (int32_t*) allocator.allocate(sizeof(int32_t) * msg_left.data.capacity, allocator.state);
-    msg_left.data.size = 0;
+    // Gait: /leg/<id>/cmd_gait, Parameter und Start/Stopp
+    char gait_topic[32];
+    snprintf(gait_topic, sizeof(gait_topic), "/leg/%d/cmd_gait", LEG_MODULE_ID);
+    RCRETURN(rclc_subscription_init_default(
+        &subscriber_gait,
+        &node,
+        ROSIDL_GET_MSG_TYPE_SUPPORT(std_msgs, msg, UInt8MultiArray),
+        gait_topic));
+    ++created_entities;
 
-    msg_right.data.capacity = 10;
-    msg_right.data.data = (int32_t*) allocator.allocate(sizeof(int32_t) * msg_right.data.capacity, allocator.state);
-    msg_right.data.size = 0;
+    // Trajektorien-Chunks: /leg/<id>/cmd_trajectory, Waypoints je Bein mit Zeitstempel
+    char trajectory_topic[40];
+    snprintf(trajectory_topic, sizeof(trajectory_topic), "/leg/%d/cmd_trajectory", LEG_MODULE_ID);
+    RCRETURN(rclc_subscription_init_default(
+        &subscriber_trajectory,
+        &node,
+        ROSIDL_GET_MSG_TYPE_SUPPORT(std_msgs, msg, UInt8MultiArray),
+        trajectory_topic));
+    ++created_entities;
 
-    // Subscriptions erstellen
-    RCCHECK(rclc_subscription_init_default(
-        &subscriber_left,
+    // Log-Publisher: /leg/<id>/log, best effort
+    char log_topic[32];
+    snprintf(log_topic, sizeof(log_topic), "/leg/%d/log", LEG_MODULE_ID);
+    RCRETURN(rclc_publisher_init_best_effort(
+        &log_publisher,
         &node,
-        ROSIDL_GET_MSG_TYPE_SUPPORT(std_msgs, msg, Int32MultiArray),
-        "/left/angles"));
+        ROSIDL_GET_MSG_TYPE_SUPPORT(std_msgs, msg, String),
+        log_topic));
+    ++created_entities;
 
-    RCCHECK(rclc_subscription_init_default(
-        &subscriber_right,
+    // Joint-State-Publisher: /leg/<id>/joint_states, best effort, ein Frame für beide Beine
+    char state_topic[40];
+    snprintf(state_topic, sizeof(state_topic), "/leg/%d/joint_states", LEG_MODULE_ID);
+    RCRETURN(rclc_publisher_init_best_effort(
+        &joint_state_publisher,
         &node,
-        ROSIDL_GET_MSG_TYPE_SUPPORT(std_msgs, msg, Int32MultiArray),
-        "/right/angles"));
-
-    // Executor erstellen und Subscriptions hinzufügen
-    RCCHECK(rclc_executor_init(&executor, &support.context, 2, &allocator));
-    RCCHECK(rclc_executor_add_subscription(&executor, &subscriber_left, &msg_left,
-        &RosInterface::static_left_callback, ON_NEW_DATA));
-    RCCHECK(rclc_executor_add_subscription(&executor, &subscriber_right, &msg_right,
-        &RosInterface::static_right_callback, ON_NEW_DATA));
-}
-
-void RosInterface::spin() {
-    while(true) {
-        // print a message every 10 seconds to show that we are alive
-        static int counter = 0;
-        if (++counter % 200 == 0) {
-            printf("Ros Interface alive\n");
-            counter = 0;
+        ROSIDL_GET_MSG_TYPE_SUPPORT(std_msgs, msg, UInt8MultiArray),
+        state_topic));
+    ++created_entities;
+
+    // Kommando-Mitschnitt: /leg/<id>/command_log, reliable, damit kein Chunk fehlt
+    char command_log_topic[40];
+    snprintf(command_log_topic, sizeof(command_log_topic), "/leg/%d/command_log", LEG_MODULE_ID);
+    RCRETURN(rclc_publisher_init_default(
+        &command_log_publisher,
+        &node,
+        ROSIDL_GET_MSG_TYPE_SUPPORT(std_msgs, msg, UInt8MultiArray),
+        command_log_topic));
+    ++created_entities;
+
+#if TRACE_ENABLED
+    // Trace-Abbild: /leg/<id>/trace, reliable wie der Mitschnitt (eigener Zähler, nur mit TRACE_ENABLED)
+    char trace_topic[32];
+    snprintf(trace_topic, sizeof(trace_topic), "/leg/%d/trace", LEG_MODULE_ID);
+    RCRETURN(rclc_publisher_init_default(
+        &trace_publisher,
+        &node,
+        ROSIDL_GET_MSG_TYPE_SUPPORT(std_msgs, msg, UInt8MultiArray),
+        trace_topic));
+    trace_publisher_created = true;
+#endif
+
+    setJointStateRateHz(joint_state_rate_hz.load());
+    applied_joint_state_rate_hz = joint_state_rate_hz.load();
+    RCRETURN(rclc_timer_init_default(&joint_state_timer, &support,
+        RCL_MS_TO_NS(1000) / applied_joint_state_rate_hz, &RosInterface::static_joint_state_timer));
+    ++created_entities;
+
+    // Executor erstellen: Gelenk-, Fuß-, Gait- und Trajektorien-Kommandos + Joint-State-Timer
+    RCRETURN(rclc_executor_init(&executor, &support.context, 5, &allocator));
+    ++created_entities;
+    RCRETURN(rclc_executor_add_subscription(&executor, &subscriber_cmd, &cmd_msg,
+        &RosInterface::static_command_callback, ON_NEW_DATA));
+    RCRETURN(rclc_executor_add_subscription(&executor, &subscriber_foot, &foot_msg,
+        &RosInterface::static_foot_callback, ON_NEW_DATA));
+    RCRETURN(rclc_executor_add_subscription(&executor, &subscriber_gait, &gait_msg,
+        &RosInterface::static_gait_callback, ON_NEW_DATA));
+    RCRETURN(rclc_executor_add_subscription(&executor, &subscriber_trajectory, &trajectory_msg,
+        &RosInterface::static_trajectory_callback, ON_NEW_DATA));
+    RCRETURN(rclc_executor_add_timer(&executor, &joint_state_timer));
+    // Wait-Set jetzt anlegen statt beim ersten spin, danach darf nichts mehr allokiert werden
+    RCRETURN(rclc_executor_prepare(&executor));
+    // Callbacks laufen, sobald irgendein Handle Daten hat
+    RCRETURN(rclc_executor_set_trigger(&executor, rclc_executor_trigger_any, nullptr));
+    rcl_arena.freeze();
+    StaticArena::Stats arena = rcl_arena.stats();
+    LOG_L("rcl arena frozen: %u of %u bytes, %u allocations", arena.used, arena.capacity, arena.allocations);
+    return true;
+}
+
+void RosInterface::destroyEntities() {
+    logger::setPublishHook(nullptr);
+    // Session ist evtl. schon weg: nicht auf Antworten des Agents warten
+    if(created_entities > 0) {
+        rmw_context_t* rmw_context = rcl_context_get_rmw_context(&support.context);
+        if(rmw_context) rmw_uros_set_context_entity_destroy_session_timeout(rmw_context, 0);
+    }
+    // Umgekehrte Reihenfolge, nur was angelegt wurde; Fehler sind hier erwartet
+    if(created_entities >= 11) rclc_executor_fini(&executor);
+    if(created_entities >= 10) (void)rcl_timer_fini(&joint_state_timer);
+    if(trace_publisher_created) (void)rcl_publisher_fini(&trace_publisher, &node);
+    if(created_entities >= 9) (void)rcl_publisher_fini(&command_log_publisher, &node);
+    if(created_entities >= 8) (void)rcl_publisher_fini(&joint_state_publisher, &node);
+    if(created_entities >= 7) (void)rcl_publisher_fini(&log_publisher, &node);
+    if(created_entities >= 6) (void)rcl_subscription_fini(&subscriber_trajectory, &node);
+    if(created_entities >= 5) (void)rcl_subscription_fini(&subscriber_gait, &node);
+    if(created_entities >= 4) (void)rcl_subscription_fini(&subscriber_foot, &node);
+    if(created_entities >= 3) (void)rcl_subscription_fini(&subscriber_cmd, &node);
+    if(created_entities >= 2) (void)rcl_node_fini(&node);
+    if(created_entities >= 1) (void)rclc_support_fini(&support);
+    created_entities = 0;
+    trace_publisher_created = false;
+
+    // Handles für das nächste Anlegen zurücksetzen, Arena ist wieder leer
+    executor = rclc_executor_get_zero_initialized_executor();
+    joint_state_timer = rcl_get_zero_initialized_timer();
+    trace_publisher = rcl_get_zero_initialized_publisher();
+    command_log_publisher = rcl_get_zero_initialized_publisher();
+    joint_state_publisher = rcl_get_zero_initialized_publisher();
+    log_publisher = rcl_get_zero_initialized_publisher();
+    subscriber_trajectory = rcl_get_zero_initialized_subscription();
+    subscriber_gait = rcl_get_zero_initialized_subscription();
+    subscriber_foot = rcl_get_zero_initialized_subscription();
+    subscriber_cmd = rcl_get_zero_initialized_subscription();
+    node = rcl_get_zero_initialized_node();
+    support = rclc_support_t{};
+    rcl_arena.reset();
+    command_log_offset = 0;
+    // Abgebrochener Trace-Upload: weiter aufzeichnen, nach dem Reconnect kommt ein neues Abbild
+    if(trace_uploading) {
+        trace_uploading = false;
+        trace::setRecording(true);
+    }
+}
+
+bool RosInterface::pingAgent(uint32_t maxUs) {
+    return rmw_uros_ping_agent(agentTimeoutMs(maxUs), 1) == RMW_RET_OK;
+}
+
+void RosInterface::syncClock(uint32_t maxUs) {
+    // XRCE-Zeitabgleich (NTP-artig über den Mittelpunkt des Round Trips), danach gilt der Session-Offset
+    const int64_t before = hal::nowUs();
+    if(rmw_uros_sync_session(agentTimeoutMs(maxUs)) != RMW_RET_OK) {
+        clock_sync.countFailure();
+        return;
+    }
+    // Agent-Zeit und Modul-Uhr im selben Moment lesen, Round Trip bewertet die Güte des Samples
+    const int64_t agent_us = rmw_uros_epoch_nanos() / 1000;
+    const int64_t module_us = hal::nowUs();
+    clock_sync.addSample(module_us, agent_us, static_cast<uint32_t>(module_us - before));
+    ++session_sync_samples;
+}
+
+void RosInterface::onConnected() {
+    const int64_t now = hal::nowUs();
+    link_state.store(LinkState::Connected);
+    logger::setPublishHook(&RosInterface::static_log_hook);
+    // Sender hat evtl. neu gestartet, nächster Frame je Stream wird ohne Sequenz-Prüfung übernommen
+    router.resync();
+    missed_pings = 0;
+    next_ping_us = now + AGENT_PING_PERIOD_US;
+    retry_us = AGENT_RETRY_MIN_US;
+    next_trace_dump_us = now + static_cast<int64_t>(TRACE_DUMP_PERIOD_MS) * 1000;
+    // Agent evtl. neu gestartet: gleich wieder abgleichen, die bisherige Schätzung gilt bis dahin weiter
+    next_clock_sync_us = now;
+    session_sync_samples = 0;
+    if(connects.fetch_add(1) == 0) {
+        ready_us.store(static_cast<uint32_t>(now));
+        LOG_L("micro-ROS agent connected %u us after boot, stack min free %u bytes", static_cast<uint32_t>(now),
+              serviceStackFree());
+    } else {
+        const uint32_t reconnect = static_cast<uint32_t>(now - lost_at_us);
+        last_reconnect_us.store(reconnect);
+        if(reconnect > max_reconnect_us.load()) max_reconnect_us.store(reconnect);
+        LOG_L("micro-ROS agent reconnected after %u us, stack min free %u bytes", reconnect, serviceStackFree());
+    }
+}
+
+void RosInterface::onAgentLost() {
+    LOG_E("micro-ROS agent lost, entities destroyed, searching again");
+    lost_at_us = hal::nowUs();
+    disconnects.fetch_add(1);
+    destroyEntities();
+    link_state.store(LinkState::WaitingForAgent);
+    next_ping_us = lost_at_us; // sofort wieder suchen
+    retry_us = AGENT_RETRY_MIN_US;
+}
+
+RosInterface::ConnectionStats RosInterface::connectionStats() const {
+    return {link_state.load(), connects.load(), disconnects.load(), failed_setups.load(), ready_us.load(),
+            last_reconnect_us.load(), max_reconnect_us.load()};
+}
+
+void RosInterface::spinTransport(uint32_t maxUs) {
+    const int64_t now = hal::nowUs();
+    if(link_state.load() == LinkState::Connected) {
+        // Agent regelmäßig anpingen, der Executor allein merkt einen weggefallenen Agent nicht
+        if(now >= next_ping_us) {
+            next_ping_us = now + AGENT_PING_PERIOD_US;
+            if(pingAgent(maxUs)) {
+                missed_pings = 0;
+            } else if(++missed_pings >= AGENT_MISSED_PINGS) {
+                onAgentLost();
+            }
+            return;
         }
-        rclc_executor_spin_some(&executor, RCL_MS_TO_NS(50));
-        vTaskDelay(pdMS_TO_TICKS(50));
+        // Uhrabgleich: die ersten Samples einer Session schnell hintereinander, dann im ruhigen Takt für die Drift
+        if(CLOCK_SYNC_PERIOD_MS > 0 && now >= next_clock_sync_us) {
+            next_clock_sync_us = now + (session_sync_samples < CLOCK_SYNC_FAST_SAMPLES
+                ? CLOCK_SYNC_FAST_PERIOD_US : static_cast<int64_t>(CLOCK_SYNC_PERIOD_MS) * 1000);
+            syncClock(maxUs);
+            return;
+        }
+        // Blockiert im Transport, bis ein Sample ankommt oder der nächste Slot fällig ist;
+        // der Callback läuft sofort, kein fester Sleep
+        TRACE_EVENT(ExecutorBegin, 0);
+        rclc_executor_spin_some(&executor, static_cast<uint64_t>(maxUs) * 1000);
+        TRACE_EVENT(ExecutorEnd, 0);
+        return;
     }
+
+    // Kein Agent: im Backoff-Takt pingen, dazwischen schlafen (Slots und Control-Loop laufen weiter)
+    if(now < next_ping_us) {
+        const int64_t wait = next_ping_us - now < maxUs ? next_ping_us - now : maxUs;
+        if(wait >= 1000) hal::delayMs(static_cast<uint32_t>(wait / 1000));
+        return;
+    }
+    if(!pingAgent(maxUs)) {
+        next_ping_us = now + retry_us;
+        retry_us = retry_us * 2 < AGENT_RETRY_MAX_US ? retry_us * 2 : AGENT_RETRY_MAX_US;
+        return;
+    }
+    // Agent antwortet: alle Entities neu anlegen (beim ersten Mal und nach jedem Verlust)
+    if(!createEntities()) {
+        failed_setups.fetch_add(1);
+        destroyEntities();
+        next_ping_us = hal::nowUs() + retry_us;
+        retry_us = retry_us * 2 < AGENT_RETRY_MAX_US ? retry_us * 2 : AGENT_RETRY_MAX_US;
+        return;
+    }
+    onConnected();
 }
 
-void RosInterface::cleanup() {
-    rclc_executor_fini(&executor);
-    RCCHECK(rcl_subscription_fini(&subscriber_left, &node));
-    RCCHECK(rcl_subscription_fini(&subscriber_right, &node));
-    RCCHECK(rcl_node_fini(&node));
+void RosInterface::service() {
+    // Ohne Agent nichts publizieren; Log-Zeilen gehen weiter über UART
+    if(!connected()) return;
+    publishLogLines();
+    applyJointStateRate();
+    publishCommandLog();
+    publishTrace();
+}
 
-    if(msg_left.data.data) allocator.deallocate(msg_left.data.data, allocator.state);
-    if(msg_right.data.data) allocator.deallocate(msg_right.data.data, allocator.state);
+void RosInterface::publishCommandLog() {
+#if COMMAND_LOG_BYTES > 0
+    // Erst hochladen, wenn das Fenster voll ist; ein Chunk pro Aufruf, danach neues Fenster
+    if(!command_recorder.full()) return;
+    const size_t total = command_recorder.size();
+    size_t n = total - command_log_offset;
+    if(n > COMMAND_LOG_CHUNK_BYTES) n = COMMAND_LOG_CHUNK_BYTES;
+    command_log::ChunkHeader header{static_cast<uint32_t>(command_log_offset), static_cast<uint32_t>(total)};
+    memcpy(command_log_buffer, &header, sizeof(header));
+    memcpy(command_log_buffer + sizeof(header), command_recorder.data() + command_log_offset, n);
+    command_log_msg.data.size = sizeof(header) + n;
+    if(rcl_publish(&command_log_publisher, &command_log_msg, nullptr) != RCL_RET_OK) return; // nächster Slot
+    command_log_offset += n;
+    if(command_log_offset >= total) {
+        LOG_L("command log uploaded: %u bytes, %u frames not captured", static_cast<unsigned>(total),
+              command_recorder.droppedCount());
+        command_log_offset = 0;
+        command_recorder.clear();
+    }
+#endif
 }
 
-void RosInterface::static_left_callback(const void* msgin) {
-    const std_msgs__msg__Int32MultiArray* msg = static_cast<const std_msgs__msg__Int32MultiArray*>(msgin);
-    if(!msg || msg->data.size == 0) return;
+void RosInterface::publishTrace() {
+#if TRACE_ENABLED
+    // Periodisch oder auf Anforderung: Aufzeichnung anhalten, Abbild in Chunks hochladen, dann neu beginnen
+    const int64_t now = hal::nowUs();
+    if(!trace_uploading) {
+        const bool due = TRACE_DUMP_PERIOD_MS > 0 && now >= next_trace_dump_us;
+        if(!trace_dump_requested.exchange(false) && !due) return;
+        trace::setRecording(false);
+        trace_uploading = true;
+        trace_offset = 0;
+    }
+    const size_t total = trace::dumpBytes();
+    command_log::ChunkHeader header{static_cast<uint32_t>(trace_offset), static_cast<uint32_t>(total)};
+    memcpy(trace_buffer, &header, sizeof(header));
+    const size_t n = trace::copy(trace_offset, trace_buffer + sizeof(header), TRACE_CHUNK_BYTES);
+    trace_msg.data.size = sizeof(header) + n;
+    if(rcl_publish(&trace_publisher, &trace_msg, nullptr) != RCL_RET_OK) return; // nächster Slot
+    trace_offset += n;
+    if(trace_offset >= total) {
+        trace_uploading = false;
+        trace::clear();
+        trace::setRecording(true);
+        next_trace_dump_us = now + static_cast<int64_t>(TRACE_DUMP_PERIOD_MS) * 1000;
+    }
+#endif
+}
 
-    for(size_t i = 0; i < MotionController::NUM_SERVOS/2 && i < msg->data.size; ++i) {
-        if(globalInstance && globalInstance->motionController)
-            globalInstance->motionController->setTargetAngle(static_cast<int>(msg->data.data[i]), i);
+void RosInterface::reportHealth() {
+    ConnectionStats c = connectionStats();
+    if(c.state == LinkState::Connected) {
+        LOG_L("agent connected: sessions %u, lost %u, failed setups %u", c.connects, c.disconnects, c.failedSetups);
+    } else {
+        LOG_E("agent not connected: sessions %u, lost %u, failed setups %u", c.connects, c.disconnects, c.failedSetups);
+    }
+    if(c.connects > 1) LOG_L("agent reconnect last %u us, max %u us", c.lastReconnectUs, c.maxReconnectUs);
+    CommandTracker::Stats s = commandStats();
+    LOG_L("Ros Interface alive: commands %u, dropped %u, stale %u, malformed %u",
+          s.accepted, s.dropped, s.stale, s.malformed);
+    CommandTracker::Stats f = footCommandStats();
+    LOG_L("foot commands %u, dropped %u, stale %u, malformed %u", f.accepted, f.dropped, f.stale, f.malformed);
+    CommandTracker::Stats g = gaitCommandStats();
+    LOG_L("gait commands %u, stale %u, malformed %u", g.accepted, g.stale, g.malformed);
+    CommandTracker::Stats t = trajectoryStats();
+    LOG_L("trajectory chunks %u, dropped %u, stale %u, malformed %u", t.accepted, t.dropped, t.stale, t.malformed);
+    ClockSync::Stats cs = clock_sync.stats();
+    if(cs.synced) {
+        // Offset ist eine Epoch-Zeit: in s + us aufteilen, damit er in die 32-bit-Argumente passt
+        LOG_L("clock sync: offset %u s + %u us, drift %d ppb, residual %u us",
+              static_cast<uint32_t>(cs.offsetUs / 1000000), static_cast<uint32_t>(cs.offsetUs % 1000000),
+              cs.driftPpb, cs.residualUs);
+        LOG_L("clock sync: %u samples, %u skipped, rtt last %u min %u us", cs.samples, cs.skipped,
+              cs.lastRttUs, cs.minRttUs);
+    } else if(CLOCK_SYNC_PERIOD_MS > 0) {
+        LOG_E("clock not synced: %u exchanges failed", cs.failures);
+    }
+    if(cs.steps > 0 || router.unsyncedFrames() > 0) {
+        LOG_E("clock sync: %u steps, %u agent-clock frames dropped unsynced", cs.steps, router.unsyncedFrames());
     }
+    transport::Stats ts = transportStats();
+    LOG_L("transport out %u packets / %u bytes, in %u packets / %u bytes",
+          ts.packetsOut, ts.bytesOut, ts.packetsIn, ts.bytesIn);
+    if(ts.writeErrors > 0) LOG_E("transport: %u write errors, %u opens", ts.writeErrors, ts.opens);
+    StaticArena::Stats arena = rcl_arena.stats();
+    LOG_L("rcl arena: %u used, high water %u of %u bytes", arena.used, arena.highWater, arena.capacity);
+    if(arena.afterFreeze > 0 || arena.failed > 0) {
+        LOG_E("rcl arena: %u allocations after init, %u failed", arena.afterFreeze, arena.failed);
+    }
+}
+
+void RosInterface::static_command_callback(const void* msgin) {
+    const std_msgs__msg__UInt8MultiArray* msg = static_cast<const std_msgs__msg__UInt8MultiArray*>(msgin);
+    if(!msg || !globalInstance) return;
+    globalInstance->router.apply(command_log::FrameKind::Joint, msg->data.data, msg->data.size, hal::nowUs());
+}
+
+void RosInterface::static_foot_callback(const void* msgin) {
+    const std_msgs__msg__UInt8MultiArray* msg = static_cast<const std_msgs__msg__UInt8MultiArray*>(msgin);
+    if(!msg || !globalInstance) return;
+    globalInstance->router.apply(command_log::FrameKind::Foot, msg->data.data, msg->data.size, hal::nowUs());
+}
+
+void RosInterface::static_gait_callback(const void* msgin) {
+    const std_msgs__msg__UInt8MultiArray* msg = static_cast<const std_msgs__msg__UInt8MultiArray*>(msgin);
+    if(!msg || !globalInstance) return;
+    globalInstance->router.apply(command_log::FrameKind::Gait, msg->data.data, msg->data.size, hal::nowUs());
+}
+
+void RosInterface::static_trajectory_callback(const void* msgin) {
+    const std_msgs__msg__UInt8MultiArray* msg = static_cast<const std_msgs__msg__UInt8MultiArray*>(msgin);
+    if(!msg || !globalInstance) return;
+    globalInstance->router.apply(command_log::FrameKind::Trajectory, msg->data.data, msg->data.size, hal::nowUs());
+}
+
+void RosInterface::static_log_hook(const char* line, size_t len) {
+    // Läuft mitten im Drain des Loggers: nur in die Outbox legen, publiziert wird danach in service()
+    if(!globalInstance) return;
+    LogLine entry;
+    if(len >= sizeof(entry.text)) len = sizeof(entry.text) - 1;
+    memcpy(entry.text, line, len);
+    entry.text[len] = '\0';
+    entry.len = static_cast<uint8_t>(len);
+    globalInstance->log_outbox.push(entry); // voll -> Zeile geht nur über UART raus
+}
+
+void RosInterface::publishLogLines() {
+    LogLine entry;
+    while(log_outbox.pop(entry)) {
+        memcpy(log_msg_buffer, entry.text, entry.len + 1);
+        log_msg.data.size = entry.len;
+        RCSOFTCHECK(rcl_publish(&log_publisher, &log_msg, nullptr));
+    }
+}
+
+void RosInterface::setJointStateRateHz(uint32_t hz) {
+    if(hz < MIN_JOINT_STATE_RATE_HZ) hz = MIN_JOINT_STATE_RATE_HZ;
+    if(hz > MAX_JOINT_STATE_RATE_HZ) hz = MAX_JOINT_STATE_RATE_HZ;
+    joint_state_rate_hz.store(hz);
+}
+
+void RosInterface::applyJointStateRate() {
+    // Timer gehört dem Service-Task (Executor), neue Rate wird hier übernommen
+    const uint32_t hz = joint_state_rate_hz.load();
+    if(hz == applied_joint_state_rate_hz) return;
+    int64_t old_period = 0;
+    RCSOFTCHECK(rcl_timer_exchange_period(&joint_state_timer, RCL_MS_TO_NS(1000) / hz, &old_period));
+    applied_joint_state_rate_hz = hz;
+}
+
+void RosInterface::static_joint_state_timer(rcl_timer_t* timer, int64_t /*last_call_time*/) {
+    if(!timer || !globalInstance) return;
+    TRACE_EVENT(CallbackBegin, trace::JOINT_STATE_CALLBACK);
+    globalInstance->publishJointState();
+    TRACE_EVENT(CallbackEnd, trace::JOINT_STATE_CALLBACK);
 }
 
-void RosInterface::static_right_callback(const void* msgin) {
-    const std_msgs__msg__Int32MultiArray* msg = static_cast<const std_msgs__msg__Int32MultiArray*>(msgin);
-    if(!msg || msg->data.size == 0) return;
+void RosInterface::publishJointState() {
+    MotionController::JointState state;
+    if(!motionController || !motionController->latestJointState(state)) return;
 
-    for(size_t i = 0; i < MotionController::NUM_SERVOS/2 && i < msg->data.size; ++i) {
-        if(globalInstance && globalInstance->motionController)
-            globalInstance->motionController->setTargetAngle(static_cast<int>(msg->data.data[i]), i+MotionController::NUM_SERVOS/2); //skip first 3 servos
+    JointStateFrame frame;
+    frame.version = JOINT_STATE_VERSION;
+    frame.jointCount = JOINT_STATE_JOINTS;
+    frame.sequence = ++joint_state_sequence;
+    frame.stampUs = static_cast<uint32_t>(state.stampUs);
+    frame.commandSequence = router.lastCommandSequence();
+    for(size_t i = 0; i < JOINT_STATE_JOINTS; ++i) {
+        frame.positions[i] = static_cast<int16_t>(state.positions[i]);
+        // centi-degrees/s -> deci-degrees/s, passt auch bei 400 deg/s in int16
+        frame.velocities[i] = static_cast<int16_t>(state.velocities[i] / 10);
     }
+    joint_state_msg.data.size = encodeJointState(frame, joint_state_buffer, sizeof(joint_state_buffer));
+    RCSOFTCHECK(rcl_publish(&joint_state_publisher, &joint_state_msg, nullptr));
 }
@@ -2,9 +2,54 @@
 #include <rcl/rcl.h>
 #include <rclc/rclc.h>
 #include <rclc/executor.h>
-#include <std_msgs/msg/int32_multi_array.h>
+#include <std_msgs/msg/string.h>
+#include <std_msgs/msg/u_int8_multi_array.h>
 #include <atomic>
+#include "clock_sync.hpp"
+#include "command_log.hpp"
+#include "command_router.hpp"
+#include "joint_state.hpp"
+#include "leg_command.hpp"
+#include "logger.hpp"
 #include "motion_controller.hpp"
+#include "ring_queue.hpp"
+#include "static_arena.hpp"
+#include "trace.hpp"
+#include "transport.hpp"
+
+// Module id used in the /leg/<id>/... topics
+#ifndef LEG_MODULE_ID
+#define LEG_MODULE_ID 0
+#endif
+
+// Static arena for everything rcl/rclc/rmw allocate through the (default) allocator
+#ifndef RCL_ARENA_BYTES
+#define RCL_ARENA_BYTES 16384
+#endif
+
+// Default publish rate of /leg/<id>/joint_states
+#ifndef JOINT_STATE_RATE_HZ
+#define JOINT_STATE_RATE_HZ 50
+#endif
+
+// Capture window for incoming command frames (command_log.hpp), uploaded on /leg/<id>/command_log when full.
+// 0 = no capture
+#ifndef COMMAND_LOG_BYTES
+#define COMMAND_LOG_BYTES 8192
+#endif
+
+// With TRACE_ENABLED the trace rings (trace.hpp) are uploaded on /leg/<id>/trace this often (0 = only on
+// requestTraceDump()); recording pauses while the image is uploaded
+#ifndef TRACE_DUMP_PERIOD_MS
+#define TRACE_DUMP_PERIOD_MS 10000
+#endif
+
+// Clock sync exchanges with the agent (rmw_uros_sync_session) while connected, feeding ClockSync for the
+// execute-at times of timed commands; the first samples of a session come every CLOCK_SYNC_FAST_PERIOD_US.
+// 0 = no sync (timed commands are dropped as unsynced)
+#ifndef CLOCK_SYNC_PERIOD_MS
+#define CLOCK_SYNC_PERIOD_MS 1000
+#endif
 
 class RosInterface {
 public:
@@ -13,24 +58,175 @@ public:
 
     static RosInterface* globalInstance; // Zugriff für statische Callbacks
 
+    // Transport to the agent (UART / UDP), before initialize(); default from LEG_MODULE_TRANSPORT
+    bool setTransport(const transport::Config& config) { return transport::select(config); }
+    // Static setup only (allocator, message buffers), never touches the transport; the agent connection is
+    // established in the background by spinTransport()
     void initialize();
-    void spin(); // Spin-Methode für die ROS-Executor-Schleife
+    // Idle hook of the service scheduler, blocks for at most maxUs: without agent pings it with backoff and
+    // creates all entities once it answers; connected it runs the executor and pings the agent periodically,
+    // a lost agent tears the entities down and the search starts again
+    void spinTransport(uint32_t maxUs);
+    // Medium slot: publishes pending log lines, applies the joint state rate (only while connected)
+    void service();
+    // Slow slot: alive report with command stream counters
+    void reportHealth();
+    // Uploads the trace rings on the next service slots (TRACE_ENABLED only)
+    void requestTraceDump() { trace_dump_requested.store(true); }
+
+    enum class LinkState : uint8_t { WaitingForAgent, Connected };
+
+    struct ConnectionStats {
+        LinkState state;
+        uint32_t connects;        // sessions established since boot
+        uint32_t disconnects;     // agent lost
+        uint32_t failedSetups;    // agent answered, entity creation failed
+        uint32_t readyUs;         // boot -> first session (0 = not yet)
+        uint32_t lastReconnectUs; // agent lost -> session re-established
+        uint32_t maxReconnectUs;
+    };
+    // Readable from any task
+    ConnectionStats connectionStats() const;
+    // Packets / bytes / errors of the transport below the XRCE session
+    static transport::Stats transportStats() { return transport::stats(); }
+    bool connected() const { return link_state.load() == LinkState::Connected; }
+
+    // Agent search: first retry after AGENT_RETRY_MIN_US, doubling up to AGENT_RETRY_MAX_US.
+    // Connected: ping every AGENT_PING_PERIOD_US, AGENT_MISSED_PINGS misses in a row = agent lost
+    static const uint32_t AGENT_RETRY_MIN_US = 100000;
+    static const uint32_t AGENT_RETRY_MAX_US = 2000000;
+    static const uint32_t AGENT_PING_PERIOD_US = 1000000;
+    static const uint32_t AGENT_PING_TIMEOUT_MS = 50;
+    static const uint32_t AGENT_MISSED_PINGS = 3;
+    static const uint32_t CLOCK_SYNC_FAST_PERIOD_US = 100000;
+    static const uint32_t CLOCK_SYNC_FAST_SAMPLES = 4;
+
+    // Agent clock estimate (offset, drift, round trip, residual), readable from any task
+    const ClockSync& clockSync() const { return clock_sync; }
+    // Agent-clock frames dropped because the clock was not synced yet
+    uint32_t unsyncedFrames() const { return router.unsyncedFrames(); }
+
+    // rcl allocator arena: use, high-water mark, allocations after initialize()
+    static StaticArena::Stats allocatorStats();
+
+    // Counters of the command stream (accepted / dropped / stale / malformed)
+    CommandTracker::Stats commandStats() const { return router.commandStats(); }
+    // Same for the foot target stream
+    CommandTracker::Stats footCommandStats() const { return router.footCommandStats(); }
+    // Same for the gait stream
+    CommandTracker::Stats gaitCommandStats() const { return router.gaitCommandStats(); }
+    // Same for the trajectory chunks
+    CommandTracker::Stats trajectoryStats() const { return router.trajectoryStats(); }
+
+    // Joint state publish rate, clamped to MIN/MAX_JOINT_STATE_RATE_HZ, applied by the service task
+    void setJointStateRateHz(uint32_t hz);
+    uint32_t jointStateRateHz() const { return joint_state_rate_hz.load(); }
+
+    static const uint32_t MIN_JOINT_STATE_RATE_HZ = 1;
+    static const uint32_t MAX_JOINT_STATE_RATE_HZ = 200;
 
 private:
     MotionController* motionController;
 
     rcl_node_t node{};
-    rcl_subscription_t subscriber_left{};
-    rcl_subscription_t subscriber_right{};
+    rcl_subscription_t subscriber_cmd{};
+    rcl_subscription_t subscriber_foot{};
+    rcl_subscription_t subscriber_gait{};
+    rcl_subscription_t subscriber_trajectory{};
+    rcl_publisher_t log_publisher{};
+    rcl_publisher_t joint_state_publisher{};
+    rcl_publisher_t command_log_publisher{};
+    rcl_publisher_t trace_publisher{};
+    rcl_timer_t joint_state_timer{};
     rclc_executor_t executor{};
     rclc_support_t support{};
     rcl_allocator_t allocator{};
 
-    std_msgs__msg__Int32MultiArray msg_left{};
-    std_msgs__msg__Int32MultiArray msg_right{};
+    // Decode, Sequenz-Tracking und Mitschnitt aller Kommando-Streams
+    CommandRouter router;
+    // Agent-Uhr für Ausführungszeitpunkte, Samples nur aus dem Service-Task
+    ClockSync clock_sync;
+    int64_t next_clock_sync_us = 0;
+    uint32_t session_sync_samples = 0;
+
+    // Kommando-Frame, statischer Empfangspuffer (etwas Reserve für fehlerhafte Sender)
+    std_msgs__msg__UInt8MultiArray cmd_msg{};
+    uint8_t cmd_buffer[2 * sizeof(LegCommand)]{};
+
+    // Fußziele (kartesisch, IK auf dem Modul), eigener Sequenzzähler
+    std_msgs__msg__UInt8MultiArray foot_msg{};
+    uint8_t foot_buffer[2 * sizeof(FootCommand)]{};
+
+    // Gait-Parameter / Start-Stopp
+    std_msgs__msg__UInt8MultiArray gait_msg{};
+    uint8_t gait_buffer[2 * sizeof(GaitCommand)]{};
+
+    // Trajektorien-Chunks (Waypoints je Bein), variable Länge bis TRAJECTORY_CHUNK_MAX_BYTES
+    std_msgs__msg__UInt8MultiArray trajectory_msg{};
+    uint8_t trajectory_buffer[TRAJECTORY_CHUNK_MAX_BYTES]{};
+
+    // Upload des Kommando-Mitschnitts, ein Chunk pro Service-Slot
+    static const size_t COMMAND_LOG_CHUNK_BYTES = 256;
+    std_msgs__msg__UInt8MultiArray command_log_msg{};
+    uint8_t command_log_buffer[sizeof(command_log::ChunkHeader) + COMMAND_LOG_CHUNK_BYTES]{};
+    size_t command_log_offset = 0;
+
+    // Upload des Trace-Abbilds (gleiche Chunks wie der Mitschnitt), Aufzeichnung steht solange
+    static const size_t TRACE_CHUNK_BYTES = 256;
+    std_msgs__msg__UInt8MultiArray trace_msg{};
+    uint8_t trace_buffer[sizeof(command_log::ChunkHeader) + TRACE_CHUNK_BYTES]{};
+    size_t trace_offset = 0;
+    bool trace_uploading = false;
+    bool trace_publisher_created = false;
+    int64_t next_trace_dump_us = 0;
+    std::atomic<bool> trace_dump_requested{false};
+
+    // Joint-State-Frame, statischer Sendepuffer
+    std_msgs__msg__UInt8MultiArray joint_state_msg{};
+    uint8_t joint_state_buffer[sizeof(JointStateFrame)]{};
+    uint16_t joint_state_sequence = 0;
+    std::atomic<uint32_t> joint_state_rate_hz{JOINT_STATE_RATE_HZ};
+    uint32_t applied_joint_state_rate_hz = 0; // nur Service-Task
+
+    // Verbindung zum Agent, nur Service-Task (Statistik atomar)
+    std::atomic<LinkState> link_state{LinkState::WaitingForAgent};
+    uint32_t created_entities = 0;  // Anzahl erfolgreich angelegter Entities, Abbau in umgekehrter Reihenfolge
+    int64_t next_ping_us = 0;
+    uint32_t retry_us = AGENT_RETRY_MIN_US;
+    uint32_t missed_pings = 0;
+    int64_t lost_at_us = 0;
+    std::atomic<uint32_t> connects{0};
+    std::atomic<uint32_t> disconnects{0};
+    std::atomic<uint32_t> failed_setups{0};
+    std::atomic<uint32_t> ready_us{0};
+    std::atomic<uint32_t> last_reconnect_us{0};
+    std::atomic<uint32_t> max_reconnect_us{0};
+
+    // Formatierte Log-Zeilen aus logger::service, publiziert in service() nach dem Drain (beides Service-Task)
+    struct LogLine {
+        char text[logger::MAX_LINE];
+        uint8_t len;
+    };
+    RingQueue<LogLine, 8> log_outbox;
+    std_msgs__msg__String log_msg{};
+    char log_msg_buffer[logger::MAX_LINE]{};
 
-    void cleanup();
+    bool createEntities();
+    void destroyEntities();
+    bool pingAgent(uint32_t maxUs);
+    void syncClock(uint32_t maxUs);
+    void onConnected();
+    void onAgentLost();
+    void publishCommandLog();
+    void publishTrace();
+    void publishLogLines();
+    void publishJointState();
+    void applyJointStateRate();
 
-    static void static_left_callback(const void* msgin);
-    static void static_right_callback(const void* msgin);
+    static void static_command_callback(const void* msgin);
+    static void static_foot_callback(const void* msgin);
+    static void static_gait_callback(const void* msgin);
+    static void static_trajectory_callback(const void* msgin);
+    static void static_log_hook(const char* line, size_t len);
+    static void static_joint_state_timer(rcl_timer_t* timer, int64_t last_call_time);
 };
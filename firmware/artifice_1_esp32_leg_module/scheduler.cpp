@@ -0,0 +1,95 @@
+#include "scheduler.hpp"
+#include "hal.hpp"
+#include "trace.hpp"
+
+int Scheduler::addSlot(const char* name, uint32_t periodUs, uint32_t budgetUs, SlotFunction fn, void* arg) {
+    if (slot_count >= MAX_SLOTS || !fn || periodUs == 0) return -1;
+    Slot& slot = slots[slot_count];
+    slot.name = name;
+    slot.periodUs = periodUs;
+    slot.budgetUs = budgetUs;
+    slot.fn = fn;
+    slot.arg = arg;
+    slot.nextUs = hal::nowUs() + periodUs;
+    return static_cast<int>(slot_count++);
+}
+
+void Scheduler::setIdle(IdleFunction fn, void* arg) {
+    idle_fn = fn;
+    idle_arg = arg;
+}
+
+void Scheduler::runSlot(Slot& slot, int64_t nowUs) {
+    const uint32_t late = static_cast<uint32_t>(nowUs - slot.nextUs);
+    if (late > slot.lateMaxUs.load(std::memory_order_relaxed)) slot.lateMaxUs.store(late, std::memory_order_relaxed);
+
+    TRACE_EVENT(SlotBegin, &slot - slots);
+    slot.fn(slot.arg);
+    TRACE_EVENT(SlotEnd, &slot - slots);
+
+    const uint32_t exec = static_cast<uint32_t>(hal::nowUs() - nowUs);
+    if (exec > slot.execMaxUs.load(std::memory_order_relaxed)) slot.execMaxUs.store(exec, std::memory_order_relaxed);
+    if (exec > slot.budgetUs) slot.overruns.fetch_add(1, std::memory_order_relaxed);
+    slot.runs.fetch_add(1, std::memory_order_relaxed);
+
+    // Absolute Kadenz, verpasste Perioden werden übersprungen statt nachgeholt
+    slot.nextUs += slot.periodUs;
+    const int64_t after = hal::nowUs();
+    while (slot.nextUs <= after) slot.nextUs += slot.periodUs;
+}
+
+void Scheduler::runOnce() {
+    if (slot_count == 0) {
+        if (idle_fn) idle_fn(idle_arg, 1000000);
+        else hal::delayMs(1000);
+        return;
+    }
+
+    // Fällige Slots in Registrierungsreihenfolge (= Priorität), pro Durchlauf höchstens einmal
+    bool ran = false;
+    for (size_t i = 0; i < slot_count; ++i) {
+        const int64_t now = hal::nowUs();
+        if (now >= slots[i].nextUs) {
+            runSlot(slots[i], now);
+            ran = true;
+        }
+    }
+    if (ran) return;
+
+    int64_t next = slots[0].nextUs;
+    for (size_t i = 1; i < slot_count; ++i) {
+        if (slots[i].nextUs < next) next = slots[i].nextUs;
+    }
+    const int64_t wait = next - hal::nowUs();
+    if (wait <= 0) return;
+
+    if (idle_fn) {
+        idle_fn(idle_arg, static_cast<uint32_t>(wait));
+    } else if (wait >= 1000) {
+        hal::delayMs(static_cast<uint32_t>(wait / 1000));
+    }
+}
+
+void Scheduler::run() {
+    while (true) runOnce();
+}
+
+Scheduler::SlotStats Scheduler::slotStats(size_t index) const {
+    SlotStats s{};
+    if (index >= slot_count) return s;
+    const Slot& slot = slots[index];
+    s.name = slot.name;
+    s.periodUs = slot.periodUs;
+    s.budgetUs = slot.budgetUs;
+    s.runs = slot.runs.load(std::memory_order_relaxed);
+    s.overruns = slot.overruns.load(std::memory_order_relaxed);
+    s.execMaxUs = slot.execMaxUs.load(std::memory_order_relaxed);
+    s.lateMaxUs = slot.lateMaxUs.load(std::memory_order_relaxed);
+    return s;
+}
+
+uint32_t Scheduler::totalOverruns() const {
+    uint32_t total = 0;
+    for (size_t i = 0; i < slot_count; ++i) total += slots[i].overruns.load(std::memory_order_relaxed);
+    return total;
+}
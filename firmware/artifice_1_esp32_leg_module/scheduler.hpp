@@ -0,0 +1,63 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// Cooperative multi-rate scheduler for one task. Slots run to completion on their own absolute
+// cadence, earlier registered slots first when several are due. Between deadlines the idle hook
+// may block for at most the remaining time (e.g. the ROS executor waiting on the transport).
+// Every slot run is checked against its budget, overruns and late starts are counted.
+class Scheduler {
+public:
+    static const size_t MAX_SLOTS = 4;
+
+    using SlotFunction = void (*)(void* arg);
+    // maxUs: time until the next slot is due, the hook must return by then
+    using IdleFunction = void (*)(void* arg, uint32_t maxUs);
+
+    struct SlotStats {
+        const char* name;
+        uint32_t periodUs;
+        uint32_t budgetUs;
+        uint32_t runs;
+        uint32_t overruns;  // execution time above budget
+        uint32_t execMaxUs;
+        uint32_t lateMaxUs; // start after the deadline (blocked by other slots / idle hook)
+    };
+
+    // Returns the slot index, or -1 if all MAX_SLOTS are used
+    int addSlot(const char* name, uint32_t periodUs, uint32_t budgetUs, SlotFunction fn, void* arg);
+    void setIdle(IdleFunction fn, void* arg);
+
+    // Runs all due slots or the idle hook once
+    void runOnce();
+    // Never returns
+    void run();
+
+    size_t slotCount() const { return slot_count; }
+    // Counters are atomics, readable from any task
+    SlotStats slotStats(size_t index) const;
+    // Overruns of all slots since start
+    uint32_t totalOverruns() const;
+
+private:
+    struct Slot {
+        const char* name = nullptr;
+        uint32_t periodUs = 0;
+        uint32_t budgetUs = 0;
+        SlotFunction fn = nullptr;
+        void* arg = nullptr;
+        int64_t nextUs = 0;
+        std::atomic<uint32_t> runs{0};
+        std::atomic<uint32_t> overruns{0};
+        std::atomic<uint32_t> execMaxUs{0};
+        std::atomic<uint32_t> lateMaxUs{0};
+    };
+
+    void runSlot(Slot& slot, int64_t nowUs);
+
+    Slot slots[MAX_SLOTS];
+    size_t slot_count = 0;
+    IdleFunction idle_fn = nullptr;
+    void* idle_arg = nullptr;
+};
@@ -0,0 +1,69 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// Compile-time servo calibration: angle (centi-degrees) -> pulse (us) -> LEDC duty
+namespace servo_calibration {
+
+static constexpr uint32_t PWM_FREQ_HZ = 50;
+static constexpr uint32_t PWM_RESOLUTION_BITS = 16;
+static constexpr uint32_t PWM_PERIOD_US = 1000000 / PWM_FREQ_HZ;
+static constexpr uint32_t DUTY_MAX = (1u << PWM_RESOLUTION_BITS) - 1;
+
+static constexpr int32_t MAX_ANGLE_DEG = 180;
+static constexpr int32_t MAX_ANGLE_CDEG = MAX_ANGLE_DEG * 100;
+
+struct ServoCalibration {
+    int16_t offset;      // centi-degrees, added to the commanded angle
+    int8_t direction;    // +1 or -1 (mirrored mounting)
+    uint16_t minPulseUs; // pulse at 0 deg
+    uint16_t maxPulseUs; // pulse at 180 deg
+};
+
+// duty = pulse * DUTY_MAX / PERIOD as Q16 factor, one multiply at runtime
+static constexpr uint32_t DUTY_PER_US_Q16 =
+    static_cast<uint32_t>((static_cast<uint64_t>(DUTY_MAX) << 16) / PWM_PERIOD_US);
+
+constexpr uint32_t dutyForPulse(uint32_t pulseUs) {
+    return static_cast<uint32_t>((static_cast<uint64_t>(pulseUs) * DUTY_PER_US_Q16 + (1u << 15)) >> 16);
+}
+
+// One duty value per whole degree, centi-degrees are interpolated between neighbours
+using DutyTable = std::array<uint16_t, MAX_ANGLE_DEG + 1>;
+
+constexpr uint32_t pulseForAngle(const ServoCalibration& cal, int32_t centiDeg) {
+    int32_t a = cal.direction < 0 ? MAX_ANGLE_CDEG - centiDeg : centiDeg;
+    a += cal.offset;
+    if (a < 0) a = 0;
+    if (a > MAX_ANGLE_CDEG) a = MAX_ANGLE_CDEG;
+    const int32_t span = static_cast<int32_t>(cal.maxPulseUs) - static_cast<int32_t>(cal.minPulseUs);
+    return static_cast<uint32_t>(cal.minPulseUs + (a * span + MAX_ANGLE_CDEG / 2) / MAX_ANGLE_CDEG);
+}
+
+constexpr DutyTable buildDutyTable(const ServoCalibration& cal) {
+    DutyTable table{};
+    for (int32_t deg = 0; deg <= MAX_ANGLE_DEG; ++deg) {
+        table[deg] = static_cast<uint16_t>(dutyForPulse(pulseForAngle(cal, deg * 100)));
+    }
+    return table;
+}
+
+template <size_t N>
+constexpr std::array<DutyTable, N> buildDutyTables(const ServoCalibration (&cal)[N]) {
+    std::array<DutyTable, N> tables{};
+    for (size_t i = 0; i < N; ++i) tables[i] = buildDutyTable(cal[i]);
+    return tables;
+}
+
+// Linear interpolation inside the table, centiDeg already clamped to 0..MAX_ANGLE_CDEG
+inline uint32_t dutyForAngle(const DutyTable& table, int32_t centiDeg) {
+    const int32_t deg = centiDeg / 100;
+    const int32_t frac = centiDeg - deg * 100;
+    if (frac == 0) return table[deg];
+    const int32_t lo = table[deg];
+    const int32_t hi = table[deg + 1];
+    return static_cast<uint32_t>(lo + ((hi - lo) * frac + 50) / 100);
+}
+
+} // namespace servo_calibration
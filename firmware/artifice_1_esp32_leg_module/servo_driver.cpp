@@ -1,55 +1,81 @@
 #include "servo_driver.hpp"
+#include "hal.hpp"
+#include "logger.hpp"
+#include "trace.hpp"
 
-const gpio_num_t ServoDriver::SERVO_PINS[] = {
-    GPIO_NUM_19, GPIO_NUM_18, GPIO_NUM_5,
-    GPIO_NUM_17, GPIO_NUM_16, GPIO_NUM_4
-};
-
-const ledc_channel_t ServoDriver::LEDC_CHANNELS[] = {
-    LEDC_CHANNEL_0, LEDC_CHANNEL_1, LEDC_CHANNEL_2,
-    LEDC_CHANNEL_3, LEDC_CHANNEL_4, LEDC_CHANNEL_5
-};
-
-// Alle Servos benutzen denselben Timer (LEDC_TIMER_0)
-const ledc_timer_t ServoDriver::LEDC_TIMERS[] = {
-    LEDC_TIMER_0, LEDC_TIMER_0, LEDC_TIMER_0,
-    LEDC_TIMER_0, LEDC_TIMER_0, LEDC_TIMER_0
-};
+// Tabellen liegen im Flash, nichts davon wird zur Laufzeit berechnet
+static_assert(servo_calibration::dutyForPulse(500) == 1638, "duty mapping for 500us");
+static_assert(servo_calibration::dutyForPulse(2500) == 8192, "duty mapping for 2500us");
 
 void ServoDriver::initializePWM() {
     // Einen Timer konfigurieren (einmal)
-    ledc_timer_config_t timer_conf{};
-    timer_conf.speed_mode       = LEDC_HIGH_SPEED_MODE;
-    timer_conf.timer_num        = LEDC_TIMER_0;
-    timer_conf.duty_resolution  = LEDC_TIMER_16_BIT;
-    timer_conf.freq_hz          = 50; // Standard Servo-Freq
-    ledc_timer_config(&timer_conf);
+    hal::pwmInitTimer(servo_calibration::PWM_FREQ_HZ, servo_calibration::PWM_RESOLUTION_BITS);
 
     // Channels konfigurieren (ein Channel pro Servo)
     for (size_t i = 0; i < NUM_SERVOS; ++i) {
-        ledc_channel_config_t ch_conf{};
-        ch_conf.channel    = LEDC_CHANNELS[i];
-        ch_conf.gpio_num   = SERVO_PINS[i];
-        ch_conf.speed_mode = LEDC_HIGH_SPEED_MODE;
-        ch_conf.timer_sel  = LEDC_TIMER_0;
-        ch_conf.duty       = 0;
-        ledc_channel_config(&ch_conf);
+        if (!hal::pwmInitChannel(SERVO_CHANNELS[i].channel, SERVO_CHANNELS[i].pin)) {
+            LOG_E("PWM channel %u (GPIO %d) not configured, servo %u stays off",
+                  SERVO_CHANNELS[i].channel, SERVO_CHANNELS[i].pin, static_cast<uint32_t>(i));
+        }
     }
 }
 
 void ServoDriver::setAngle(int angle, int index) {
-    if (index < 0 || index >= static_cast<int>(NUM_SERVOS)) return;
+    if (index < 0) return;
+    setAngleCentiDeg(static_cast<int32_t>(angle) * 100, static_cast<size_t>(index));
+}
+
+uint32_t ServoDriver::dutyForAngle(int32_t centiDeg, size_t index) {
+    if (centiDeg < 0) centiDeg = 0;
+    if (centiDeg > servo_calibration::MAX_ANGLE_CDEG) centiDeg = servo_calibration::MAX_ANGLE_CDEG;
+    return servo_calibration::dutyForAngle(DUTY_TABLES[index], centiDeg);
+}
+
+void ServoDriver::setAngleCentiDeg(int32_t centiDeg, size_t index) {
+    if (index >= NUM_SERVOS) return;
+    writeDuty(index, dutyForAngle(centiDeg, index));
+}
+
+size_t ServoDriver::writeFrame(const int32_t* centiDeg) {
+    // Erst alle Duties schreiben, dann gemeinsam latchen -> kein Versatz zwischen Servo 0 und 5
+    TRACE_EVENT(LedcBegin, 0);
+    uint32_t mask = 0;
+    size_t changed = 0;
+    for (size_t i = 0; i < NUM_SERVOS; ++i) {
+        const uint32_t duty = dutyForAngle(centiDeg[i], i);
+        if (duty == last_duty[i]) continue;
+        last_duty[i] = duty;
+        hal::pwmSetDuty(SERVO_CHANNELS[i].channel, duty);
+        mask |= 1u << SERVO_CHANNELS[i].channel;
+        ++changed;
+    }
+    if (mask) hal::pwmLatch(mask);
+    TRACE_EVENT(LedcEnd, changed);
+
+    frames.fetch_add(1, std::memory_order_relaxed);
+    channel_updates.fetch_add(changed, std::memory_order_relaxed);
+    channels_skipped.fetch_add(NUM_SERVOS - changed, std::memory_order_relaxed);
+    return changed;
+}
 
-    if (angle < 0) angle = 0;
-    if (angle > 180) angle = 180;
+ServoDriver::FrameStats ServoDriver::frameStats() const {
+    return {frames.load(std::memory_order_relaxed),
+            channel_updates.load(std::memory_order_relaxed),
+            channels_skipped.load(std::memory_order_relaxed)};
+}
+
+void ServoDriver::setPulseUs(uint32_t pulseUs, size_t index) {
+    if (index >= NUM_SERVOS) return;
 
-    // Map 0..180 -> duty (16-bit) for 500..2500us on 20ms period
-    // Hier: duty = (pulse_us / 20000us) * 65535
-    const int pulse_min_us = 500;
-    const int pulse_max_us = 2500;
-    int pulse = pulse_min_us + (angle * (pulse_max_us - pulse_min_us) / 180);
-    uint32_t duty = static_cast<uint32_t>((int64_t)pulse * 65535LL / 20000LL);
+    const servo_calibration::ServoCalibration& cal = CALIBRATION[index];
+    if (pulseUs < cal.minPulseUs) pulseUs = cal.minPulseUs;
+    if (pulseUs > cal.maxPulseUs) pulseUs = cal.maxPulseUs;
+
+    writeDuty(index, servo_calibration::dutyForPulse(pulseUs));
+}
 
-    ledc_set_duty(LEDC_HIGH_SPEED_MODE, LEDC_CHANNELS[index], duty);
-    ledc_update_duty(LEDC_HIGH_SPEED_MODE, LEDC_CHANNELS[index]);
+void ServoDriver::writeDuty(size_t index, uint32_t duty) {
+    last_duty[index] = duty;
+    hal::pwmSetDuty(SERVO_CHANNELS[index].channel, duty);
+    hal::pwmUpdateDuty(SERVO_CHANNELS[index].channel);
 }
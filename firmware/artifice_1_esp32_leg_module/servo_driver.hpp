@@ -1,20 +1,51 @@
 #pragma once
-#include "driver/gpio.h"
-#include "driver/ledc.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include "module_topology.hpp"
+#include "servo_calibration.hpp"
 
 class ServoDriver {
 public:
-    ServoDriver() = default;
+    ServoDriver() {
+        for (size_t i = 0; i < NUM_SERVOS; ++i) last_duty[i] = NO_DUTY;
+    }
     
     // Initializes PWM for servos
     void initializePWM();
-    // Sets the angle of the servo at the given index
+    // Sets the angle of the servo at the given index (whole degrees)
     void setAngle(int angle, int index);
-    static const size_t NUM_SERVOS = 6;
+    // Sets the angle in centi-degrees (0..18000), mapped through the calibration table
+    void setAngleCentiDeg(int32_t centiDeg, size_t index);
+    // Sets the raw pulse width, clamped to the servo's calibrated min/max pulse
+    void setPulseUs(uint32_t pulseUs, size_t index);
+    // Writes a whole frame (centi-degrees, NUM_SERVOS entries). Channels whose duty did not change
+    // are skipped, all changed channels are latched together. Returns the number of changed channels.
+    size_t writeFrame(const int32_t* centiDeg);
+    static const size_t NUM_SERVOS = LegModule::SERVOS;
+
+    struct FrameStats {
+        uint32_t frames;          // writeFrame calls
+        uint32_t channelUpdates;  // channels actually written
+        uint32_t channelsSkipped; // unchanged duty, no register access
+    };
+    FrameStats frameStats() const;
+
+    // Per-servo calibration from the module topology, the duty tables are generated from it at compile time
+    static constexpr const servo_calibration::ServoCalibration (&CALIBRATION)[NUM_SERVOS] = LegModule::CALIBRATION;
 
 private:
-    // variables for servo controle which will be defined at compile time
-    static const gpio_num_t SERVO_PINS[];
-    static const ledc_channel_t LEDC_CHANNELS[];
-    static const ledc_timer_t LEDC_TIMERS[];
+    void writeDuty(size_t index, uint32_t duty);
+    static uint32_t dutyForAngle(int32_t centiDeg, size_t index);
+
+    static const uint32_t NO_DUTY = 0xFFFFFFFFu;
+    uint32_t last_duty[NUM_SERVOS];
+    std::atomic<uint32_t> frames{0};
+    std::atomic<uint32_t> channel_updates{0};
+    std::atomic<uint32_t> channels_skipped{0};
+
+    // Pins / LEDC channels of the module variant, fixed at compile time
+    static constexpr const topology::ServoChannel (&SERVO_CHANNELS)[NUM_SERVOS] = LegModule::SERVO_CHANNELS;
+    static constexpr std::array<servo_calibration::DutyTable, NUM_SERVOS> DUTY_TABLES =
+        servo_calibration::buildDutyTables(CALIBRATION);
 };
@@ -0,0 +1,86 @@
+#include "static_arena.hpp"
+#include <cstdlib>
+#include <cstring>
+
+StaticArena::StaticArena(uint8_t* buffer, size_t size) {
+    // Anfang ausrichten, Rest ist nutzbar
+    const uintptr_t addr = reinterpret_cast<uintptr_t>(buffer);
+    const size_t skip = alignUp(addr) - addr;
+    base = buffer + skip;
+    capacity = size > skip ? ((size - skip) & ~(ALIGN - 1)) : 0;
+}
+
+void StaticArena::countAllocation() {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (frozen.load(std::memory_order_relaxed)) {
+        after_freeze.fetch_add(1, std::memory_order_relaxed);
+#if STATIC_ARENA_TRAP
+        abort();
+#endif
+    }
+}
+
+void* StaticArena::allocate(size_t size) {
+    countAllocation();
+    const size_t need = HEADER + alignUp(size > 0 ? size : 1);
+    if (need > capacity - top) {
+        failed.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+    uint8_t* block = base + top + HEADER;
+    top += need;
+    if (top > high_water) high_water = top;
+    blockSize(block) = need;
+    return block;
+}
+
+void StaticArena::deallocate(void* ptr) {
+    if (!ptr) return;
+    // Nur der letzte Block wird zurückgegeben (LIFO), alles andere bleibt belegt
+    const size_t size = blockSize(ptr);
+    if (static_cast<uint8_t*>(ptr) - HEADER + size == base + top) top -= size;
+}
+
+void* StaticArena::reallocate(void* ptr, size_t size) {
+    if (!ptr) return allocate(size);
+    const size_t old = blockSize(ptr);
+    const size_t need = HEADER + alignUp(size > 0 ? size : 1);
+    if (need <= old) return ptr;
+
+    // Letzter Block: an Ort und Stelle wachsen
+    if (static_cast<uint8_t*>(ptr) - HEADER + old == base + top && need - old <= capacity - top) {
+        countAllocation();
+        top += need - old;
+        if (top > high_water) high_water = top;
+        blockSize(ptr) = need;
+        return ptr;
+    }
+    void* grown = allocate(size);
+    if (!grown) return nullptr;
+    std::memcpy(grown, ptr, old - HEADER);
+    deallocate(ptr);
+    return grown;
+}
+
+void* StaticArena::zeroAllocate(size_t count, size_t size) {
+    if (size != 0 && count > SIZE_MAX / size) return nullptr;
+    void* ptr = allocate(count * size);
+    if (ptr) std::memset(ptr, 0, count * size);
+    return ptr;
+}
+
+void StaticArena::reset() {
+    top = 0;
+    frozen.store(false);
+}
+
+StaticArena::Stats StaticArena::stats() const {
+    Stats s;
+    s.capacity = capacity;
+    s.used = top;
+    s.highWater = high_water;
+    s.allocations = allocations.load(std::memory_order_relaxed);
+    s.failed = failed.load(std::memory_order_relaxed);
+    s.afterFreeze = after_freeze.load(std::memory_order_relaxed);
+    return s;
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// Trap (abort) on allocations after freeze() instead of only counting them
+#ifndef STATIC_ARENA_TRAP
+#define STATIC_ARENA_TRAP 0
+#endif
+
+// Bump allocator over a caller-provided static buffer (e.g. for rcl/rclc).
+// Blocks carry their size in a small header. deallocate() only gives memory back if the block is the
+// last one (init/fini in reverse order), otherwise it stays used. After freeze() every allocation is
+// counted (or trapped with STATIC_ARENA_TRAP), so steady-state allocations show up instead of fragmenting.
+class StaticArena {
+public:
+    struct Stats {
+        size_t capacity;
+        size_t used;
+        size_t highWater;        // maximum of used since start
+        uint32_t allocations;
+        uint32_t failed;         // arena exhausted
+        uint32_t afterFreeze;    // allocations after freeze()
+    };
+
+    StaticArena(uint8_t* buffer, size_t size);
+
+    void* allocate(size_t size);
+    void deallocate(void* ptr);
+    void* reallocate(void* ptr, size_t size);
+    void* zeroAllocate(size_t count, size_t size);
+
+    // End of the initialization phase
+    void freeze() { frozen.store(true); }
+    bool isFrozen() const { return frozen.load(); }
+    // Drops all blocks and thaws the arena. Only when every user is finalized (e.g. all rcl entities
+    // destroyed before they are re-created after a reconnect).
+    void reset();
+
+    Stats stats() const;
+
+private:
+    static const size_t ALIGN = 8;
+    static const size_t HEADER = ALIGN; // Blockgröße, Payload bleibt ausgerichtet
+
+    static size_t alignUp(size_t n) { return (n + ALIGN - 1) & ~(ALIGN - 1); }
+    static size_t& blockSize(void* ptr) { return *reinterpret_cast<size_t*>(static_cast<uint8_t*>(ptr) - HEADER); }
+    void countAllocation();
+
+    uint8_t* base;
+    size_t capacity;
+    size_t top = 0;
+    size_t high_water = 0;
+    std::atomic<bool> frozen{false};
+    std::atomic<uint32_t> allocations{0};
+    std::atomic<uint32_t> failed{0};
+    std::atomic<uint32_t> after_freeze{0};
+};
@@ -0,0 +1,49 @@
+#pragma once
+#include <cstdint>
+#include "hal.hpp"
+
+// Task topology of the leg module: core, priority and stack of every task in one place.
+// Two tasks: the control loop alone on CONTROL_CORE at the highest application priority (fast slot),
+// and one service task on TRANSPORT_CORE whose cooperative scheduler runs executor, telemetry,
+// logging and health reporting. -1 (hal::ANY_CORE) = not pinned.
+#ifndef CONTROL_CORE
+#define CONTROL_CORE 1
+#endif
+#ifndef TRANSPORT_CORE
+#define TRANSPORT_CORE 0
+#endif
+
+namespace task_layout {
+
+struct TaskSpec {
+    const char* name;
+    uint32_t stackBytes;
+    int priority;
+    int core;
+};
+
+// Unter esp_timer (22) und WiFi (23), über allem anderen der Anwendung
+static constexpr TaskSpec CONTROL = {"servo_task",   4096, 20, CONTROL_CORE};
+// rclc-Setup / -Abbau beim (Re-)Connect, Executor + XRCE-DDS, Zeitabgleich, vsnprintf der Log-Zeilen und
+// Health-Reports teilen sich einen Stack; micro-ROS-Beispiele geben dem Init-Task ~16 KiB
+static constexpr TaskSpec SERVICE = {"service_task", 12288, 5, TRANSPORT_CORE};
+// Optionaler Fast-Path-Leser (FAST_LINK_ENABLED): wartet auf UART-Events, parst und übergibt an den Loop.
+// Über dem Service-Task, damit XRCE den Fast-Path nicht aufhält
+static constexpr TaskSpec FAST_LINK = {"fast_link", 2048, 15, TRANSPORT_CORE};
+
+static_assert(CONTROL.stackBytes + SERVICE.stackBytes + FAST_LINK.stackBytes <= hal::TASK_STACK_POOL_BYTES,
+              "task stacks must fit the static pool");
+// Weniger freier Stack (High-Water-Mark) meldet der Health-Slot als Fehler
+static const uint32_t STACK_MARGIN_BYTES = 1024;
+
+// Slots of the service scheduler (period / budget in us), the executor fills the time in between
+static const uint32_t SERVICE_SLOT_PERIOD_US = 20000;    // logger drain, log lines, joint state rate
+static const uint32_t SERVICE_SLOT_BUDGET_US = 5000;
+static const uint32_t HEALTH_SLOT_PERIOD_US  = 10000000; // alive / timing / overrun reports
+static const uint32_t HEALTH_SLOT_BUDGET_US  = 2000;
+
+inline bool start(const TaskSpec& spec, hal::TaskFunction fn, void* arg) {
+    return hal::createTask(fn, spec.name, spec.stackBytes, arg, spec.priority, spec.core);
+}
+
+} // namespace task_layout
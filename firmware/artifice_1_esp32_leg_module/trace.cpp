@@ -0,0 +1,79 @@
+#include "trace.hpp"
+#include <cstring>
+
+namespace trace {
+
+Ring rings[CORES];
+std::atomic<bool> recording{TRACE_ENABLED != 0};
+
+void setRecording(bool on) {
+    recording.store(on && TRACE_ENABLED != 0);
+}
+
+bool isRecording() {
+    return recording.load();
+}
+
+void clear() {
+    for (size_t c = 0; c < CORES; ++c) {
+        for (size_t i = 0; i < EVENTS_PER_CORE; ++i) rings[c].slots[i].seq.store(0, std::memory_order_relaxed);
+        rings[c].head.store(0, std::memory_order_relaxed);
+    }
+}
+
+size_t dumpBytes() {
+    return sizeof(DumpHeader) + CORES * (sizeof(uint32_t) + EVENTS_PER_CORE * sizeof(Event));
+}
+
+namespace {
+
+// Ein Element des Abbilds (Header, Head eines Rings oder ein Event) in gepackter Form
+size_t element(size_t offset, uint8_t* buf, size_t& start) {
+    if (offset < sizeof(DumpHeader)) {
+        DumpHeader h{DUMP_MAGIC, DUMP_VERSION, static_cast<uint8_t>(CORES), static_cast<uint16_t>(EVENTS_PER_CORE),
+                     hal::cyclesPerUs()};
+        std::memcpy(buf, &h, sizeof(h));
+        start = 0;
+        return sizeof(h);
+    }
+    const size_t ringBytes = sizeof(uint32_t) + EVENTS_PER_CORE * sizeof(Event);
+    const size_t rel = offset - sizeof(DumpHeader);
+    const Ring& ring = rings[rel / ringBytes];
+    const size_t inRing = rel % ringBytes;
+    if (inRing < sizeof(uint32_t)) {
+        const uint32_t head = ring.head.load(std::memory_order_acquire);
+        std::memcpy(buf, &head, sizeof(head));
+        start = offset - inRing;
+        return sizeof(head);
+    }
+    const size_t index = (inRing - sizeof(uint32_t)) / sizeof(Event);
+    const Slot& slot = ring.slots[index];
+    Event e;
+    e.seq = slot.seq.load(std::memory_order_acquire);
+    e.cycles = slot.cycles;
+    e.arg = slot.arg;
+    e.id = slot.id;
+    std::memcpy(buf, &e, sizeof(e));
+    start = offset - (inRing - sizeof(uint32_t)) % sizeof(Event);
+    return sizeof(e);
+}
+
+} // namespace
+
+size_t copy(size_t offset, uint8_t* out, size_t capacity) {
+    const size_t total = dumpBytes();
+    size_t copied = 0;
+    uint8_t buf[sizeof(DumpHeader) > sizeof(Event) ? sizeof(DumpHeader) : sizeof(Event)];
+    while (copied < capacity && offset < total) {
+        size_t start = 0;
+        const size_t len = element(offset, buf, start);
+        size_t n = start + len - offset;
+        if (n > capacity - copied) n = capacity - copied;
+        std::memcpy(out + copied, buf + (offset - start), n);
+        copied += n;
+        offset += n;
+    }
+    return copied;
+}
+
+} // namespace trace
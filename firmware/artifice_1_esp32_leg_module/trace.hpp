@@ -0,0 +1,123 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include "hal.hpp"
+
+// Low-overhead timing trace: cycle-counter stamped events (control loop, executor, callbacks, LEDC writes,
+// service slots) in one lock-free ring per core. Compiled out unless TRACE_ENABLED; when on, an event is a
+// counter read, the core id, one fetch_add and a few stores (host: ~60 ns, mostly clock_gettime), cheap enough
+// to stay on in the field.
+// The rings are dumped as one fixed-size image (dumpBytes / copy), on the module in chunks on /leg/<id>/trace;
+// host/trace_tool.cpp turns a dump into Chrome / Perfetto JSON and latency histograms.
+#ifndef TRACE_ENABLED
+#define TRACE_ENABLED 0
+#endif
+// Events per core, power of two (12 bytes each)
+#ifndef TRACE_EVENTS_PER_CORE
+#define TRACE_EVENTS_PER_CORE 512
+#endif
+
+#if TRACE_ENABLED
+#define TRACE_EVENT(id, arg) ::trace::record(::trace::Id::id, static_cast<uint32_t>(arg))
+#else
+#define TRACE_EVENT(id, arg) ((void)0)
+#endif
+
+namespace trace {
+
+static const size_t CORES = 2;
+static const size_t EVENTS_PER_CORE = TRACE_EVENTS_PER_CORE;
+static_assert((EVENTS_PER_CORE & (EVENTS_PER_CORE - 1)) == 0, "TRACE_EVENTS_PER_CORE must be a power of two");
+// Every SYNC_EVERY-th slot of a ring is a Sync event (arg = hal::nowUs() low 32 bit): maps the cycle counter
+// of each core onto the common clock and unwraps it
+static const uint32_t SYNC_EVERY = 64;
+
+enum class Id : uint16_t {
+    Sync = 0,
+    LoopBegin = 1,      // arg: wake bits of periodicWait
+    LoopEnd = 2,        // arg: channels latched in this tick
+    ExecutorBegin = 3,
+    ExecutorEnd = 4,
+    CallbackBegin = 5,  // arg: command_log::FrameKind, JOINT_STATE_CALLBACK for the joint state timer
+    CallbackEnd = 6,
+    LedcBegin = 7,
+    LedcEnd = 8,        // arg: channels written
+    SlotBegin = 9,      // arg: scheduler slot index
+    SlotEnd = 10,
+    FastFrame = 11      // instant, arg: sequence
+};
+
+static const uint32_t JOINT_STATE_CALLBACK = 16;
+
+static const uint32_t DUMP_MAGIC = 0x43525454; // "TTRC"
+static const uint8_t DUMP_VERSION = 1;
+
+#pragma pack(push, 1)
+// Dump image: DumpHeader, then per core uint32 head (next ring index) and EVENTS_PER_CORE raw Events in slot order
+struct DumpHeader {
+    uint32_t magic;
+    uint8_t version;
+    uint8_t cores;
+    uint16_t eventsPerCore;
+    uint32_t cyclesPerUs;
+};
+
+struct Event {
+    uint32_t cycles;
+    uint32_t arg;
+    uint16_t id;
+    uint16_t seq;       // low 16 bit of ring index + 1, 0 = empty; slot is valid if it matches the head
+};
+#pragma pack(pop)
+
+struct Slot {
+    uint32_t cycles;
+    uint32_t arg;
+    uint16_t id;
+    std::atomic<uint16_t> seq;  // zuletzt geschrieben
+};
+
+struct Ring {
+    std::atomic<uint32_t> head{0};
+    Slot slots[EVENTS_PER_CORE];
+};
+
+extern Ring rings[CORES];
+extern std::atomic<bool> recording;
+
+inline void write(Ring& ring, uint32_t index, uint16_t id, uint32_t arg) {
+    Slot& slot = ring.slots[index & (EVENTS_PER_CORE - 1)];
+    slot.seq.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.cycles = hal::cycleCount();
+    slot.arg = arg;
+    slot.id = id;
+    slot.seq.store(static_cast<uint16_t>(index + 1), std::memory_order_release);
+}
+
+// Lock-free, callable from any task; tasks sharing a core each claim their own slot
+inline void record(Id id, uint32_t arg) {
+    if (!recording.load(std::memory_order_relaxed)) return;
+    Ring& ring = rings[static_cast<size_t>(hal::currentCore()) & (CORES - 1)];
+    uint32_t index = ring.head.fetch_add(1, std::memory_order_relaxed);
+    if ((index & (SYNC_EVERY - 1)) == 0) {
+        write(ring, index, static_cast<uint16_t>(Id::Sync), static_cast<uint32_t>(hal::nowUs()));
+        index = ring.head.fetch_add(1, std::memory_order_relaxed);
+    }
+    write(ring, index, static_cast<uint16_t>(id), arg);
+}
+
+// Pauses / resumes recording (e.g. while a dump is read out, so the image stays consistent)
+void setRecording(bool on);
+bool isRecording();
+// Drops all events
+void clear();
+
+// Size of the dump image
+size_t dumpBytes();
+// Copies up to capacity bytes of the dump image starting at offset, returns bytes copied.
+// Consistent only while recording is paused.
+size_t copy(size_t offset, uint8_t* out, size_t capacity);
+
+} // namespace trace
@@ -0,0 +1,131 @@
+#include "trajectory.hpp"
+#include <cmath>
+
+namespace trajectory {
+
+namespace {
+
+int32_t toQ16(float v) {
+    return static_cast<int32_t>(v * Q16_ONE + 0.5f);
+}
+
+int32_t mulQ16(int32_t a, int32_t b) {
+    return static_cast<int32_t>((static_cast<int64_t>(a) * b) >> 16);
+}
+
+// Untergrenze für alpha, hält 1/alpha im Q16-Bereich
+const float MIN_ALPHA = 1.0f / 256.0f;
+
+} // namespace
+
+void LegTrajectory::plan(const int32_t* start, const int32_t* target, const JointLimits* limits,
+                         size_t numJoints, ProfileType type, int64_t startUs) {
+    if (numJoints > MAX_JOINTS) numJoints = MAX_JOINTS;
+    num_joints = numJoints;
+    profile = type;
+    start_us = startUs;
+
+    // S-Kurve: Spitzenbeschleunigung ist 1.5x die mittlere Rampenbeschleunigung
+    const float accelFactor = (type == ProfileType::SCurve) ? 1.5f : 1.0f;
+
+    // 1) Zeitoptimales Profil des langsamsten Gelenks bestimmt Dauer und Form
+    float duration = 0.0f;
+    float shape = 0.5f;
+    for (size_t i = 0; i < num_joints; ++i) {
+        origin[i] = start[i];
+        end[i] = target[i];
+        delta[i] = target[i] - start[i];
+
+        const float dist = static_cast<float>(std::abs(delta[i]));
+        if (dist == 0.0f || limits[i].maxVelocity <= 0 || limits[i].maxAcceleration <= 0) continue;
+
+        const float v = static_cast<float>(limits[i].maxVelocity);
+        const float a = static_cast<float>(limits[i].maxAcceleration) / accelFactor;
+        float rampTime, total;
+        if (dist * a >= v * v) {
+            rampTime = v / a;                // Trapez mit Reisephase
+            total = dist / v + rampTime;
+        } else {
+            rampTime = std::sqrt(dist / a);  // Dreieck, vmax wird nicht erreicht
+            total = 2.0f * rampTime;
+        }
+        if (total > duration) {
+            duration = total;
+            shape = rampTime / total;
+        }
+    }
+
+    if (duration <= 0.0f) {
+        duration_us = 0;
+        return;
+    }
+
+    if (shape < MIN_ALPHA) shape = MIN_ALPHA;
+    if (shape > 0.5f) shape = 0.5f;
+
+    // 2) Alle Gelenke mit gemeinsamer Form und Dauer müssen ihre Limits einhalten
+    for (size_t i = 0; i < num_joints; ++i) {
+        const float dist = static_cast<float>(std::abs(delta[i]));
+        if (dist == 0.0f || limits[i].maxVelocity <= 0 || limits[i].maxAcceleration <= 0) continue;
+        const float byVelocity = dist / (limits[i].maxVelocity * (1.0f - shape));
+        const float byAccel = std::sqrt(accelFactor * dist /
+                                        (limits[i].maxAcceleration * shape * (1.0f - shape)));
+        if (byVelocity > duration) duration = byVelocity;
+        if (byAccel > duration) duration = byAccel;
+    }
+
+    duration_us = static_cast<int64_t>(std::ceil(duration * 1e6f));
+    if (duration_us < 1) duration_us = 1;
+    inv_duration_q48 = (static_cast<int64_t>(1) << 48) / duration_us;
+
+    const float peak = 1.0f / (1.0f - shape);
+    alpha = toQ16(shape);
+    peak_velocity = toQ16(peak);
+    if (type == ProfileType::SCurve) {
+        ramp_coef = toQ16(peak * shape);
+        inv_alpha = toQ16(1.0f / shape);
+    } else {
+        ramp_coef = toQ16(peak / (2.0f * shape));
+        inv_alpha = 0;
+    }
+}
+
+int32_t LegTrajectory::progressQ16(int32_t u) const {
+    if (u <= 0) return 0;
+    if (u >= Q16_ONE) return Q16_ONE;
+
+    // Beschleunigungsrampe, Bremsrampe ist punktsymmetrisch dazu
+    auto ramp = [this](int32_t x) -> int32_t {
+        if (profile == ProfileType::SCurve) {
+            // s = v*alpha * (x^3 - x^4/2), x = u/alpha
+            int32_t n  = mulQ16(x, inv_alpha);
+            int32_t n2 = mulQ16(n, n);
+            int32_t n3 = mulQ16(n2, n);
+            int32_t n4 = mulQ16(n3, n);
+            return mulQ16(ramp_coef, n3 - n4 / 2);
+        }
+        // s = v/(2*alpha) * u^2
+        return mulQ16(ramp_coef, mulQ16(x, x));
+    };
+
+    if (u < alpha) return ramp(u);
+    if (u <= Q16_ONE - alpha) return mulQ16(peak_velocity, u - alpha / 2);
+    return Q16_ONE - ramp(Q16_ONE - u);
+}
+
+bool LegTrajectory::sample(int64_t nowUs, int32_t* out) const {
+    const int64_t elapsed = nowUs - start_us;
+    if (duration_us == 0 || elapsed >= duration_us) {
+        for (size_t i = 0; i < num_joints; ++i) out[i] = end[i];
+        return false;
+    }
+
+    const int32_t u = elapsed <= 0 ? 0 : static_cast<int32_t>((elapsed * inv_duration_q48) >> 32);
+    const int32_t s = progressQ16(u);
+    for (size_t i = 0; i < num_joints; ++i) {
+        out[i] = origin[i] + static_cast<int32_t>((static_cast<int64_t>(delta[i]) * s + (1 << 15)) >> 16);
+    }
+    return true;
+}
+
+} // namespace trajectory
@@ -0,0 +1,57 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// Time-parameterized point-to-point profiles for one leg.
+// Positions in centi-degrees, time in microseconds, per-tick evaluation in Q16 fixed point.
+namespace trajectory {
+
+static const int32_t Q16_ONE = 1 << 16;
+
+enum class ProfileType : uint8_t {
+    Trapezoidal, // constant acceleration ramps
+    SCurve       // smoothstep velocity ramps, continuous acceleration (bounded jerk)
+};
+
+struct JointLimits {
+    int32_t maxVelocity;     // centi-degrees / s
+    int32_t maxAcceleration; // centi-degrees / s^2
+};
+
+// Coordinated move: every joint of the leg follows the same normalized profile,
+// so all joints start and arrive at the same time without exceeding their own limits.
+class LegTrajectory {
+public:
+    static const size_t MAX_JOINTS = 4;
+
+    // Plans a move from start to target, numJoints <= MAX_JOINTS
+    void plan(const int32_t* start, const int32_t* target, const JointLimits* limits,
+              size_t numJoints, ProfileType type, int64_t startUs);
+    // Writes the positions at nowUs into out, returns false once the move is finished
+    bool sample(int64_t nowUs, int32_t* out) const;
+
+    int64_t durationUs() const { return duration_us; }
+    const int32_t* target() const { return end; }
+
+private:
+    // Normalized progress s(u) in Q16 for normalized time u in Q16
+    int32_t progressQ16(int32_t u) const;
+
+    size_t num_joints = 0;
+    ProfileType profile = ProfileType::SCurve;
+    int64_t start_us = 0;
+    int64_t duration_us = 0;
+    int64_t inv_duration_q48 = 0; // 2^48 / duration_us, erspart die Division pro Tick
+
+    int32_t origin[MAX_JOINTS] = {};
+    int32_t end[MAX_JOINTS] = {};
+    int32_t delta[MAX_JOINTS] = {};
+
+    // Profilform, alle Q16
+    int32_t alpha = 0;        // Anteil der Beschleunigungsphase an der Gesamtdauer (<= 0.5)
+    int32_t peak_velocity = 0; // normierte Spitzengeschwindigkeit 1 / (1 - alpha)
+    int32_t ramp_coef = 0;    // Trapez: v/(2*alpha), S-Kurve: v*alpha
+    int32_t inv_alpha = 0;    // S-Kurve: 1/alpha
+};
+
+} // namespace trajectory
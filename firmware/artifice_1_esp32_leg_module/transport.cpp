@@ -0,0 +1,127 @@
+#include "transport.hpp"
+#include <atomic>
+
+// Default UART: braucht keine Netzwerk-Initialisierung. UDP setzt voraus, dass die Anwendung WLAN / netif
+// selbst hochfährt, bevor der Service-Task den Agent sucht (macht diese Firmware nicht)
+#ifndef LEG_MODULE_TRANSPORT
+#define LEG_MODULE_TRANSPORT 0
+#endif
+// UART: serial agent (micro_ros_agent serial --dev ... -b 921600). UART1 auf freien Pins, UART0 ist die Log-Konsole
+#ifndef TRANSPORT_UART_PORT
+#define TRANSPORT_UART_PORT 1
+#endif
+#ifndef TRANSPORT_UART_BAUD
+#define TRANSPORT_UART_BAUD 921600
+#endif
+#ifndef TRANSPORT_UART_TX
+#define TRANSPORT_UART_TX 22
+#endif
+#ifndef TRANSPORT_UART_RX
+#define TRANSPORT_UART_RX 23
+#endif
+// UDP: micro_ros_agent udp4 --port 8888
+#ifndef TRANSPORT_AGENT_IP
+#define TRANSPORT_AGENT_IP "192.168.4.1"
+#endif
+#ifndef TRANSPORT_AGENT_PORT
+#define TRANSPORT_AGENT_PORT 8888
+#endif
+
+namespace transport {
+
+// Plattform-Backends (transport_udp.cpp, transport_uart_esp32.cpp); nullptr wenn nicht gebaut
+extern const Backend* const UART_BACKEND;
+extern const Backend* const UDP_BACKEND;
+
+namespace {
+
+Config active_config = defaultConfig();
+const Backend* active_backend = nullptr;
+bool is_open = false;
+
+std::atomic<uint32_t> opens{0};
+std::atomic<uint32_t> packets_out{0};
+std::atomic<uint32_t> packets_in{0};
+std::atomic<uint32_t> bytes_out{0};
+std::atomic<uint32_t> bytes_in{0};
+std::atomic<uint32_t> write_errors{0};
+std::atomic<uint32_t> read_timeouts{0};
+
+} // namespace
+
+Config defaultConfig() {
+    return {static_cast<Kind>(LEG_MODULE_TRANSPORT), TRANSPORT_UART_PORT, TRANSPORT_UART_BAUD, TRANSPORT_UART_TX,
+            TRANSPORT_UART_RX, TRANSPORT_AGENT_IP, TRANSPORT_AGENT_PORT};
+}
+
+const Backend* backend(Kind kind) {
+    switch (kind) {
+        case Kind::Uart: return UART_BACKEND;
+        case Kind::Udp: return UDP_BACKEND;
+    }
+    return nullptr;
+}
+
+bool select(const Config& cfg) {
+    const Backend* b = backend(cfg.kind);
+    if (!b || is_open) return false;
+    active_config = cfg;
+    active_backend = b;
+    return true;
+}
+
+const Config& config() {
+    return active_config;
+}
+
+const Backend* active() {
+    if (!active_backend) active_backend = backend(active_config.kind);
+    return active_backend;
+}
+
+bool open() {
+    const Backend* b = active();
+    if (!b || !b->open(active_config)) return false;
+    is_open = true;
+    opens.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+void close() {
+    if (!is_open) return;
+    active_backend->close();
+    is_open = false;
+}
+
+size_t write(const uint8_t* data, size_t len) {
+    if (!is_open) return 0;
+    const size_t n = active_backend->write(data, len);
+    if (n == 0) {
+        write_errors.fetch_add(1, std::memory_order_relaxed);
+        return 0;
+    }
+    packets_out.fetch_add(1, std::memory_order_relaxed);
+    bytes_out.fetch_add(static_cast<uint32_t>(n), std::memory_order_relaxed);
+    return n;
+}
+
+size_t read(uint8_t* data, size_t capacity, int timeoutMs) {
+    if (!is_open) return 0;
+    const size_t n = active_backend->read(data, capacity, timeoutMs);
+    if (n == 0) {
+        read_timeouts.fetch_add(1, std::memory_order_relaxed);
+        return 0;
+    }
+    packets_in.fetch_add(1, std::memory_order_relaxed);
+    bytes_in.fetch_add(static_cast<uint32_t>(n), std::memory_order_relaxed);
+    return n;
+}
+
+Stats stats() {
+    return {opens.load(std::memory_order_relaxed), packets_out.load(std::memory_order_relaxed),
+            packets_in.load(std::memory_order_relaxed), bytes_out.load(std::memory_order_relaxed),
+            bytes_in.load(std::memory_order_relaxed), write_errors.load(std::memory_order_relaxed),
+            read_timeouts.load(std::memory_order_relaxed)};
+}
+
+} // namespace transport
@@ -0,0 +1,69 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// Transport of the XRCE-DDS session to the micro-ROS agent, registered as micro-ROS custom transport by
+// RosInterface. Backends are plain function tables like the HAL: UART (byte stream, XRCE adds its serial
+// framing) and UDP (datagrams, BSD sockets on lwIP and Linux). The backend is chosen at runtime before the
+// agent search starts, the default comes from LEG_MODULE_TRANSPORT.
+namespace transport {
+
+enum class Kind : uint8_t {
+    Uart = 0,
+    Udp = 1
+};
+
+struct Config {
+    Kind kind;
+    // UART
+    uint32_t uartPort;
+    uint32_t uartBaud;
+    int uartTx;         // GPIO, -1 = default pin of the port
+    int uartRx;
+    // UDP (network interface must already be up)
+    const char* agentIp;
+    uint16_t agentPort;
+};
+
+struct Backend {
+    const char* name;
+    bool framed;        // byte stream: XRCE serial framing on top
+    bool (*open)(const Config& config);
+    void (*close)();
+    // Bytes written, 0 = error
+    size_t (*write)(const uint8_t* data, size_t len);
+    // Waits at most timeoutMs, returns bytes read (0 = timeout / error)
+    size_t (*read)(uint8_t* data, size_t capacity, int timeoutMs);
+};
+
+struct Stats {
+    uint32_t opens;
+    uint32_t packetsOut;
+    uint32_t packetsIn;
+    uint32_t bytesOut;
+    uint32_t bytesIn;
+    uint32_t writeErrors;
+    uint32_t readTimeouts;
+};
+
+// Backend of this platform, nullptr if not built in (UART only on the ESP32)
+const Backend* backend(Kind kind);
+
+// Chooses the active backend (only while the session is closed); false if not available here
+bool select(const Config& config);
+const Config& config();
+const Backend* active();
+
+// Active backend with counters, called by the session (single task)
+bool open();
+void close();
+size_t write(const uint8_t* data, size_t len);
+size_t read(uint8_t* data, size_t capacity, int timeoutMs);
+
+// Readable from any task
+Stats stats();
+
+// Build default: LEG_MODULE_TRANSPORT 0 = UART (default), 1 = UDP
+Config defaultConfig();
+
+} // namespace transport
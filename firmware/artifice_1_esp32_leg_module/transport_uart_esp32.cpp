@@ -0,0 +1,59 @@
+#ifdef ESP_PLATFORM
+#include "transport.hpp"
+#include "driver/uart.h"
+#include "freertos/FreeRTOS.h"
+
+// UART-Backend: Byte-Strom, XRCE legt sein serielles Framing darüber (micro_ros_agent serial).
+// Der Treiber wird einmal installiert und bleibt über Reconnects bestehen (keine Heap-Allokation im Betrieb).
+
+namespace transport {
+
+namespace {
+
+const size_t UART_BUFFER_BYTES = 1024;
+uart_port_t uart_port = UART_NUM_0;
+
+bool uartOpen(const Config& config) {
+    uart_port = static_cast<uart_port_t>(config.uartPort);
+    if (uart_is_driver_installed(uart_port)) {
+        uart_flush_input(uart_port);
+        return true;
+    }
+    uart_config_t uart{};
+    uart.baud_rate = static_cast<int>(config.uartBaud);
+    uart.data_bits = UART_DATA_8_BITS;
+    uart.parity = UART_PARITY_DISABLE;
+    uart.stop_bits = UART_STOP_BITS_1;
+    uart.flow_ctrl = UART_HW_FLOWCTRL_DISABLE;
+    if (uart_param_config(uart_port, &uart) != ESP_OK) return false;
+    if (uart_set_pin(uart_port, config.uartTx < 0 ? UART_PIN_NO_CHANGE : config.uartTx,
+                     config.uartRx < 0 ? UART_PIN_NO_CHANGE : config.uartRx,
+                     UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE) != ESP_OK) {
+        return false;
+    }
+    return uart_driver_install(uart_port, UART_BUFFER_BYTES * 2, 0, 0, nullptr, 0) == ESP_OK;
+}
+
+void uartClose() {
+    // Treiber bleibt installiert, nur Reste der alten Session verwerfen
+    uart_flush_input(uart_port);
+}
+
+size_t uartWrite(const uint8_t* data, size_t len) {
+    const int n = uart_write_bytes(uart_port, reinterpret_cast<const char*>(data), len);
+    return n > 0 ? static_cast<size_t>(n) : 0;
+}
+
+size_t uartRead(uint8_t* data, size_t capacity, int timeoutMs) {
+    const int n = uart_read_bytes(uart_port, data, capacity, pdMS_TO_TICKS(timeoutMs));
+    return n > 0 ? static_cast<size_t>(n) : 0;
+}
+
+const Backend uart_backend = {"uart", true, uartOpen, uartClose, uartWrite, uartRead};
+
+} // namespace
+
+extern const Backend* const UART_BACKEND = &uart_backend;
+
+} // namespace transport
+#endif // ESP_PLATFORM
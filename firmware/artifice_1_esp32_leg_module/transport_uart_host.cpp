@@ -0,0 +1,10 @@
+#ifndef ESP_PLATFORM
+#include "transport.hpp"
+
+// Host-Build: kein UART-Backend, Transport-Benchmarks laufen über UDP-Loopback
+namespace transport {
+
+extern const Backend* const UART_BACKEND = nullptr;
+
+} // namespace transport
+#endif
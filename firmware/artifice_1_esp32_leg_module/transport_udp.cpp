@@ -0,0 +1,60 @@
+#include "transport.hpp"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <cstring>
+
+// UDP-Backend über BSD-Sockets: lwIP auf dem ESP32 (WLAN muss schon verbunden sein), Linux auf dem Host.
+// Ein verbundener Socket zum Agent, ein Datagramm = eine XRCE-Nachricht, kein Framing.
+
+namespace transport {
+
+namespace {
+
+int udp_socket = -1;
+
+bool udpOpen(const Config& config) {
+    udp_socket = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (udp_socket < 0) return false;
+    sockaddr_in agent{};
+    agent.sin_family = AF_INET;
+    agent.sin_port = htons(config.agentPort);
+    if (inet_pton(AF_INET, config.agentIp, &agent.sin_addr) != 1 ||
+        connect(udp_socket, reinterpret_cast<const sockaddr*>(&agent), sizeof(agent)) != 0) {
+        ::close(udp_socket);
+        udp_socket = -1;
+        return false;
+    }
+    return true;
+}
+
+void udpClose() {
+    if (udp_socket >= 0) ::close(udp_socket);
+    udp_socket = -1;
+}
+
+size_t udpWrite(const uint8_t* data, size_t len) {
+    const ssize_t n = send(udp_socket, data, len, 0);
+    return n > 0 ? static_cast<size_t>(n) : 0;
+}
+
+size_t udpRead(uint8_t* data, size_t capacity, int timeoutMs) {
+    // select statt poll: gibt es in jeder lwIP-Konfiguration
+    fd_set readable;
+    FD_ZERO(&readable);
+    FD_SET(udp_socket, &readable);
+    timeval timeout{timeoutMs / 1000, (timeoutMs % 1000) * 1000};
+    if (select(udp_socket + 1, &readable, nullptr, nullptr, &timeout) <= 0) return 0;
+    const ssize_t n = recv(udp_socket, data, capacity, 0);
+    return n > 0 ? static_cast<size_t>(n) : 0;
+}
+
+const Backend udp_backend = {"udp", false, udpOpen, udpClose, udpWrite, udpRead};
+
+} // namespace
+
+extern const Backend* const UDP_BACKEND = &udp_backend;
+
+} // namespace transport
@@ -0,0 +1,110 @@
+#include "waypoint_queue.hpp"
+
+namespace trajectory {
+
+void WaypointQueue::clear() {
+    first = 0;
+    count = 0;
+    have_previous = false;
+}
+
+void WaypointQueue::popFront() {
+    previous = at(0);
+    have_previous = true;
+    first = (first + 1) % CAPACITY;
+    --count;
+}
+
+void WaypointQueue::advance(int64_t nowUs) {
+    // Abgefahrene Abschnitte verwerfen, at(0) ist danach der Start des laufenden Abschnitts
+    while (count >= 2 && at(1).tUs <= nowUs) popFront();
+}
+
+void WaypointQueue::begin(int64_t nowUs, const int32_t* current) {
+    if (count != 0) return;
+    have_previous = false;
+    first = 0;
+    Waypoint& w = at(0);
+    w.tUs = nowUs;
+    for (size_t j = 0; j < num_joints; ++j) w.centiDeg[j] = current[j];
+    count = 1;
+}
+
+size_t WaypointQueue::append(const Waypoint* points, size_t n, bool replace, int64_t nowUs) {
+    if (n == 0) return 0;
+    if (replace && count > 0) {
+        advance(nowUs);
+        if (count >= 2 && at(1).tUs >= points[0].tUs && at(0).tUs < nowUs) {
+            // Laufender Abschnitt wird ersetzt: ab der aktuellen Stellung weiter, kein Sprung
+            Waypoint here;
+            here.tUs = nowUs;
+            interpolate(nowUs, here.centiDeg);
+            count = 1;
+            at(0) = here;
+        }
+        while (count > 1 && at(count - 1).tUs >= points[0].tUs) --count;
+    }
+    size_t queued = 0;
+    for (size_t i = 0; i < n; ++i) {
+        if (count > 0 && points[i].tUs <= at(count - 1).tUs) continue; // schon vorbei / nicht steigend
+        if (count == CAPACITY) {
+            overflow_points += static_cast<uint32_t>(n - i);
+            break;
+        }
+        at(count) = points[i];
+        ++count;
+        ++queued;
+    }
+    return queued;
+}
+
+WaypointQueue::Sample WaypointQueue::sample(int64_t nowUs, int32_t* out) {
+    if (count == 0) return Sample::Empty;
+    advance(nowUs);
+    if (count == 1 && at(0).tUs <= nowUs) {
+        for (size_t j = 0; j < num_joints; ++j) out[j] = at(0).centiDeg[j];
+        popFront();
+        return Sample::Finished;
+    }
+    interpolate(nowUs, out);
+    return Sample::Moving;
+}
+
+void WaypointQueue::interpolate(int64_t nowUs, int32_t* out) const {
+    const Waypoint& p0 = at(0);
+    if (count == 1 || nowUs <= p0.tUs) {
+        for (size_t j = 0; j < num_joints; ++j) out[j] = p0.centiDeg[j];
+        return;
+    }
+
+    // Hermite-Abschnitt p0 -> p1, Tangenten aus den Nachbarpunkten (Catmull-Rom bei ungleichen Abständen);
+    // am Anfang der Bewegung und am Ende der Queue Geschwindigkeit 0
+    const Waypoint& p1 = at(1);
+    const float h = static_cast<float>(p1.tUs - p0.tUs);
+    float s = static_cast<float>(nowUs - p0.tUs) / h;
+    if (s > 1.0f) s = 1.0f;
+    const float s2 = s * s;
+    const float s3 = s2 * s;
+    const float h00 = 2.0f * s3 - 3.0f * s2 + 1.0f;
+    const float h10 = s3 - 2.0f * s2 + s;
+    const float h01 = -2.0f * s3 + 3.0f * s2;
+    const float h11 = s3 - s2;
+    const bool haveNext = count >= 3;
+    for (size_t j = 0; j < num_joints; ++j) {
+        // Tangenten auf die Abschnittslänge skaliert (Steigung * h)
+        float m0 = 0.0f;
+        float m1 = 0.0f;
+        if (have_previous) {
+            m0 = static_cast<float>(p1.centiDeg[j] - previous.centiDeg[j]) * h /
+                 static_cast<float>(p1.tUs - previous.tUs);
+        }
+        if (haveNext) {
+            const Waypoint& p2 = at(2);
+            m1 = static_cast<float>(p2.centiDeg[j] - p0.centiDeg[j]) * h / static_cast<float>(p2.tUs - p0.tUs);
+        }
+        const float q = h00 * p0.centiDeg[j] + h10 * m0 + h01 * p1.centiDeg[j] + h11 * m1;
+        out[j] = static_cast<int32_t>(q >= 0.0f ? q + 0.5f : q - 0.5f);
+    }
+}
+
+} // namespace trajectory
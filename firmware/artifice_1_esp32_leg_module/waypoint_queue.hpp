@@ -0,0 +1,62 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// Look-ahead queue of timestamped joint waypoints for one leg, executed against the module clock with
+// cubic Hermite interpolation (non-uniform Catmull-Rom tangents, zero velocity at the end of the queue).
+// Fixed capacity, owned by the control task.
+namespace trajectory {
+
+struct Waypoint {
+    int64_t tUs;           // module clock
+    int32_t centiDeg[4];   // first numJoints used
+};
+
+class WaypointQueue {
+public:
+    static const size_t CAPACITY = 64;
+    static const size_t MAX_JOINTS = 4;
+
+    enum class Sample : uint8_t {
+        Empty,    // nothing queued, out untouched
+        Moving,
+        Finished  // past the last waypoint, out = last waypoint, queue is empty afterwards
+    };
+
+    explicit WaypointQueue(size_t joints = MAX_JOINTS) : num_joints(joints > MAX_JOINTS ? MAX_JOINTS : joints) {}
+
+    void clear();
+    bool empty() const { return count == 0; }
+    size_t size() const { return count; }
+
+    // Starts the motion at the current pose if the queue is empty (implicit first waypoint)
+    void begin(int64_t nowUs, const int32_t* current);
+    // Appends points (strictly increasing time, points at or before the end of the queue are skipped).
+    // replace: queued points at or after points[0].tUs are dropped first; if that cuts the segment in
+    // progress, the motion continues from the pose at nowUs, so a new chunk takes over without a jump.
+    // Points that do not fit are dropped and counted, returns the number of points queued.
+    size_t append(const Waypoint* points, size_t n, bool replace, int64_t nowUs);
+
+    Sample sample(int64_t nowUs, int32_t* out);
+    // Time of the last queued waypoint (valid if !empty())
+    int64_t endUs() const { return at(count - 1).tUs; }
+
+    uint32_t overflows() const { return overflow_points; }
+
+private:
+    Waypoint& at(size_t i) { return points_buf[(first + i) % CAPACITY]; }
+    const Waypoint& at(size_t i) const { return points_buf[(first + i) % CAPACITY]; }
+    void popFront();
+    void advance(int64_t nowUs);
+    void interpolate(int64_t nowUs, int32_t* out) const;
+
+    size_t num_joints;
+    Waypoint points_buf[CAPACITY];
+    size_t first = 0;
+    size_t count = 0;
+    Waypoint previous{};        // zuletzt verlassener Punkt, Tangente am ersten Punkt
+    bool have_previous = false;
+    uint32_t overflow_points = 0;
+};
+
+} // namespace trajectory